@@ -0,0 +1,470 @@
+/******************************************************************************
+ * bench_chipcore.c: Microbenchmarks of the CHIPCore primitives and resamplers
+ ******************************************************************************
+ * Usage: bench_chipcore [width height order_max min_ms json]
+ *
+ * For orders 1 to order_max (default 7):
+ *   Hexint_init, add, mul_int, getNearest, getReal, getSpatial
+ *     (ns/op over addresses / points of the order)
+ *   Hexsamp_sq2hex and Hexsamp_hex2sq (via NexysVideoHDMIHMod_sq2hex/_hex2sq,
+ *     width x height, default 1280x720) for all four techniques, each scale
+ *     and, for hex2sq, each radius below
+ *     (ns/frame, MPix/s of hex resp. output pixels, cycles/frame)
+ *   Hexsamp_sq2hex_roi (via NexysVideoHDMIHMod_sq2hex_roi) for centred
+ *     windows of 1, 1/4 and 1/16 of the hex image area, BL, each scale
+ *     (as above, MPix/s of hex pixels in the window); roi_init: Hexroi_init
+ *     alone (ns/op)
+ *   Hexpyramid_build and Hexpyramid_update of one level order - 2 aggregate
+ *     (1/49 of the addresses) (as sq2hex, MPix/s of hex pixels read)
+ *   Hexconv_apply with a 7 and a 49 tap Gaussian (conv7, conv49; as sq2hex,
+ *     MPix/s of hex pixels)
+ *   Hexfft_forward (fft) and, up to order 4, the direct Hexfft_dft (dft) of
+ *     one channel of that image (as sq2hex, MPix/s of hex pixels), with the
+ *     largest difference between both relative to the DC term
+ *
+ * Every case runs for at least min_ms (default 200) ms. Cycles are HModTimer
+ * ticks (hmod_timer.h: TSC on x86, elsewhere ns). With json, all results are also written to that file
+ * as an array of objects, one per case, for regression tracking.
+ ******************************************************************************/
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <math.h>
+
+#include "CHIPCore.h"
+#include "Nexys-Video-HDMIHMod.h"
+#include "hmod_timer.h"
+
+
+#define BENCH_OPS 4096
+
+
+typedef struct {
+	const char*  name;
+	unsigned int order;
+	float        scale;
+	float        radius;
+	int          technique; // -1: ohne
+	double       ns;        // je Operation bzw. Bild
+	double       mpix;      // MPix/s, 0: ohne
+	double       cycles;    // je Bild, 0: ohne
+	unsigned int iterations;
+} BenchResult;
+
+
+static const float scales[] = { 1.0f, 2.0f };
+static const float radii[]  = { 1.0f, 2.0f };
+
+static const char* const techniques[] = { "BL", "BC", "Lanczos", "B3" };
+
+static FILE*        json      = NULL;
+static unsigned int json_rows = 0;
+
+static volatile unsigned int sink_u;
+static volatile float        sink_f;
+
+
+static void report(const BenchResult* r) {
+	printf("%-12s order=%u", r->name, r->order);
+
+	if(r->technique >= 0)
+		printf(" scale=%.2f radius=%.2f %-7s", r->scale, r->radius, techniques[r->technique]);
+
+	if(r->mpix > 0)
+		printf(" %12.3f ms/frame %9.2f MPix/s %14.0f cycles/frame\n", r->ns / 1e6, r->mpix, r->cycles);
+	else
+		printf(" %10.2f ns/op\n", r->ns);
+
+	if(!json)
+		return;
+
+	fprintf(json, "%s\n  {\"bench\": \"%s\", \"order\": %u, \"scale\": %g, \"radius\": %g, "
+		"\"technique\": %d, \"iterations\": %u, \"%s\": %.3f, \"mpix_s\": %.3f, \"cycles_per_frame\": %.0f}",
+		json_rows++ ? "," : "", r->name, r->order, r->scale, r->radius, r->technique, r->iterations,
+		r->mpix > 0 ? "ns_per_frame" : "ns_per_op", r->ns, r->mpix, r->cycles);
+}
+
+
+// Primitive: BENCH_OPS Operationen je Durchlauf, bis min_ms erreicht
+
+typedef struct {
+	Hexint   a[BENCH_OPS];
+	Hexint   b[BENCH_OPS];
+	int      k[BENCH_OPS];
+	int      v[BENCH_OPS];
+	fPoint2d p[BENCH_OPS];
+} BenchInputs;
+
+static const char* const primitives[] = {
+	"Hexint_init", "add", "mul_int", "getNearest", "getReal", "getSpatial" };
+
+static void bench_primitive(unsigned int op, unsigned int order, const BenchInputs* in,
+ double min_ms) {
+	BenchResult  r = { .name = primitives[op], .order = order, .technique = -1 };
+	HModTimer    timer;
+	unsigned int n = 0;
+	double       t = 0;
+
+	while(t < min_ms * 1e6) {
+		HModTimer_start(&timer);
+
+		switch(op) {
+		case 0:
+			for(unsigned int j = 0; j < BENCH_OPS; j++) sink_u = Hexint_init(in->v[j], 0).value;
+			break;
+		case 1:
+			for(unsigned int j = 0; j < BENCH_OPS; j++) sink_u = add(in->a[j], in->b[j]).value;
+			break;
+		case 2:
+			for(unsigned int j = 0; j < BENCH_OPS; j++) sink_u = mul_int(in->a[j], in->k[j]).value;
+			break;
+		case 3:
+			for(unsigned int j = 0; j < BENCH_OPS; j++) sink_u = getNearest(in->p[j].x, in->p[j].y).value;
+			break;
+		case 4:
+			for(unsigned int j = 0; j < BENCH_OPS; j++) sink_f = getReal(in->a[j]).x;
+			break;
+		case 5:
+			for(unsigned int j = 0; j < BENCH_OPS; j++) sink_f = getSpatial(in->a[j]).x;
+			break;
+		}
+
+		HModTimer_stop(&timer);
+
+		t += HModTimer_ns(&timer);
+		n++;
+	}
+
+	r.iterations = n * BENCH_OPS;
+	r.ns         = t / r.iterations;
+
+	report(&r);
+}
+
+static void bench_primitives(unsigned int order, double min_ms) {
+	static BenchInputs in;
+
+	const unsigned int size = pow(7, order);
+
+	srand(order);
+
+	for(unsigned int j = 0; j < BENCH_OPS; j++) {
+		const fPoint2d pr = getReal(Hexint_init(rand() % size, 0));
+
+		in.v[j]   = rand() % size;
+		in.a[j]   = Hexint_init(rand() % size, 0);
+		in.b[j]   = Hexint_init(rand() % size, 0);
+		in.k[j]   = 1 + rand() % 7;
+		in.p[j].x = pr.x + (rand() % 1000) / 1000.0f - 0.5f;
+		in.p[j].y = pr.y + (rand() % 1000) / 1000.0f - 0.5f;
+	}
+
+	for(unsigned int op = 0; op < SIZEOF_ARRAY(primitives); op++)
+		bench_primitive(op, order, &in, min_ms);
+}
+
+
+// Durchlaeufe von fn(arg), bis min_ms erreicht; pixels: je Durchlauf, fuer
+// MPix/s und cycles/frame, 0: ns/op
+static void bench_run(BenchResult* r, void (*fn)(void*), void* arg, double pixels, double min_ms) {
+	HModTimer    timer;
+	unsigned int n;
+	double       t, c = 0;
+
+	for(n = 0, t = 0; t < min_ms * 1e6 || !n; n++) {
+		HModTimer_start(&timer);
+		fn(arg);
+		HModTimer_stop(&timer);
+
+		c += HModTimer_cycles(&timer);
+		t += HModTimer_ns(&timer);
+	}
+
+	r->iterations = n;
+	r->ns         = t / n;
+
+	if(pixels > 0) {
+		r->cycles = c / n;
+		r->mpix   = pixels / (r->ns / 1e9) / 1e6;
+	}
+
+	report(r);
+}
+
+
+// Resampler: ganze Bilder
+
+typedef struct {
+	u8*           src;
+	u8*           dest;
+	u32           width;
+	u32           height;
+	unsigned int  order;
+	float         scale;
+	float         radius;
+	unsigned int  technique;
+	iPoint2d      min;     // roi
+	iPoint2d      max;
+	Hexroi*       roi;     // roi_init
+	const Hexroi* cur;     // roi: letzte Zerlegung
+	HModRange     range;   // hex2sq: beschriebener Bereich
+} BenchFrame;
+
+static void bench_sq2hex_body(void* arg) {
+	BenchFrame* f = (BenchFrame*)arg;
+
+	NexysVideoHDMIHMod_sq2hex(f->src, &hexarray, 3 * f->width, f->width, f->height,
+		f->order, f->scale, f->technique);
+}
+
+static void bench_hex2sq_body(void* arg) {
+	BenchFrame* f = (BenchFrame*)arg;
+
+	f->range = NexysVideoHDMIHMod_hex2sq(hexarray, f->dest, 3 * f->width, f->width, f->height,
+		f->scale, f->radius, f->technique, 1);
+}
+
+static void bench_frame(const char* name, unsigned int order, float scale, float radius,
+ unsigned int technique, u8* src, u8* dest, u32 width, u32 height, double min_ms) {
+	const bool  sq2hex = name[0] == 's';
+	BenchResult r      = { .name = name, .order = order, .scale = scale, .radius = radius,
+	                       .technique = technique };
+	BenchFrame  f      = { .src = src, .dest = dest, .width = width, .height = height, .order = order,
+	                       .scale = scale, .radius = radius, .technique = technique };
+
+	// Warm-up, Hex-Bild und Ausgabebereich fuer hex2sq
+	bench_sq2hex_body(&f);
+
+	if(!sq2hex)
+		bench_hex2sq_body(&f);
+
+	bench_run(&r, sq2hex ? bench_sq2hex_body : bench_hex2sq_body, &f,
+		sq2hex ? hexarray.size : (double)f.range.rows * f.range.width / 3, min_ms);
+}
+
+
+static void bench_roi_body(void* arg) {
+	BenchFrame* f = (BenchFrame*)arg;
+
+	f->cur = NexysVideoHDMIHMod_sq2hex_roi(f->src, &hexarray, 3 * f->width, f->width, f->height,
+		f->order, f->scale, 0, f->min, f->max);
+}
+
+static void bench_roi_init_body(void* arg) {
+	BenchFrame*    f   = (BenchFrame*)arg;
+	const uPoint2d res = { .x = f->width, .y = f->height };
+
+	Hexroi_init(f->roi, f->order, res, 1 / f->scale, f->min, f->max);
+}
+
+// Ausschnitt: 1 / (div * div) der Flaeche des Hex-Bilds, zentriert
+static void bench_roi(unsigned int order, float scale, unsigned int div,
+ u8* src, u32 width, u32 height, double min_ms) {
+	const iPoint2d half = { .x = (int)((pc_reals_max.x - pc_reals_min.x) / scale / (2 * div)),
+	                        .y = (int)((pc_reals_max.y - pc_reals_min.y) / scale / (2 * div)) };
+	char           name[16];
+	BenchResult    r    = { .name = name, .order = order, .scale = scale, .technique = 0 };
+	Hexroi         roi  = { 0 };
+	BenchFrame     f    = { .src = src, .width = width, .height = height, .order = order, .scale = scale,
+	                        .min = { .x = (int)width / 2 - half.x, .y = (int)height / 2 - half.y },
+	                        .max = { .x = (int)width / 2 + half.x, .y = (int)height / 2 + half.y },
+	                        .roi = &roi };
+
+	snprintf(name, sizeof(name), "roi/%u", div * div);
+
+	// Warm-up, Zerlegung fuer die Pixelzahl
+	bench_roi_body(&f);
+	bench_run(&r, bench_roi_body, &f, f.cur->pixels, min_ms);
+
+	// Zerlegung allein
+	BenchResult ri = { .name = "roi_init", .order = order, .technique = -1 };
+
+	bench_run(&ri, bench_roi_init_body, &f, 0, min_ms);
+
+	printf("%12s %u of %u hex pixels in %u ranges, %u aggregates visited\n",
+		"", roi.pixels, hexarray.size, roi.n, roi.visited);
+
+	Hexroi_free(&roi);
+}
+
+
+// Pyramide ueber dem letzten Hex-Bild
+typedef struct {
+	Hexpyramid   pyramid;
+	unsigned int part;
+} BenchPyramid;
+
+static void bench_pyr_build_body(void* arg) {
+	Hexpyramid_build(&((BenchPyramid*)arg)->pyramid, hexarray);
+}
+
+static void bench_pyr_update_body(void* arg) {
+	BenchPyramid* p = (BenchPyramid*)arg;
+
+	Hexpyramid_update(&p->pyramid, hexarray, hexarray.size - p->part, hexarray.size);
+}
+
+static void bench_pyramid(unsigned int order, double min_ms) {
+	BenchPyramid p  = { .part = order >= 2 ? hexarray.size / 49 : hexarray.size };
+	BenchResult  rb = { .name = "pyr_build",  .order = order, .technique = -1 };
+	BenchResult  ru = { .name = "pyr_update", .order = order, .technique = -1 };
+
+	Hexpyramid_init(&p.pyramid, order);
+
+	bench_run(&rb, bench_pyr_build_body, &p, hexarray.size, min_ms);
+	bench_run(&ru, bench_pyr_update_body, &p, p.part, min_ms);
+
+	Hexpyramid_free(&p.pyramid);
+}
+
+
+// Faltung des letzten Hex-Bilds in place
+typedef struct {
+	Hexkernel kernel;
+	Hexconv   conv;
+} BenchConv;
+
+static void bench_conv_body(void* arg) {
+	BenchConv* b = (BenchConv*)arg;
+
+	Hexconv_apply(&b->conv, &b->kernel, hexarray, &hexarray);
+}
+
+static void bench_conv(unsigned int order, unsigned int taps, double min_ms) {
+	BenchResult r = { .name = taps > 7 ? "conv49" : "conv7", .order = order, .technique = -1 };
+	BenchConv   b;
+
+	Hexkernel_gauss(&b.kernel, taps, taps > 7 ? 1.5f : 1.0f);
+	Hexconv_init(&b.conv, hexarray.size, taps);
+
+	bench_run(&r, bench_conv_body, &b, hexarray.size, min_ms);
+
+	Hexconv_free(&b.conv);
+}
+
+
+// FFT gegen direkte DFT, Kanal 0 des letzten Hex-Bilds
+typedef struct {
+	unsigned int order;
+	Hexfft       fft;
+	fComplex*    in;
+	fComplex*    data;
+	fComplex*    ref;
+} BenchFft;
+
+// Kopie der Eingabe mitgemessen, data: Ergebnis der letzten FFT bleibt
+// fuer den Vergleich
+static void bench_fft_body(void* arg) {
+	BenchFft* b = (BenchFft*)arg;
+
+	memcpy(b->data, b->in, hexarray.size * sizeof(fComplex));
+	Hexfft_forward(&b->fft, b->data);
+}
+
+static void bench_dft_body(void* arg) {
+	BenchFft* b = (BenchFft*)arg;
+
+	Hexfft_dft(b->order, b->in, b->ref, false);
+}
+
+static void bench_fft(unsigned int order, double min_ms) {
+	const unsigned int size = hexarray.size;
+	BenchFft           b    = { .order = order,
+	                            .in    = (fComplex*)malloc(size * sizeof(fComplex)),
+	                            .data  = (fComplex*)malloc(size * sizeof(fComplex)),
+	                            .ref   = (fComplex*)malloc(size * sizeof(fComplex)) };
+	BenchResult        rf   = { .name = "fft", .order = order, .technique = -1 };
+	BenchResult        rd   = { .name = "dft", .order = order, .technique = -1 };
+
+	Hexfft_init(&b.fft, order);
+	Hexfft_load(hexarray, 0, b.in);
+
+	bench_run(&rf, bench_fft_body, &b, size, min_ms);
+
+	if(order <= 4) {
+		double err = 0;
+
+		bench_run(&rd, bench_dft_body, &b, size, min_ms);
+
+		for(unsigned int i = 0; i < size; i++) {
+			const double e = hypot(b.data[i].re - b.ref[i].re, b.data[i].im - b.ref[i].im);
+
+			if(e > err)
+				err = e;
+		}
+
+		printf("%12s fft - dft: %.2e of |DC|\n", "", err / hypot(b.ref[0].re, b.ref[0].im));
+	}
+
+	Hexfft_free(&b.fft);
+	free(b.in);
+	free(b.data);
+	free(b.ref);
+}
+
+
+int main(int argc, char** argv) {
+	const u32          width     = argc > 1 ? atoi(argv[1]) : 1280;
+	const u32          height    = argc > 2 ? atoi(argv[2]) : 720;
+	const unsigned int order_max = argc > 3 ? atoi(argv[3]) : 7;
+	const double       min_ms    = argc > 4 ? atof(argv[4]) : 200;
+	const char*        path      = argc > 5 ? argv[5] : NULL;
+
+	u8* src  = (u8*)malloc(3 * width * height);
+	u8* dest = (u8*)calloc(3 * width * height, 1);
+
+
+	for(unsigned int p = 0; p < 3 * width * height; p++)
+		src[p] = (u8)(p * 2654435761u >> 24);
+
+	HModTimer_init();
+
+	if(path && !(json = fopen(path, "w"))) {
+		perror(path);
+		return 1;
+	}
+
+	if(json)
+		fprintf(json, "[");
+
+	for(unsigned int order = 1; order <= order_max; order++) {
+		bench_primitives(order, min_ms);
+
+		// scale und radius ohne Neuberechnung
+		NexysVideoHDMIHMod_init(width, height, order, scales[0], radii[0]);
+		printf("\n");
+
+		for(unsigned int s = 0; s < SIZEOF_ARRAY(scales); s++) {
+			for(unsigned int technique = 0; technique < SIZEOF_ARRAY(techniques); technique++) {
+				bench_frame("sq2hex", order, scales[s], 0, technique, src, dest, width, height, min_ms);
+
+				for(unsigned int r = 0; r < SIZEOF_ARRAY(radii); r++)
+					bench_frame("hex2sq", order, scales[s], radii[r], technique, src, dest, width, height, min_ms);
+			}
+
+			for(unsigned int div = 1; div <= 4; div *= 2)
+				bench_roi(order, scales[s], div, src, width, height, min_ms);
+		}
+
+		bench_pyramid(order, min_ms);
+		bench_conv(order, 7, min_ms);
+		bench_conv(order, 49, min_ms);
+		bench_fft(order, min_ms);
+
+		NexysVideoHDMIHMod_free();
+	}
+
+	if(json) {
+		fprintf(json, "\n]\n");
+		fclose(json);
+	}
+
+
+	free(src);
+	free(dest);
+
+	return 0;
+}
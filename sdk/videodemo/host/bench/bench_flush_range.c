@@ -0,0 +1,96 @@
+/******************************************************************************
+ * bench_flush_range.c: D-cache lines flushed per frame, full vs. dirty range
+ ******************************************************************************
+ * Usage: bench_flush_range [order scale radius]
+ *
+ * Runs NexysVideoHDMIHMod for every display mode of the demo and mode_d, and
+ * counts (xil_cache stand-in) the lines flushed for the reported range
+ * against a DEMO_MAX_FRAME flush. Fails if a byte outside the reported range
+ * was written.
+ ******************************************************************************/
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "CHIPCore.h"
+#include "Nexys-Video-HDMIHMod.h"
+
+#include "xil_cache.h"
+
+
+// video_demo.h
+#define DEMO_MAX_FRAME (1920*1080*3)
+#define DEMO_STRIDE (1920 * 3)
+
+#define CANARY 0xA5
+
+
+int main(int argc, char** argv) {
+	const unsigned int order  = argc > 1 ? atoi(argv[1]) : 5;
+	const float        scale  = argc > 2 ? atof(argv[2]) : 1.0f;
+	const float        radius = argc > 3 ? atof(argv[3]) : 1.0f;
+
+	const uPoint2d modes[] = {
+		{ 640, 480 }, { 800, 600 }, { 1280, 720 }, { 1280, 1024 }, { 1920, 1080 } };
+
+	u8* srcFrame  = (u8*)malloc(DEMO_MAX_FRAME);
+	u8* destFrame = (u8*)malloc(DEMO_MAX_FRAME);
+	int failed    = 0;
+
+
+	for(unsigned int p = 0; p < DEMO_MAX_FRAME; p++)
+		srcFrame[p] = (u8)(p * 2654435761u >> 24);
+
+	NexysVideoHDMIHMod_init(1920, 1080, order, scale, radius);
+
+	Xil_CacheStats_reset();
+	Xil_DCacheFlushRange((UINTPTR)destFrame, DEMO_MAX_FRAME);
+
+	const u64 lines_full = Xil_CacheStats.flush_lines;
+
+	printf("\n\norder = %u, scale = %.2f, radius = %.2f, DEMO_MAX_FRAME: %llu lines\n\n",
+		order, scale, radius, (unsigned long long)lines_full);
+	printf("%-10s %6s %12s %10s %8s\n", "mode", "mode_d", "bytes", "lines", "ratio");
+
+	for(unsigned int m = 0; m < SIZEOF_ARRAY(modes); m++) {
+		for(u32 mode_d = 0; mode_d < 3; mode_d++) {
+			memset(destFrame, CANARY, DEMO_MAX_FRAME);
+
+			const HModRange dirty = NexysVideoHDMIHMod(srcFrame, destFrame,
+				DEMO_STRIDE, modes[m].x, modes[m].y,
+				order, scale, radius, 0, mode_d);
+
+			Xil_CacheStats_reset();
+			NexysVideoHDMIHMod_flush(destFrame, dirty);
+
+			for(u32 p = 0; p < DEMO_MAX_FRAME; p++) {
+				const u32 r = (p - dirty.begin) / DEMO_STRIDE;
+				const u32 c = (p - dirty.begin) % DEMO_STRIDE;
+
+				if(destFrame[p] != CANARY && (p < dirty.begin || r >= dirty.rows || c >= dirty.width)) {
+					printf("%ux%u mode_d = %u: byte %u written outside the reported range\n",
+						modes[m].x, modes[m].y, mode_d, p);
+					failed = 1;
+					break;
+				}
+			}
+
+			char label[16];
+
+			snprintf(label, sizeof(label), "%ux%u", modes[m].x, modes[m].y);
+			printf("%-10s %6u %12u %10llu %7.1f%%\n", label, mode_d, dirty.rows * dirty.width,
+				(unsigned long long)Xil_CacheStats.flush_lines,
+				100.0 * Xil_CacheStats.flush_lines / lines_full);
+		}
+	}
+
+
+	NexysVideoHDMIHMod_free();
+
+	free(destFrame);
+	free(srcFrame);
+
+	return failed;
+}
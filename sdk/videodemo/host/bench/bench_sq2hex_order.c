@@ -0,0 +1,117 @@
+/******************************************************************************
+ * bench_sq2hex_order.c: Hexsamp_sq2hex, spiral vs. raster-band processing
+ ******************************************************************************
+ * Usage: bench_sq2hex_order [width height order scale technique iterations]
+ *
+ * Reports time per frame and (where a PMU is available) cache misses for the
+ * spiral address order, the interior/border split and pc_order with several
+ * band heights.
+ ******************************************************************************/
+
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <math.h>
+
+#include "CHIPCore.h"
+#include "hmod_timer.h"
+
+#include "perf_counters.h"
+
+
+static void run(const char* label, pArray2d array, Hexarray* hexarray,
+ unsigned int order, float scale, unsigned int technique, unsigned int iterations,
+ PerfCounters* counters) {
+	long long values[PERF_COUNTERS_N];
+	HModTimer timer;
+
+	Hexsamp_sq2hex(array, hexarray, order, scale, technique); // Warm-up
+
+	PerfCounters_start(counters);
+	HModTimer_start(&timer);
+
+	for(unsigned int n = 0; n < iterations; n++)
+		Hexsamp_sq2hex(array, hexarray, order, scale, technique);
+
+	HModTimer_stop(&timer);
+	PerfCounters_stop(counters);
+	PerfCounters_read(counters, values);
+
+	printf("%-10s %10.3f ms/frame", label, (double)HModTimer_ns(&timer) / iterations / 1e6);
+
+	for(int k = 0; k < PERF_COUNTERS_N; k++) {
+		if(values[k] < 0) {
+			printf("  %s: n/a", PerfCounters_names[k]);
+		} else {
+			printf("  %s: %lld", PerfCounters_names[k], values[k] / iterations);
+		}
+	}
+
+	printf("\n");
+}
+
+int main(int argc, char** argv) {
+	const unsigned int width      = argc > 1 ? atoi(argv[1]) : 1920;
+	const unsigned int height     = argc > 2 ? atoi(argv[2]) : 1080;
+	const unsigned int order      = argc > 3 ? atoi(argv[3]) : 6;
+	const float        scale      = argc > 4 ? atof(argv[4]) : 1.0f;
+	const unsigned int technique  = argc > 5 ? atoi(argv[5]) : 0;
+	const unsigned int iterations = argc > 6 ? atoi(argv[6]) : 10;
+	const unsigned int bands[]    = { 1, 2, 4, 8, 16 };
+
+	pArray2d     array;
+	Hexarray     hexarray;
+	PerfCounters counters;
+
+
+	HModTimer_init();
+
+	pArray2d_init(&array, width, height);
+	Hexarray_init(&hexarray, order);
+
+	for(unsigned int p = 0; p < 3 * width * height; p++)
+		array.p[p] = (u8)(p * 2654435761u >> 24);
+
+	pc_reals_q = (int16_t*)malloc(2 * hexarray.size * sizeof(int16_t));
+
+	for(unsigned int i = 0; i < hexarray.size; i++) {
+		const fPoint2d pr = getReal(Hexint_init(i, 0));
+
+		pc_reals_q[2 * i]     = (int16_t)roundf(pr.x * (1 << PC_REALS_Q));
+		pc_reals_q[2 * i + 1] = (int16_t)roundf(pr.y * (1 << PC_REALS_Q));
+	}
+
+	if(!PerfCounters_open(&counters))
+		printf("perf_event: no hardware counters available, timing only\n");
+
+	printf("sq2hex %ux%u, order = %u (%u px), scale = %.2f, technique = %u, %u iterations\n",
+		width, height, order, hexarray.size, scale, technique, iterations);
+
+
+	pc_order = NULL;
+	run("spiral", array, &hexarray, order, 1 / scale, technique, iterations, &counters);
+
+	Hexsamp_sq2hex_split(hexarray.size, width, height, 1 / scale);
+	run("split", array, &hexarray, order, 1 / scale, technique, iterations, &counters);
+
+	for(unsigned int b = 0; b < SIZEOF_ARRAY(bands); b++) {
+		char label[16];
+
+		snprintf(label, sizeof(label), "band=%u", bands[b]);
+
+		Hexsamp_sq2hex_order(hexarray.size, 1 / scale, bands[b]);
+		Hexsamp_sq2hex_split(hexarray.size, width, height, 1 / scale);
+		run(label, array, &hexarray, order, 1 / scale, technique, iterations, &counters);
+	}
+
+
+	PerfCounters_close(&counters);
+
+	free(pc_order);
+	free(pc_reals_q);
+	Hexarray_free(&hexarray);
+	pArray2d_free(&array);
+
+	return 0;
+}
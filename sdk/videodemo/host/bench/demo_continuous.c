@@ -0,0 +1,151 @@
+/******************************************************************************
+ * demo_continuous.c: Continuous HMod processing against a simulated capture
+ ******************************************************************************
+ * Usage: demo_continuous [width height order mode_d rate seconds frames]
+ *
+ * Host counterpart of DemoRun with continuous processing enabled: capture
+ * keeps running into the framebuffer ring (HModRing) while the latest ready
+ * frame is processed into a free buffer (in place if there is none) and
+ * then displayed, stdin is polled without
+ * blocking ('q' quits, seconds = 0 runs until then), and sustained frames
+ * per second are reported once a second via NexysVideoHDMIHMod_fps_frame.
+ ******************************************************************************/
+
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <sys/select.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include "CHIPCore.h"
+#include "Nexys-Video-HDMIHMod.h"
+
+#include "video_sim.h"
+
+
+// video_demo.h
+#define DEMO_STRIDE (1920 * 3)
+
+
+static struct termios term_saved;
+static int            term_raw = 0;
+static int            term_eof = 0;
+
+static void term_restore() {
+	if(term_raw)
+		tcsetattr(STDIN_FILENO, TCSANOW, &term_saved);
+}
+
+// wie XUartLite_IsReceiveEmpty/XUartLite_ReadReg: -1, falls kein Zeichen
+static int poll_key() {
+	fd_set         fds;
+	struct timeval tv = { 0, 0 };
+	char           c;
+
+	if(term_eof)
+		return -1;
+
+	FD_ZERO(&fds);
+	FD_SET(STDIN_FILENO, &fds);
+
+	if(select(STDIN_FILENO + 1, &fds, NULL, NULL, &tv) <= 0)
+		return -1;
+
+	if(read(STDIN_FILENO, &c, 1) == 1)
+		return c;
+
+	term_eof = 1; // z. B. </dev/null: nur noch seconds begrenzt
+
+	return -1;
+}
+
+
+int main(int argc, char** argv) {
+	const u32   width   = argc > 1 ? atoi(argv[1]) : 640;
+	const u32   height  = argc > 2 ? atoi(argv[2]) : 480;
+	const u32   order   = argc > 3 ? atoi(argv[3]) : 5;
+	const u32   mode_d  = argc > 4 ? atoi(argv[4]) : 2;
+	const u32   rate    = argc > 5 ? atoi(argv[5]) : 60;
+	const u32   seconds = argc > 6 ? atoi(argv[6]) : 5;
+	const u32   frames  = argc > 7 ? atoi(argv[7]) : 5; // DEMO_NUM_FRAMES
+	const float scale   = 1.0f;
+	const float radius  = 1.0f;
+
+	VideoSim sim;
+	HModRing ring;
+	HModFps  fps;
+	int      key = -1;
+
+
+	if(isatty(STDIN_FILENO) && !tcgetattr(STDIN_FILENO, &term_saved)) {
+		struct termios raw = term_saved;
+
+		raw.c_lflag &= ~(ICANON | ECHO);
+		tcsetattr(STDIN_FILENO, TCSANOW, &raw);
+		term_raw = 1;
+	}
+
+	NexysVideoHDMIHMod_init(width, height, order, scale, radius);
+
+	VideoSim_init(&sim, frames < 3 ? 3 : frames, width, height, DEMO_STRIDE, rate);
+
+	// wie DemoRun, 'h': Aufnahme in Puffer 0, Anzeige auf dem letzten Puffer
+	NexysVideoHDMIHMod_ring_init(&ring, sim.numFrames, 0, sim.numFrames - 1,
+		VideoSim_now_ns(), sim.period_ns);
+	NexysVideoHDMIHMod_fps_init(&fps, VideoSim_now_ns(), 1000000000u);
+
+	printf("\n\n%ux%u, order = %u, mode_d = %u, capture %u Hz, %u framebuffers\n", width, height, order, mode_d, rate, sim.numFrames);
+
+	const u64 t_end = VideoSim_now_ns() + (u64)seconds * 1000000000u;
+
+	while(key != 'q' && (!seconds || VideoSim_now_ns() < t_end)) {
+		key = poll_key();
+
+		VideoSim_poll(&sim);
+
+		const int capture = NexysVideoHDMIHMod_ring_capture(&ring, VideoSim_now_ns());
+
+		if(capture >= 0)
+			VideoSim_change_frame(&sim, capture);
+
+		const int frame = NexysVideoHDMIHMod_ring_process(&ring, VideoSim_now_ns());
+
+		if(frame < 0)
+			continue;
+
+		const int dest = NexysVideoHDMIHMod_ring_dest(&ring, VideoSim_now_ns());
+		const u32 out  = dest >= 0 ? (u32)dest : (u32)frame;
+
+		// wie HMod_step: Rand bzw. Luecken einmal je Puffer
+		if(out != (u32)frame && !(ring.blank & 1u << out))
+			NexysVideoHDMIHMod_blank(sim.framePtr[out], DEMO_STRIDE, width, height, scale, mode_d);
+
+		ring.blank |= 1u << out;
+
+		const HModRange dirty = NexysVideoHDMIHMod(sim.framePtr[frame], sim.framePtr[out],
+			DEMO_STRIDE, width, height,
+			order, scale, radius, 0, mode_d);
+
+		NexysVideoHDMIHMod_flush(sim.framePtr[out], dirty);
+
+		NexysVideoHDMIHMod_ring_display(&ring, out, VideoSim_now_ns());
+
+		if(NexysVideoHDMIHMod_fps_frame(&fps, VideoSim_now_ns())) {
+			printf("FPS: %3u.%02u  processed: %6u  captured: %6u  display: %u\n",
+				fps.fps_x100 / 100, fps.fps_x100 % 100, fps.frames, sim.captured, out);
+			fflush(stdout);
+		}
+	}
+
+	term_restore();
+
+	printf("processed %u of %u captured frames\n", fps.frames, sim.captured);
+
+
+	VideoSim_free(&sim);
+	NexysVideoHDMIHMod_free();
+
+	return 0;
+}
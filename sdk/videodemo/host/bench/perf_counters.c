@@ -0,0 +1,88 @@
+/******************************************************************************
+ * perf_counters.c: Linux perf_event cache counters for host benchmarks
+ ******************************************************************************/
+
+
+#include <string.h>
+#include <unistd.h>
+
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+
+#include "perf_counters.h"
+
+
+const char* const PerfCounters_names[PERF_COUNTERS_N] = {
+	"cache-misses", "cache-references", "L1-dcache-load-misses" };
+
+
+static int perf_event_open(unsigned int type, unsigned long long config) {
+	struct perf_event_attr attr;
+
+	memset(&attr, 0, sizeof(attr));
+
+	attr.type           = type;
+	attr.size           = sizeof(attr);
+	attr.config         = config;
+	attr.disabled       = 1;
+	attr.exclude_kernel = 1;
+	attr.exclude_hv     = 1;
+
+	return (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+}
+
+int PerfCounters_open(PerfCounters* counters) {
+	counters->fd[0] = perf_event_open(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES);
+	counters->fd[1] = perf_event_open(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_REFERENCES);
+	counters->fd[2] = perf_event_open(PERF_TYPE_HW_CACHE,
+		 PERF_COUNT_HW_CACHE_L1D                  |
+		(PERF_COUNT_HW_CACHE_OP_READ        <<  8) |
+		(PERF_COUNT_HW_CACHE_RESULT_MISS    << 16));
+
+	counters->n = 0;
+
+	for(int k = 0; k < PERF_COUNTERS_N; k++) {
+		if(counters->fd[k] >= 0)
+			counters->n++;
+	}
+
+	return counters->n;
+}
+
+void PerfCounters_close(PerfCounters* counters) {
+	for(int k = 0; k < PERF_COUNTERS_N; k++) {
+		if(counters->fd[k] >= 0)
+			close(counters->fd[k]);
+
+		counters->fd[k] = -1;
+	}
+
+	counters->n = 0;
+}
+
+void PerfCounters_start(PerfCounters* counters) {
+	for(int k = 0; k < PERF_COUNTERS_N; k++) {
+		if(counters->fd[k] >= 0) {
+			ioctl(counters->fd[k], PERF_EVENT_IOC_RESET,  0);
+			ioctl(counters->fd[k], PERF_EVENT_IOC_ENABLE, 0);
+		}
+	}
+}
+
+void PerfCounters_stop(PerfCounters* counters) {
+	for(int k = 0; k < PERF_COUNTERS_N; k++) {
+		if(counters->fd[k] >= 0)
+			ioctl(counters->fd[k], PERF_EVENT_IOC_DISABLE, 0);
+	}
+}
+
+void PerfCounters_read(PerfCounters* counters, long long values[PERF_COUNTERS_N]) {
+	for(int k = 0; k < PERF_COUNTERS_N; k++) {
+		values[k] = -1;
+
+		if(counters->fd[k] >= 0 &&
+		   read(counters->fd[k], &values[k], sizeof(values[k])) != sizeof(values[k]))
+			values[k] = -1;
+	}
+}
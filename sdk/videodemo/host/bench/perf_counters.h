@@ -0,0 +1,30 @@
+/******************************************************************************
+ * perf_counters.h: Linux perf_event cache counters for host benchmarks
+ ******************************************************************************/
+
+
+#ifndef PERF_COUNTERS_H
+#define PERF_COUNTERS_H
+
+
+// Cache-Misses (LLC), Cache-Referenzen, L1D-Lesefehlzugriffe
+#define PERF_COUNTERS_N 3
+
+
+typedef struct { int fd[PERF_COUNTERS_N]; int n; } PerfCounters;
+
+extern const char* const PerfCounters_names[PERF_COUNTERS_N];
+
+
+// Rueckgabe: Anzahl verfuegbarer Zaehler (0 z. B. in VMs ohne PMU)
+int  PerfCounters_open(PerfCounters* counters);
+void PerfCounters_close(PerfCounters* counters);
+
+void PerfCounters_start(PerfCounters* counters);
+void PerfCounters_stop(PerfCounters* counters);
+
+// values[k] = -1, falls Zaehler k nicht verfuegbar
+void PerfCounters_read(PerfCounters* counters, long long values[PERF_COUNTERS_N]);
+
+
+#endif
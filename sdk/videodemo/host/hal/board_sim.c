@@ -0,0 +1,311 @@
+/******************************************************************************
+ * board_sim.c: Simulated Nexys Video HDMI design for host runs of video_demo
+ ******************************************************************************/
+
+
+#define _GNU_SOURCE
+
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "board_sim.h"
+#include "prof_export.h"
+#include "video_sim.h"
+
+#include "xparameters.h"
+
+
+// video_demo.h: DEMO_MAX_FRAME
+#define BOARD_SIM_MAX_WIDTH  1920
+#define BOARD_SIM_MAX_HEIGHT 1080
+
+
+BoardSim board;
+
+static struct termios term_saved;
+static int            term_raw = 0;
+
+static const u32 vtc_vec[BOARD_SIM_NUM_VTC] = {
+	XPAR_INTC_0_VTC_0_VEC_ID, XPAR_INTC_0_VTC_1_VEC_ID };
+
+
+u64 BoardSim_now_ns() {
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return (u64)ts.tv_sec * 1000000000u + ts.tv_nsec;
+}
+
+void BoardSim_lock() {
+	pthread_mutex_lock(&board.lock);
+}
+
+void BoardSim_unlock() {
+	pthread_mutex_unlock(&board.lock);
+}
+
+void BoardSim_raise(u32 id) {
+	if(board.intc)
+		board.intc->Pending |= 1u << id;
+}
+
+
+// S2MM: Bild index der Quelle in den geparkten Framebuffer
+static void BoardSim_capture(const XAxiVdma_Channel* wr, u32 index) {
+	u8*       dst   = (u8*)wr->Addr[wr->Park];
+	const u32 bytes = wr->HSize < 3 * board.width ? wr->HSize : 3 * board.width;
+	const u32 rows  = wr->VSize < board.height    ? wr->VSize : board.height;
+
+	if(!dst)
+		return;
+
+	if(!board.in) {
+		VideoSim_bars(dst, bytes / 3, rows, wr->Stride, index);
+
+		return;
+	}
+
+	const u8* src = board.in + (size_t)(index % board.in_frames) * 3 * board.width * board.height;
+
+	for(u32 y = 0; y < rows; y++)
+		memcpy(dst + y * wr->Stride, src + y * 3 * board.width, bytes);
+}
+
+// MM2S: geparkten Framebuffer an die Anzeige (Datei)
+static void BoardSim_display(const XAxiVdma_Channel* rd) {
+	const u8* src = (const u8*)rd->Addr[rd->Park];
+
+	if(!src)
+		return;
+
+	for(u32 y = 0; y < rd->VSize; y++)
+		fwrite(src + y * rd->Stride, 1, rd->HSize, board.out);
+}
+
+static void* BoardSim_thread(void* arg) {
+	u64 next = BoardSim_now_ns() + board.period_ns;
+
+	(void)arg;
+
+	while(!board.stop) {
+		const struct timespec ts = { next / 1000000000u, next % 1000000000u };
+
+		clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL);
+
+		// die Quelle wartet nicht: verpasste Bilder entfallen
+		const u64 now = BoardSim_now_ns();
+		u32       n   = 0;
+
+		for(; next <= now; next += board.period_ns)
+			n++;
+
+		XAxiVdma_Channel wr = { .Running = 0 };
+		XAxiVdma_Channel rd = { .Running = 0 };
+
+		BoardSim_lock();
+
+		board.captured += n;
+
+		// HPD -> Quelle sendet, Pixeltakt rastet ein
+		const u32 locked = board.connected && board.gpio && (board.gpio->Data[0] & 1);
+
+		if(locked != board.locked) {
+			board.locked = locked;
+			board.gpio->InterruptStatus |= XGPIO_IR_CH2_MASK;
+
+			if((board.gpio->InterruptEnabled & XGPIO_IR_CH2_MASK) && board.gpio->InterruptGlobalEnabled)
+				BoardSim_raise(XPAR_INTC_0_GPIO_0_VEC_ID);
+		}
+
+		if(board.vdma && locked)
+			wr = board.vdma->WriteChannel;
+
+		if(board.vdma && board.out && board.vtc[XPAR_VTC_0_DEVICE_ID] &&
+		 board.vtc[XPAR_VTC_0_DEVICE_ID]->GeneratorEnabled)
+			rd = board.vdma->ReadChannel;
+
+		const u32 index = board.captured - 1;
+
+		BoardSim_unlock();
+
+		if(wr.Running) {
+			BoardSim_capture(&wr, index);
+			board.written++;
+		}
+
+		if(rd.Running) {
+			BoardSim_display(&rd);
+			board.displayed++;
+		}
+	}
+
+	return NULL;
+}
+
+
+static void BoardSim_exit() {
+	const char* prof = getenv("HMOD_HOST_PROF_OUT");
+
+	board.stop = 1;
+	pthread_join(board.thread, NULL);
+
+	// Stufenzeiten von HMod_step (HMOD_PROF)
+	if(prof)
+		ProfExport_write(prof);
+
+	if(board.out)
+		fclose(board.out);
+
+	if(term_raw)
+		tcsetattr(STDIN_FILENO, TCSANOW, &term_saved);
+
+	fprintf(stderr, "\nboard: %u frames sent by the source, %u captured, %u displayed\n",
+		board.captured, board.written, board.displayed);
+}
+
+static void BoardSim_uart_init() {
+	const char* uart   = getenv("HMOD_HOST_UART");
+	const char* key_ms = getenv("HMOD_HOST_UART_KEY_MS");
+
+	board.uart_char  = -1;
+	board.uart_slave = -1;
+
+	// xil_printf (printf): UART ungepuffert
+	setvbuf(stdout, NULL, _IONBF, 0);
+
+	if(uart && !strcmp(uart, "pty")) {
+		const int master = posix_openpt(O_RDWR | O_NOCTTY);
+
+		if(master < 0 || grantpt(master) || unlockpt(master)) {
+			perror("board: pty");
+			exit(EXIT_FAILURE);
+		}
+
+		struct termios raw;
+
+		board.uart_slave = open(ptsname(master), O_RDWR | O_NOCTTY);
+		tcgetattr(board.uart_slave, &raw);
+		cfmakeraw(&raw);
+		tcsetattr(board.uart_slave, TCSANOW, &raw);
+
+		fprintf(stderr, "board: UART on %s\n", ptsname(master));
+
+		dup2(master, STDOUT_FILENO);
+
+		board.uart_fd  = master;
+		board.uart_tty = 1;
+	} else {
+		board.uart_fd  = STDIN_FILENO;
+		board.uart_tty = isatty(STDIN_FILENO);
+
+		if(board.uart_tty && !tcgetattr(STDIN_FILENO, &term_saved)) {
+			struct termios raw = term_saved;
+
+			raw.c_lflag &= ~(ICANON | ECHO);
+			tcsetattr(STDIN_FILENO, TCSANOW, &raw);
+			term_raw = 1;
+		}
+	}
+
+	// Eingabe aus Datei/Pipe: Tastenanschlaege im Abstand key_ms
+	board.uart_key_ns  = board.uart_tty ? 0 : (u64)(key_ms ? atoi(key_ms) : 100) * 1000000u;
+	board.uart_next_ns = BoardSim_now_ns() + board.uart_key_ns;
+}
+
+static void BoardSim_video_init() {
+	const char* mode = getenv("HMOD_HOST_VIDEO_MODE");
+	const char* in   = getenv("HMOD_HOST_VIDEO_IN");
+	const char* out  = getenv("HMOD_HOST_DISPLAY_OUT");
+
+	board.connected = 1;
+	board.width     = 1280;
+	board.height    = 720;
+	board.rate      = 60;
+
+	if(mode && !strcmp(mode, "none")) {
+		board.connected = 0;
+	} else if(mode && (sscanf(mode, "%ux%u@%u", &board.width, &board.height, &board.rate) < 2 ||
+	 !board.width || board.width > BOARD_SIM_MAX_WIDTH ||
+	 !board.height || board.height > BOARD_SIM_MAX_HEIGHT || !board.rate)) {
+		fprintf(stderr, "board: HMOD_HOST_VIDEO_MODE=%s, expected WxH@Hz up to %ux%u\n",
+			mode, BOARD_SIM_MAX_WIDTH, BOARD_SIM_MAX_HEIGHT);
+		exit(EXIT_FAILURE);
+	}
+
+	board.period_ns = 1000000000u / board.rate;
+
+	if(in) {
+		const size_t frame = (size_t)3 * board.width * board.height;
+		const int    fd    = open(in, O_RDONLY);
+		struct stat  st;
+
+		if(fd < 0 || fstat(fd, &st) || (size_t)st.st_size < frame) {
+			fprintf(stderr, "board: HMOD_HOST_VIDEO_IN=%s: no %ux%u RGB24 frame\n", in, board.width, board.height);
+			exit(EXIT_FAILURE);
+		}
+
+		board.in_frames = st.st_size / frame;
+		board.in        = mmap(NULL, board.in_frames * frame, PROT_READ, MAP_PRIVATE, fd, 0);
+		close(fd);
+
+		if(board.in == MAP_FAILED) {
+			perror("board: mmap");
+			exit(EXIT_FAILURE);
+		}
+	}
+
+	if(out && !(board.out = fopen(out, "wb"))) {
+		perror("board: HMOD_HOST_DISPLAY_OUT");
+		exit(EXIT_FAILURE);
+	}
+}
+
+void BoardSim_init() {
+	if(board.inited)
+		return;
+
+	board.inited = 1;
+
+	pthread_mutex_init(&board.lock, NULL);
+
+	BoardSim_uart_init();
+	BoardSim_video_init();
+
+	pthread_create(&board.thread, NULL, BoardSim_thread, NULL);
+	atexit(BoardSim_exit);
+}
+
+
+void BoardSim_poll() {
+	BoardSim_init();
+
+	if(!board.exceptions || board.in_irq || !board.handler || !board.intc)
+		return;
+
+	BoardSim_lock();
+
+	// VTC-Detektor: Lock-Interrupt als Pegel, solange freigegeben
+	for(u32 i = 0; i < BOARD_SIM_NUM_VTC; i++) {
+		const XVtc* vtc = board.vtc[i];
+
+		if(vtc && vtc->DetectorEnabled && (vtc->IntrEnabled & XVTC_IXR_LOCK_MASK) && board.locked)
+			BoardSim_raise(vtc_vec[i]);
+	}
+
+	const u32 pending = board.intc->Pending & board.intc->Enabled;
+
+	BoardSim_unlock();
+
+	if(pending) {
+		board.in_irq = 1;
+		board.handler(board.handler_data);
+		board.in_irq = 0;
+	}
+}
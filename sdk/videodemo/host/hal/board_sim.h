@@ -0,0 +1,115 @@
+/******************************************************************************
+ * board_sim.h: Simulated Nexys Video HDMI design for host runs of video_demo
+ ******************************************************************************
+ * Backs the BSP stand-ins in include/ (xaxivdma, xvtc, xgpio, xintc,
+ * xtmrctr_l, xuartlite_l, xil_io) so that video_demo.c, display_ctrl.c,
+ * video_capture.c, dynclk.c and intc.c run unchanged under Linux.
+ *
+ * A hardware thread plays HDMI source, VDMA and display at the frame rate of
+ * the source: once HPD is high the source locks (GPIO interrupt), the write
+ * channel stores each frame into its parked frame store and the read channel
+ * appends its parked frame store to the display output file. Interrupts are
+ * latched in the XIntc instance and taken in the main thread whenever the
+ * UART is polled (BoardSim_poll), like the UART loop of DemoRun on the board.
+ *
+ * Configuration (environment, read on first use):
+ *   HMOD_HOST_VIDEO_MODE  = WxH@Hz  HDMI source (default 1280x720@60),
+ *                           "none": nothing connected
+ *   HMOD_HOST_VIDEO_IN    = file    raw RGB24 frames (W * 3 bytes per row),
+ *                           played in a loop; default: colour bars
+ *   HMOD_HOST_DISPLAY_OUT = file    raw RGB24 frames as displayed
+ *                           (display mode width * 3 bytes per row)
+ *   HMOD_HOST_UART        = pty     pseudo terminal instead of stdin/stdout
+ *   HMOD_HOST_UART_KEY_MS = ms      key interval for non-terminal stdin
+ *                           (default 100); EOF sends a final 'q'
+ *   HMOD_HOST_PROF_OUT    = file    HMod stage timings at exit (HMOD_PROF),
+ *                           .json: JSON, otherwise CSV
+ ******************************************************************************/
+
+
+#ifndef BOARD_SIM_H
+#define BOARD_SIM_H
+
+
+#include <pthread.h>
+#include <stdio.h>
+
+#include "xil_types.h"
+#include "xil_exception.h"
+
+#include "xaxivdma.h"
+#include "xgpio.h"
+#include "xintc.h"
+#include "xvtc.h"
+
+
+#define BOARD_SIM_NUM_VTC 2
+
+// axi_dynclk: Register (dynclk.h), Status RUNNING folgt CTRL START
+#define BOARD_SIM_DYNCLK_REGS 8
+
+
+typedef struct {
+	u32 inited;
+
+	// HDMI-Quelle
+	u32       connected;
+	u32       width;
+	u32       height;
+	u32       rate;
+	u64       period_ns;
+	const u8* in;        // HMOD_HOST_VIDEO_IN (mmap), sonst NULL
+	u32       in_frames;
+	FILE*     out;       // HMOD_HOST_DISPLAY_OUT, sonst NULL
+
+	// Hardware-Thread; lock schuetzt Geraetezustand und Interruptleitungen
+	pthread_t       thread;
+	pthread_mutex_t lock;
+	volatile u32    stop;
+	u32             locked;    // Pixeltakt der Quelle eingerastet
+	u32             captured;  // von der Quelle gesendete Bilder
+	u32             written;   // davon per VDMA abgelegt
+	u32             displayed; // in HMOD_HOST_DISPLAY_OUT geschrieben
+
+	// Geraete, von den Stand-ins bei der Initialisierung eingetragen
+	XAxiVdma* vdma;
+	XVtc*     vtc[BOARD_SIM_NUM_VTC];
+	XGpio*    gpio;
+	XIntc*    intc;
+	u32       dynclk[BOARD_SIM_DYNCLK_REGS];
+
+	// Interrupt-Exception (Xil_ExceptionRegisterHandler)
+	Xil_ExceptionHandler handler;
+	void*                handler_data;
+	u32                  exceptions;
+	u32                  in_irq;
+
+	// UART
+	int uart_fd;     // Empfang: stdin bzw. Master des Pseudo-Terminals
+	int uart_slave;  // offen halten, sonst EIO ohne angeschlossenes Terminal
+	int uart_tty;
+	int uart_eof;
+	int uart_char;   // empfangenes Zeichen im FIFO, sonst -1
+	u64 uart_key_ns;
+	u64 uart_next_ns;
+} BoardSim;
+
+extern BoardSim board;
+
+
+// einmalig beim ersten Zugriff eines Stand-ins
+void BoardSim_init();
+
+u64  BoardSim_now_ns();
+
+void BoardSim_lock();
+void BoardSim_unlock();
+
+// Interruptleitung id setzen (bei gesperrtem lock)
+void BoardSim_raise(u32 id);
+
+// anstehende Interrupts im Hauptthread annehmen (Polling-Punkte)
+void BoardSim_poll();
+
+
+#endif
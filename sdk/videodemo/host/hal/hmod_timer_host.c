@@ -0,0 +1,79 @@
+/******************************************************************************
+ * hmod_timer_host.c: HModTimer backend for host builds
+ ******************************************************************************
+ * x86: ticks are rdtsc (invariant TSC), the frequency is calibrated once
+ * against CLOCK_MONOTONIC, so cycles stay cheap to read and ns comparable to
+ * the board. Elsewhere, or with -DHMOD_TIMER_CLOCK, ticks are CLOCK_MONOTONIC
+ * ns. Thread-safe once HModTimer_init ran (call it before starting threads).
+ ******************************************************************************/
+
+
+#include <time.h>
+
+#include "hmod_timer.h"
+
+
+#if (defined(__x86_64__) || defined(__i386__)) && !defined(HMOD_TIMER_CLOCK)
+#define HMOD_TIMER_RDTSC 1
+#else
+#define HMOD_TIMER_RDTSC 0
+#endif
+
+// Kalibrierung von rdtsc
+#define HMOD_TIMER_CALIBRATE_NS 20000000
+
+
+static u64 HModTimer_clock_ns() {
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return (u64)ts.tv_sec * 1000000000u + ts.tv_nsec;
+}
+
+
+#if HMOD_TIMER_RDTSC
+
+static u64 HModTimer_tsc_freq = 0;
+
+void HModTimer_init() {
+	if(HModTimer_tsc_freq)
+		return;
+
+	const struct timespec wait = { 0, HMOD_TIMER_CALIBRATE_NS };
+
+	const u64 t0 = HModTimer_clock_ns();
+	const u64 c0 = __builtin_ia32_rdtsc();
+
+	nanosleep(&wait, NULL);
+
+	const u64 t1 = HModTimer_clock_ns();
+	const u64 c1 = __builtin_ia32_rdtsc();
+
+	HModTimer_tsc_freq = (c1 - c0) * 1000000000.0 / (t1 - t0);
+}
+
+u64 HModTimer_ticks() {
+	return __builtin_ia32_rdtsc();
+}
+
+u64 HModTimer_freq() {
+	HModTimer_init();
+
+	return HModTimer_tsc_freq;
+}
+
+#else
+
+void HModTimer_init() {
+}
+
+u64 HModTimer_ticks() {
+	return HModTimer_clock_ns();
+}
+
+u64 HModTimer_freq() {
+	return 1000000000u;
+}
+
+#endif
@@ -0,0 +1,68 @@
+/******************************************************************************
+ * prof_export.c: Export of the HMod stage timings (HMOD_PROF) on the host
+ ******************************************************************************/
+
+
+#include <stdio.h>
+#include <string.h>
+
+#include "Nexys-Video-HDMIHMod.h"
+
+#include "prof_export.h"
+
+
+static double ProfExport_ns(u32 ticks) {
+	return hmod_prof.freq ? ticks * 1e9 / hmod_prof.freq : 0.0;
+}
+
+int ProfExport_write(const char* path) {
+	const char* ext  = strrchr(path, '.');
+	const bool  json = ext && !strcmp(ext, ".json");
+	FILE*       f    = fopen(path, "w");
+
+	HModProfStats st;
+
+	if(!f) {
+		perror(path);
+		return -1;
+	}
+
+	if(json)
+		fprintf(f, "{\n  \"freq\": %llu,\n  \"frames\": %u,\n  \"window\": %u,\n  \"stages\": [",
+			(unsigned long long)hmod_prof.freq, hmod_prof.frames, HMOD_PROF_WINDOW);
+	else
+		fprintf(f, "stage,n,min_ns,mean_ns,max_ns,p50_ns,p90_ns,p99_ns,freq");
+
+	if(!json)
+		for(u32 b = 0; b < HMOD_PROF_BINS; b++)
+			fprintf(f, ",lt_2^%u", b);
+
+	for(u32 s = 0; s < HMOD_STAGES; s++) {
+		NexysVideoHDMIHMod_prof_stats(s, &st);
+
+		if(json) {
+			fprintf(f, "%s\n    {\"stage\": \"%s\", \"n\": %u, \"min_ns\": %.0f, \"mean_ns\": %.0f, "
+				"\"max_ns\": %.0f, \"p50_ns\": %.0f, \"p90_ns\": %.0f, \"p99_ns\": %.0f, \"hist\": [",
+				s ? "," : "", NexysVideoHDMIHMod_stages[s], st.n, ProfExport_ns(st.min), ProfExport_ns(st.mean),
+				ProfExport_ns(st.max), ProfExport_ns(st.p50), ProfExport_ns(st.p90), ProfExport_ns(st.p99));
+
+			for(u32 b = 0; b < HMOD_PROF_BINS; b++)
+				fprintf(f, "%s%u", b ? ", " : "", hmod_prof.hist[s][b]);
+
+			fprintf(f, "]}");
+		} else {
+			fprintf(f, "\n%s,%u,%.0f,%.0f,%.0f,%.0f,%.0f,%.0f,%llu", NexysVideoHDMIHMod_stages[s], st.n,
+				ProfExport_ns(st.min), ProfExport_ns(st.mean), ProfExport_ns(st.max),
+				ProfExport_ns(st.p50), ProfExport_ns(st.p90), ProfExport_ns(st.p99),
+				(unsigned long long)hmod_prof.freq);
+
+			for(u32 b = 0; b < HMOD_PROF_BINS; b++)
+				fprintf(f, ",%u", hmod_prof.hist[s][b]);
+		}
+	}
+
+	fprintf(f, json ? "\n  ]\n}\n" : "\n");
+	fclose(f);
+
+	return 0;
+}
@@ -0,0 +1,16 @@
+/******************************************************************************
+ * prof_export.h: Export of the HMod stage timings (HMOD_PROF) on the host
+ ******************************************************************************/
+
+
+#ifndef PROF_EXPORT_H
+#define PROF_EXPORT_H
+
+
+// hmod_prof nach path: JSON bei Endung .json, sonst CSV (eine Zeile je
+// Stufe: Statistik in ns ueber das Fenster, log2-Histogramm in Ticks);
+// Rueckgabe 0 oder -1
+int ProfExport_write(const char* path);
+
+
+#endif
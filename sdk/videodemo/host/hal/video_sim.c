@@ -0,0 +1,82 @@
+/******************************************************************************
+ * video_sim.c: Simulated video capture source for host runs
+ ******************************************************************************/
+
+
+#include <stdlib.h>
+#include <time.h>
+
+#include "video_sim.h"
+
+
+u64 VideoSim_now_ns() {
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return (u64)ts.tv_sec * 1000000000u + ts.tv_nsec;
+}
+
+void VideoSim_bars(u8* frame, u32 width, u32 height, u32 stride, u32 index) {
+	for(u32 y = 0; y < height; y++) {
+		u8* p = frame + y * stride;
+
+		for(u32 x = 0; x < width; x++, p += 3) {
+			const u32 bar = ((x + 4 * index) * 8 / width) % 8;
+
+			p[0] = bar & 1 ? 255 : 0;
+			p[1] = bar & 2 ? 255 : 0;
+			p[2] = bar & 4 ? (u8)(255 * y / height) : 0;
+		}
+	}
+}
+
+
+void VideoSim_init(VideoSim* sim, u32 numFrames, u32 width, u32 height, u32 stride, u32 rate) {
+	sim->numFrames = numFrames < VIDEO_SIM_MAX_FRAMES ? numFrames : VIDEO_SIM_MAX_FRAMES;
+
+	for(u32 i = 0; i < sim->numFrames; i++)
+		sim->framePtr[i] = (u8*)calloc(stride * height, 1);
+
+	sim->width     = width;
+	sim->height    = height;
+	sim->stride    = stride;
+	sim->curFrame  = 0;
+
+	sim->period_ns = 1000000000u / rate;
+	sim->next_ns   = VideoSim_now_ns();
+	sim->captured  = 0;
+	sim->filled    = 0;
+}
+
+void VideoSim_free(VideoSim* sim) {
+	for(u32 i = 0; i < sim->numFrames; i++) {
+		free(sim->framePtr[i]);
+		sim->framePtr[i] = NULL;
+	}
+}
+
+u32 VideoSim_poll(VideoSim* sim) {
+	const u64 now = VideoSim_now_ns();
+
+	u32 n = 0;
+
+	for(; sim->next_ns <= now; sim->next_ns += sim->period_ns)
+		n++;
+
+	sim->captured += n;
+	sim->filled   += n;
+
+	return n;
+}
+
+void VideoSim_change_frame(VideoSim* sim, u32 frameIndex) {
+	VideoSim_poll(sim);
+
+	// letztes Bild im bisherigen Puffer
+	if(sim->filled)
+		VideoSim_bars(sim->framePtr[sim->curFrame], sim->width, sim->height, sim->stride, sim->captured);
+
+	sim->curFrame = frameIndex;
+	sim->filled   = 0;
+}
@@ -0,0 +1,52 @@
+/******************************************************************************
+ * video_sim.h: Simulated video capture source for host runs
+ ******************************************************************************
+ * Stands in for the VDMA S2MM channel parked on framePtr[curFrame]: a new
+ * frame "arrives" every 1/rate s of wall-clock time. Only the latest one is
+ * visible in the frame store; it is rendered (moving colour bars, 24 bpp)
+ * when capture moves on to another frame store (VideoSim_change_frame), so
+ * frames nobody can read cost nothing.
+ ******************************************************************************/
+
+
+#ifndef VIDEO_SIM_H
+#define VIDEO_SIM_H
+
+
+#include "xil_types.h"
+
+
+#define VIDEO_SIM_MAX_FRAMES 8 // HMOD_RING_MAX
+
+
+typedef struct {
+	u8* framePtr[VIDEO_SIM_MAX_FRAMES];
+	u32 numFrames;
+	u32 width;
+	u32 height;
+	u32 stride;
+	u32 curFrame;
+
+	u64 period_ns;
+	u64 next_ns;
+	u32 captured; // seit VideoSim_init geschriebene Bilder
+	u32 filled;   // seit letztem Pufferwechsel nach curFrame geschriebene Bilder
+} VideoSim;
+
+
+u64  VideoSim_now_ns();
+
+// Farbbalken (Bild index), je Bild um 4 Pixel verschoben
+void VideoSim_bars(u8* frame, u32 width, u32 height, u32 stride, u32 index);
+
+void VideoSim_init(VideoSim* sim, u32 numFrames, u32 width, u32 height, u32 stride, u32 rate);
+void VideoSim_free(VideoSim* sim);
+
+// Aufnahme nachfuehren; Rueckgabe: Anzahl neu geschriebener Bilder
+u32  VideoSim_poll(VideoSim* sim);
+
+// wie VideoChangeFrame
+void VideoSim_change_frame(VideoSim* sim, u32 frameIndex);
+
+
+#endif
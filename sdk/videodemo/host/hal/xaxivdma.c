@@ -0,0 +1,157 @@
+/******************************************************************************
+ * xaxivdma.c: Host stand-in for the Xilinx axi_vdma driver (xaxivdma)
+ ******************************************************************************/
+
+
+#include <string.h>
+
+#include "xaxivdma.h"
+#include "xparameters.h"
+
+#include "board_sim.h"
+
+
+// hdmi.hwh: C_NUM_FSTORES = 3
+static XAxiVdma_Config XAxiVdma_ConfigTable[] = {
+	{ XPAR_AXIVDMA_0_DEVICE_ID, XPAR_AXI_VDMA_0_BASEADDR, 3 } };
+
+
+static XAxiVdma_Channel* XAxiVdma_GetChannel(XAxiVdma* InstancePtr, int Direction) {
+	return Direction == XAXIVDMA_READ ? &InstancePtr->ReadChannel : &InstancePtr->WriteChannel;
+}
+
+
+XAxiVdma_Config* XAxiVdma_LookupConfig(u16 DeviceId) {
+	for(u32 i = 0; i < sizeof(XAxiVdma_ConfigTable) / sizeof(XAxiVdma_ConfigTable[0]); i++) {
+		if(XAxiVdma_ConfigTable[i].DeviceId == DeviceId)
+			return &XAxiVdma_ConfigTable[i];
+	}
+
+	return NULL;
+}
+
+int XAxiVdma_CfgInitialize(XAxiVdma* InstancePtr, XAxiVdma_Config* CfgPtr, UINTPTR EffectiveAddr) {
+	BoardSim_init();
+	BoardSim_lock();
+
+	memset(InstancePtr, 0, sizeof(*InstancePtr));
+	InstancePtr->BaseAddress  = EffectiveAddr;
+	InstancePtr->MaxNumFrames = CfgPtr->MaxFrameStoreNum;
+	InstancePtr->ReadChannel.IsValid  = 1;
+	InstancePtr->WriteChannel.IsValid = 1;
+	InstancePtr->IsReady      = XIL_COMPONENT_IS_READY;
+
+	board.vdma = InstancePtr;
+
+	BoardSim_unlock();
+
+	return XST_SUCCESS;
+}
+
+
+int XAxiVdma_DmaConfig(XAxiVdma* InstancePtr, u16 Direction, XAxiVdma_DmaSetup* DmaConfigPtr) {
+	XAxiVdma_Channel* channel = XAxiVdma_GetChannel(InstancePtr, Direction);
+
+	if(DmaConfigPtr->HoriSizeInput <= 0 || DmaConfigPtr->VertSizeInput <= 0 ||
+	 DmaConfigPtr->Stride < DmaConfigPtr->HoriSizeInput)
+		return XST_FAILURE;
+
+	BoardSim_lock();
+
+	channel->HSize  = DmaConfigPtr->HoriSizeInput;
+	channel->VSize  = DmaConfigPtr->VertSizeInput;
+	channel->Stride = DmaConfigPtr->Stride;
+
+	BoardSim_unlock();
+
+	return XST_SUCCESS;
+}
+
+int XAxiVdma_DmaSetBufferAddr(XAxiVdma* InstancePtr, u16 Direction, UINTPTR* BufferAddrSet) {
+	XAxiVdma_Channel* channel = XAxiVdma_GetChannel(InstancePtr, Direction);
+
+	BoardSim_lock();
+
+	for(u32 i = 0; i < InstancePtr->MaxNumFrames; i++)
+		channel->Addr[i] = BufferAddrSet[i];
+
+	BoardSim_unlock();
+
+	return XST_SUCCESS;
+}
+
+int XAxiVdma_DmaStart(XAxiVdma* InstancePtr, u16 Direction) {
+	XAxiVdma_Channel* channel = XAxiVdma_GetChannel(InstancePtr, Direction);
+
+	if(!channel->HSize)
+		return XST_FAILURE;
+
+	BoardSim_lock();
+	channel->Running = 1;
+	BoardSim_unlock();
+
+	return XST_SUCCESS;
+}
+
+void XAxiVdma_DmaStop(XAxiVdma* InstancePtr, u16 Direction) {
+	XAxiVdma_Channel* channel = XAxiVdma_GetChannel(InstancePtr, Direction);
+
+	BoardSim_lock();
+	channel->Running = 0;
+	BoardSim_unlock();
+}
+
+int XAxiVdma_StartParking(XAxiVdma* InstancePtr, int FrameIndex, u16 Direction) {
+	XAxiVdma_Channel* channel = XAxiVdma_GetChannel(InstancePtr, Direction);
+
+	if(FrameIndex < 0 || FrameIndex >= InstancePtr->MaxNumFrames)
+		return XST_FAILURE;
+
+	BoardSim_lock();
+	channel->Park = FrameIndex;
+	BoardSim_unlock();
+
+	return XST_SUCCESS;
+}
+
+
+// Uebertragungen laufen im Hardware-Thread je ganzes Bild
+int XAxiVdma_IsBusy(XAxiVdma* InstancePtr, u16 Direction) {
+	(void)InstancePtr;
+	(void)Direction;
+
+	BoardSim_poll();
+
+	return 0;
+}
+
+u32 XAxiVdma_GetDmaChannelErrors(XAxiVdma* InstancePtr, u16 Direction) {
+	(void)InstancePtr;
+	(void)Direction;
+
+	return 0;
+}
+
+int XAxiVdma_ClearDmaChannelErrors(XAxiVdma* InstancePtr, u16 Direction, u32 ErrorMask) {
+	(void)InstancePtr;
+	(void)Direction;
+	(void)ErrorMask;
+
+	return XST_SUCCESS;
+}
+
+
+void XAxiVdma_Reset(XAxiVdma* InstancePtr, int Direction) {
+	XAxiVdma_Channel* channel = XAxiVdma_GetChannel(InstancePtr, Direction);
+
+	BoardSim_lock();
+	channel->Running = 0;
+	BoardSim_unlock();
+}
+
+int XAxiVdma_ResetNotDone(XAxiVdma* InstancePtr, int Direction) {
+	(void)InstancePtr;
+	(void)Direction;
+
+	return 0;
+}
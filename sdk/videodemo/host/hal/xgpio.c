@@ -0,0 +1,76 @@
+/******************************************************************************
+ * xgpio.c: Host stand-in for the Xilinx axi_gpio driver (xgpio)
+ ******************************************************************************/
+
+
+#include <string.h>
+
+#include "xgpio.h"
+#include "xparameters.h"
+
+#include "board_sim.h"
+
+
+int XGpio_Initialize(XGpio* InstancePtr, u16 DeviceId) {
+	if(DeviceId != XPAR_AXI_GPIO_VIDEO_DEVICE_ID)
+		return XST_DEVICE_NOT_FOUND;
+
+	BoardSim_init();
+	BoardSim_lock();
+
+	memset(InstancePtr, 0, sizeof(*InstancePtr));
+	InstancePtr->BaseAddress = XPAR_AXI_GPIO_VIDEO_BASEADDR;
+	InstancePtr->Tri[0]      = 0xFFFFFFFF;
+	InstancePtr->Tri[1]      = 0xFFFFFFFF;
+	InstancePtr->IsReady     = XIL_COMPONENT_IS_READY;
+
+	board.gpio = InstancePtr;
+
+	BoardSim_unlock();
+
+	return XST_SUCCESS;
+}
+
+int XGpio_SelfTest(XGpio* InstancePtr) {
+	return InstancePtr->IsReady == XIL_COMPONENT_IS_READY ? XST_SUCCESS : XST_FAILURE;
+}
+
+
+void XGpio_SetDataDirection(XGpio* InstancePtr, unsigned Channel, u32 DirectionMask) {
+	InstancePtr->Tri[Channel - 1] = DirectionMask;
+}
+
+// Kanal 2: Pixeltakt der Quelle eingerastet
+u32 XGpio_DiscreteRead(XGpio* InstancePtr, unsigned Channel) {
+	BoardSim_lock();
+	const u32 data = Channel == 2 ? board.locked : InstancePtr->Data[Channel - 1];
+	BoardSim_unlock();
+
+	return data;
+}
+
+// Kanal 1: HPD
+void XGpio_DiscreteWrite(XGpio* InstancePtr, unsigned Channel, u32 Data) {
+	BoardSim_lock();
+	InstancePtr->Data[Channel - 1] = Data;
+	BoardSim_unlock();
+}
+
+
+void XGpio_InterruptGlobalEnable(XGpio* InstancePtr) {
+	BoardSim_lock();
+	InstancePtr->InterruptGlobalEnabled = 1;
+	BoardSim_unlock();
+}
+
+void XGpio_InterruptEnable(XGpio* InstancePtr, u32 Mask) {
+	BoardSim_lock();
+	InstancePtr->InterruptEnabled |= Mask;
+	BoardSim_unlock();
+}
+
+void XGpio_InterruptClear(XGpio* InstancePtr, u32 Mask) {
+	BoardSim_lock();
+	InstancePtr->InterruptStatus &= ~Mask;
+	BoardSim_unlock();
+}
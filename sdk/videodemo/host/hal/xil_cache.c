@@ -0,0 +1,51 @@
+/******************************************************************************
+ * xil_cache.c: Host stand-in for the Xilinx BSP (standalone) xil_cache
+ ******************************************************************************/
+
+
+#include <string.h>
+
+#include "xil_cache.h"
+
+
+XilCacheStats Xil_CacheStats;
+
+
+// Anzahl der von [adr, adr + len) beruehrten Cache-Zeilen
+static u64 Xil_CacheLines(UINTPTR adr, u32 len) {
+	if(!len)
+		return 0;
+
+	return (adr + len - 1) / XIL_CACHE_LINE_LEN - adr / XIL_CACHE_LINE_LEN + 1;
+}
+
+
+void Xil_DCacheFlushRange(UINTPTR adr, u32 len) {
+	Xil_CacheStats.flush_calls++;
+	Xil_CacheStats.flush_lines += Xil_CacheLines(adr, len);
+}
+
+void Xil_DCacheInvalidateRange(UINTPTR adr, u32 len) {
+	Xil_CacheStats.invalidate_calls++;
+	Xil_CacheStats.invalidate_lines += Xil_CacheLines(adr, len);
+}
+
+void Xil_DCacheFlush() {
+	Xil_CacheStats.flush_calls++;
+	Xil_CacheStats.flush_lines += XIL_CACHE_SIZE / XIL_CACHE_LINE_LEN;
+}
+
+void Xil_DCacheInvalidate() {
+	Xil_CacheStats.invalidate_calls++;
+	Xil_CacheStats.invalidate_lines += XIL_CACHE_SIZE / XIL_CACHE_LINE_LEN;
+}
+
+void Xil_ICacheEnable() {
+}
+
+void Xil_DCacheEnable() {
+}
+
+void Xil_CacheStats_reset() {
+	memset(&Xil_CacheStats, 0, sizeof(Xil_CacheStats));
+}
@@ -0,0 +1,29 @@
+/******************************************************************************
+ * xil_exception.c: Host stand-in for the Xilinx BSP (standalone) xil_exception
+ ******************************************************************************/
+
+
+#include "xil_exception.h"
+
+#include "board_sim.h"
+
+
+void Xil_ExceptionInit() {
+	BoardSim_init();
+}
+
+void Xil_ExceptionRegisterHandler(u32 Id, Xil_ExceptionHandler Handler, void* Data) {
+	if(Id != XIL_EXCEPTION_ID_INT)
+		return;
+
+	board.handler      = Handler;
+	board.handler_data = Data;
+}
+
+void Xil_ExceptionEnable() {
+	board.exceptions = 1;
+}
+
+void Xil_ExceptionDisable() {
+	board.exceptions = 0;
+}
@@ -0,0 +1,44 @@
+/******************************************************************************
+ * xil_io.c: Host stand-in for the Xilinx BSP (standalone) xil_io
+ ******************************************************************************/
+
+
+#include "xil_io.h"
+#include "xparameters.h"
+
+#include "board_sim.h"
+#include "dynclk.h"
+
+
+// Registerindex von axi_dynclk_0, sonst -1
+static int Xil_DynClkReg(UINTPTR Addr) {
+	if(Addr < XPAR_AXI_DYNCLK_0_BASEADDR || Addr >= XPAR_AXI_DYNCLK_0_BASEADDR + 4 * BOARD_SIM_DYNCLK_REGS)
+		return -1;
+
+	return (Addr - XPAR_AXI_DYNCLK_0_BASEADDR) / 4;
+}
+
+
+u32 Xil_In32(UINTPTR Addr) {
+	const int reg = Xil_DynClkReg(Addr);
+
+	BoardSim_init();
+
+	if(reg < 0)
+		return 0;
+
+	// MMCM rastet sofort ein
+	if(reg == OFST_DYNCLK_STATUS / 4)
+		return board.dynclk[OFST_DYNCLK_CTRL / 4] & (1 << BIT_DYNCLK_START) ? 1 << BIT_DYNCLK_RUNNING : 0;
+
+	return board.dynclk[reg];
+}
+
+void Xil_Out32(UINTPTR Addr, u32 Value) {
+	const int reg = Xil_DynClkReg(Addr);
+
+	BoardSim_init();
+
+	if(reg >= 0)
+		board.dynclk[reg] = Value;
+}
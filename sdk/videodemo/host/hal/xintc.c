@@ -0,0 +1,74 @@
+/******************************************************************************
+ * xintc.c: Host stand-in for the Xilinx axi_intc driver (xintc)
+ ******************************************************************************/
+
+
+#include <string.h>
+
+#include "xintc.h"
+#include "xparameters.h"
+
+#include "board_sim.h"
+
+
+int XIntc_Initialize(XIntc* InstancePtr, u16 DeviceId) {
+	if(DeviceId != XPAR_INTC_0_DEVICE_ID)
+		return XST_DEVICE_NOT_FOUND;
+
+	BoardSim_init();
+	BoardSim_lock();
+
+	memset(InstancePtr, 0, sizeof(*InstancePtr));
+	InstancePtr->BaseAddress = XPAR_INTC_0_BASEADDR;
+	InstancePtr->IsReady     = XIL_COMPONENT_IS_READY;
+
+	board.intc = InstancePtr;
+
+	BoardSim_unlock();
+
+	return XST_SUCCESS;
+}
+
+int XIntc_Start(XIntc* InstancePtr, u8 Mode) {
+	InstancePtr->IsStarted = Mode == XIN_REAL_MODE ? XIL_COMPONENT_IS_STARTED : 0;
+
+	return XST_SUCCESS;
+}
+
+int XIntc_Connect(XIntc* InstancePtr, u8 Id, XInterruptHandler Handler, void* CallBackRef) {
+	if(Id >= XPAR_INTC_MAX_NUM_INTR_INPUTS)
+		return XST_FAILURE;
+
+	InstancePtr->HandlerTable[Id].Handler     = Handler;
+	InstancePtr->HandlerTable[Id].CallBackRef = CallBackRef;
+
+	return XST_SUCCESS;
+}
+
+void XIntc_Enable(XIntc* InstancePtr, u8 Id) {
+	BoardSim_lock();
+	InstancePtr->Enabled |= 1u << Id;
+	BoardSim_unlock();
+}
+
+void XIntc_Disable(XIntc* InstancePtr, u8 Id) {
+	BoardSim_lock();
+	InstancePtr->Enabled &= ~(1u << Id);
+	InstancePtr->Pending &= ~(1u << Id);
+	BoardSim_unlock();
+}
+
+void XIntc_InterruptHandler(XIntc* InstancePtr) {
+	if(InstancePtr->IsStarted != XIL_COMPONENT_IS_STARTED)
+		return;
+
+	BoardSim_lock();
+	const u32 pending = InstancePtr->Pending & InstancePtr->Enabled;
+	InstancePtr->Pending &= ~pending;
+	BoardSim_unlock();
+
+	for(u32 id = 0; id < XPAR_INTC_MAX_NUM_INTR_INPUTS; id++) {
+		if((pending & (1u << id)) && InstancePtr->HandlerTable[id].Handler)
+			InstancePtr->HandlerTable[id].Handler(InstancePtr->HandlerTable[id].CallBackRef);
+	}
+}
@@ -0,0 +1,84 @@
+/******************************************************************************
+ * xtmrctr.c: Host stand-in for the Xilinx axi_timer low-level driver
+ ******************************************************************************/
+
+
+#include "xtmrctr_l.h"
+#include "xparameters.h"
+
+#include "board_sim.h"
+
+
+typedef struct {
+	u32 tcsr;
+	u32 tlr;
+	u32 count;    // Zaehlerstand zu since_ns
+	u64 since_ns;
+} XTmrCtr_Counter;
+
+static XTmrCtr_Counter XTmrCtr_Counters[XTC_DEVICE_TIMER_COUNT];
+
+
+static u32 XTmrCtr_Count(const XTmrCtr_Counter* counter) {
+	if(counter->tcsr & XTC_CSR_LOAD_MASK)
+		return counter->tlr;
+
+	if(!(counter->tcsr & XTC_CSR_ENABLE_TMR_MASK))
+		return counter->count;
+
+	const u32 ticks = (BoardSim_now_ns() - counter->since_ns) *
+		(XPAR_AXI_TIMER_0_CLOCK_FREQ_HZ / 1000000) / 1000;
+
+	return counter->tcsr & XTC_CSR_DOWN_COUNT_MASK ? counter->count - ticks : counter->count + ticks;
+}
+
+
+void XTmrCtr_SetControlStatusReg(UINTPTR BaseAddress, u8 TmrCtrNumber, u32 RegisterValue) {
+	XTmrCtr_Counter* counter = &XTmrCtr_Counters[TmrCtrNumber % XTC_DEVICE_TIMER_COUNT];
+
+	(void)BaseAddress;
+
+	counter->count    = XTmrCtr_Count(counter);
+	counter->since_ns = BoardSim_now_ns();
+	counter->tcsr     = RegisterValue;
+}
+
+u32 XTmrCtr_GetControlStatusReg(UINTPTR BaseAddress, u8 TmrCtrNumber) {
+	(void)BaseAddress;
+
+	return XTmrCtr_Counters[TmrCtrNumber % XTC_DEVICE_TIMER_COUNT].tcsr;
+}
+
+u32 XTmrCtr_GetTimerCounterReg(UINTPTR BaseAddress, u8 TmrCtrNumber) {
+	(void)BaseAddress;
+
+	return XTmrCtr_Count(&XTmrCtr_Counters[TmrCtrNumber % XTC_DEVICE_TIMER_COUNT]);
+}
+
+void XTmrCtr_SetLoadReg(UINTPTR BaseAddress, u8 TmrCtrNumber, u32 RegisterValue) {
+	(void)BaseAddress;
+
+	XTmrCtr_Counters[TmrCtrNumber % XTC_DEVICE_TIMER_COUNT].tlr = RegisterValue;
+}
+
+u32 XTmrCtr_GetLoadReg(UINTPTR BaseAddress, u8 TmrCtrNumber) {
+	(void)BaseAddress;
+
+	return XTmrCtr_Counters[TmrCtrNumber % XTC_DEVICE_TIMER_COUNT].tlr;
+}
+
+
+void XTmrCtr_Enable(UINTPTR BaseAddress, u8 TmrCtrNumber) {
+	XTmrCtr_SetControlStatusReg(BaseAddress, TmrCtrNumber,
+		XTmrCtr_GetControlStatusReg(BaseAddress, TmrCtrNumber) | XTC_CSR_ENABLE_TMR_MASK);
+}
+
+void XTmrCtr_Disable(UINTPTR BaseAddress, u8 TmrCtrNumber) {
+	XTmrCtr_SetControlStatusReg(BaseAddress, TmrCtrNumber,
+		XTmrCtr_GetControlStatusReg(BaseAddress, TmrCtrNumber) & ~XTC_CSR_ENABLE_TMR_MASK);
+}
+
+void XTmrCtr_LoadTimerCounterReg(UINTPTR BaseAddress, u8 TmrCtrNumber) {
+	XTmrCtr_SetControlStatusReg(BaseAddress, TmrCtrNumber,
+		XTmrCtr_GetControlStatusReg(BaseAddress, TmrCtrNumber) | XTC_CSR_LOAD_MASK);
+}
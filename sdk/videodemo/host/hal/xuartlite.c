@@ -0,0 +1,83 @@
+/******************************************************************************
+ * xuartlite.c: Host stand-in for the Xilinx axi_uartlite low-level driver
+ ******************************************************************************/
+
+
+#include <stdio.h>
+#include <sys/select.h>
+#include <unistd.h>
+
+#include "xuartlite_l.h"
+
+#include "board_sim.h"
+
+
+// naechstes Zeichen in den Empfangs-FIFO (ein Zeichen tief)
+static void XUartLite_Receive() {
+	fd_set         fds;
+	struct timeval tv = { 0, 0 };
+	char           c;
+
+	if(board.uart_char >= 0 || board.uart_eof || BoardSim_now_ns() < board.uart_next_ns)
+		return;
+
+	FD_ZERO(&fds);
+	FD_SET(board.uart_fd, &fds);
+
+	if(select(board.uart_fd + 1, &fds, NULL, NULL, &tv) <= 0)
+		return;
+
+	if(read(board.uart_fd, &c, 1) == 1) {
+		board.uart_char    = (u8)c;
+		board.uart_next_ns = BoardSim_now_ns() + board.uart_key_ns;
+
+		return;
+	}
+
+	// Ende der Eingabe (Datei/Pipe): Demo beenden
+	board.uart_eof = 1;
+
+	if(!board.uart_tty)
+		board.uart_char = 'q';
+}
+
+
+int XUartLite_IsReceiveEmpty(UINTPTR BaseAddress) {
+	(void)BaseAddress;
+
+	BoardSim_poll();
+	XUartLite_Receive();
+
+	return board.uart_char < 0;
+}
+
+u32 XUartLite_ReadReg(UINTPTR BaseAddress, u32 RegOffset) {
+	(void)BaseAddress;
+
+	BoardSim_init();
+
+	if(RegOffset != XUL_RX_FIFO_OFFSET || board.uart_char < 0)
+		return 0;
+
+	const u32 c = board.uart_char;
+
+	board.uart_char = -1;
+
+	return c;
+}
+
+void XUartLite_SendByte(UINTPTR BaseAddress, u8 Data) {
+	(void)BaseAddress;
+
+	BoardSim_init();
+
+	putchar(Data);
+	fflush(stdout);
+}
+
+u8 XUartLite_RecvByte(UINTPTR BaseAddress) {
+	while(XUartLite_IsReceiveEmpty(BaseAddress))
+		usleep(1000);
+
+	return XUartLite_ReadReg(BaseAddress, XUL_RX_FIFO_OFFSET);
+}
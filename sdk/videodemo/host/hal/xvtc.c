@@ -0,0 +1,139 @@
+/******************************************************************************
+ * xvtc.c: Host stand-in for the Xilinx v_tc driver (xvtc)
+ ******************************************************************************/
+
+
+#include <string.h>
+
+#include "xvtc.h"
+#include "xparameters.h"
+
+#include "board_sim.h"
+
+
+static XVtc_Config XVtc_ConfigTable[BOARD_SIM_NUM_VTC] = {
+	{ XPAR_VTC_0_DEVICE_ID, XPAR_V_TC_0_BASEADDR },
+	{ XPAR_VTC_1_DEVICE_ID, XPAR_V_TC_1_BASEADDR } };
+
+
+XVtc_Config* XVtc_LookupConfig(u16 DeviceId) {
+	for(u32 i = 0; i < BOARD_SIM_NUM_VTC; i++) {
+		if(XVtc_ConfigTable[i].DeviceId == DeviceId)
+			return &XVtc_ConfigTable[i];
+	}
+
+	return NULL;
+}
+
+int XVtc_CfgInitialize(XVtc* InstancePtr, XVtc_Config* CfgPtr, UINTPTR EffectiveAddr) {
+	BoardSim_init();
+	BoardSim_lock();
+
+	memset(InstancePtr, 0, sizeof(*InstancePtr));
+	InstancePtr->Config             = *CfgPtr;
+	InstancePtr->Config.BaseAddress = EffectiveAddr;
+	InstancePtr->IsReady            = XIL_COMPONENT_IS_READY;
+
+	board.vtc[CfgPtr->DeviceId] = InstancePtr;
+
+	BoardSim_unlock();
+
+	return XST_SUCCESS;
+}
+
+int XVtc_SelfTest(XVtc* InstancePtr) {
+	return InstancePtr->IsReady == XIL_COMPONENT_IS_READY ? XST_SUCCESS : XST_FAILURE;
+}
+
+
+void XVtc_RegUpdateEnable(XVtc* InstancePtr) {
+	(void)InstancePtr;
+}
+
+void XVtc_SetGeneratorTiming(XVtc* InstancePtr, XVtc_Timing* TimingPtr) {
+	InstancePtr->GeneratorTiming = *TimingPtr;
+}
+
+void XVtc_SetSource(XVtc* InstancePtr, XVtc_SourceSelect* SourcePtr) {
+	InstancePtr->Source = *SourcePtr;
+}
+
+void XVtc_EnableGenerator(XVtc* InstancePtr) {
+	BoardSim_lock();
+	InstancePtr->GeneratorEnabled = 1;
+	BoardSim_unlock();
+}
+
+void XVtc_DisableGenerator(XVtc* InstancePtr) {
+	BoardSim_lock();
+	InstancePtr->GeneratorEnabled = 0;
+	BoardSim_unlock();
+}
+
+void XVtc_EnableDetector(XVtc* InstancePtr) {
+	BoardSim_lock();
+	InstancePtr->DetectorEnabled = 1;
+	BoardSim_unlock();
+}
+
+void XVtc_DisableDetector(XVtc* InstancePtr) {
+	BoardSim_lock();
+	InstancePtr->DetectorEnabled = 0;
+	BoardSim_unlock();
+}
+
+
+u32 XVtc_GetDetectionStatus(XVtc* InstancePtr) {
+	BoardSim_lock();
+	const u32 locked = InstancePtr->DetectorEnabled && board.locked;
+	BoardSim_unlock();
+
+	return locked ? XVTC_STAT_LOCKED_MASK : 0;
+}
+
+// nur die Bildgroesse der Quelle, Austastluecken werden nicht simuliert
+void XVtc_GetDetectorTiming(XVtc* InstancePtr, XVtc_Timing* TimingPtr) {
+	(void)InstancePtr;
+
+	memset(TimingPtr, 0, sizeof(*TimingPtr));
+	TimingPtr->HActiveVideo  = board.width;
+	TimingPtr->VActiveVideo  = board.height;
+	TimingPtr->HSyncPolarity = 1;
+	TimingPtr->VSyncPolarity = 1;
+}
+
+
+int XVtc_SetCallBack(XVtc* InstancePtr, u32 HandlerType, void* CallBackFunc, void* CallBackRef) {
+	if(HandlerType != XVTC_HANDLER_LOCK)
+		return XST_SUCCESS;
+
+	InstancePtr->LockCallBack = (XVtc_CallBack)CallBackFunc;
+	InstancePtr->LockRef      = CallBackRef;
+
+	return XST_SUCCESS;
+}
+
+void XVtc_IntrEnable(XVtc* InstancePtr, u32 IntrType) {
+	BoardSim_lock();
+	InstancePtr->IntrEnabled |= IntrType;
+	BoardSim_unlock();
+}
+
+void XVtc_IntrDisable(XVtc* InstancePtr, u32 IntrType) {
+	BoardSim_lock();
+	InstancePtr->IntrEnabled &= ~IntrType;
+	BoardSim_unlock();
+}
+
+void XVtc_IntrClear(XVtc* InstancePtr, u32 IntrType) {
+	(void)InstancePtr;
+	(void)IntrType;
+}
+
+void XVtc_IntrHandler(void* InstancePtr) {
+	XVtc* vtc = (XVtc*)InstancePtr;
+
+	if((vtc->IntrEnabled & XVTC_IXR_LOCK_MASK) && vtc->LockCallBack &&
+	 (XVtc_GetDetectionStatus(vtc) & XVTC_STAT_LOCKED_MASK))
+		vtc->LockCallBack(vtc->LockRef, XVTC_IXR_LOCK_MASK);
+}
@@ -0,0 +1,13 @@
+/******************************************************************************
+ * sleep.h: Host stand-in for the Xilinx BSP (standalone) sleep/usleep
+ ******************************************************************************/
+
+
+#ifndef SLEEP_H
+#define SLEEP_H
+
+
+#include <unistd.h>
+
+
+#endif
@@ -0,0 +1,84 @@
+/******************************************************************************
+ * xaxivdma.h: Host stand-in for the Xilinx axi_vdma driver (xaxivdma)
+ ******************************************************************************
+ * Channel state only; the transfers are done by the simulated board
+ * (board_sim.h): the write channel (S2MM) stores the simulated video input
+ * into the parked frame store, the read channel (MM2S) sends the parked
+ * frame store to the display output file. Configuration changes are taken
+ * over at the next frame, as on the VDMA.
+ ******************************************************************************/
+
+
+#ifndef XAXIVDMA_H
+#define XAXIVDMA_H
+
+
+#include "xil_types.h"
+#include "xstatus.h"
+
+
+#define XAXIVDMA_READ  1
+#define XAXIVDMA_WRITE 2
+
+#define XAXIVDMA_MAX_FRAMESTORE 32
+
+
+typedef struct {
+	u16     DeviceId;
+	UINTPTR BaseAddress;
+	u16     MaxFrameStoreNum; // C_NUM_FSTORES
+} XAxiVdma_Config;
+
+typedef struct {
+	int VertSizeInput;
+	int HoriSizeInput;
+	int Stride;
+	int FrameDelay;
+	int EnableCircularBuf;
+	int EnableSync;
+	int PointNum;
+	int EnableFrameCounter;
+	UINTPTR FrameStoreStartAddr[XAXIVDMA_MAX_FRAMESTORE];
+	int FixedFrameStoreAddr;
+	int GenLockRepeat;
+	int EnableVFlip;
+} XAxiVdma_DmaSetup;
+
+typedef struct {
+	u32     IsValid;
+	u32     Running;
+	u32     Park;
+	u32     HSize;  // Bytes je Zeile
+	u32     VSize;
+	u32     Stride;
+	UINTPTR Addr[XAXIVDMA_MAX_FRAMESTORE];
+	u32     Frames; // uebertragene Bilder
+} XAxiVdma_Channel;
+
+typedef struct {
+	UINTPTR          BaseAddress;
+	u32              IsReady;
+	u16              MaxNumFrames;
+	XAxiVdma_Channel ReadChannel;
+	XAxiVdma_Channel WriteChannel;
+} XAxiVdma;
+
+
+XAxiVdma_Config* XAxiVdma_LookupConfig(u16 DeviceId);
+int  XAxiVdma_CfgInitialize(XAxiVdma* InstancePtr, XAxiVdma_Config* CfgPtr, UINTPTR EffectiveAddr);
+
+int  XAxiVdma_DmaConfig(XAxiVdma* InstancePtr, u16 Direction, XAxiVdma_DmaSetup* DmaConfigPtr);
+int  XAxiVdma_DmaSetBufferAddr(XAxiVdma* InstancePtr, u16 Direction, UINTPTR* BufferAddrSet);
+int  XAxiVdma_DmaStart(XAxiVdma* InstancePtr, u16 Direction);
+void XAxiVdma_DmaStop(XAxiVdma* InstancePtr, u16 Direction);
+int  XAxiVdma_StartParking(XAxiVdma* InstancePtr, int FrameIndex, u16 Direction);
+
+int  XAxiVdma_IsBusy(XAxiVdma* InstancePtr, u16 Direction);
+u32  XAxiVdma_GetDmaChannelErrors(XAxiVdma* InstancePtr, u16 Direction);
+int  XAxiVdma_ClearDmaChannelErrors(XAxiVdma* InstancePtr, u16 Direction, u32 ErrorMask);
+
+void XAxiVdma_Reset(XAxiVdma* InstancePtr, int Direction);
+int  XAxiVdma_ResetNotDone(XAxiVdma* InstancePtr, int Direction);
+
+
+#endif
@@ -0,0 +1,24 @@
+/******************************************************************************
+ * xdebug.h: Host stand-in for the Xilinx BSP (standalone) xdebug
+ ******************************************************************************/
+
+
+#ifndef XDEBUG_H
+#define XDEBUG_H
+
+
+#include <stdio.h>
+
+
+#define XDBG_DEBUG_ERROR   0x00000001
+#define XDBG_DEBUG_GENERAL 0x00000002
+#define XDBG_DEBUG_ALL     0xFFFFFFFF
+
+#if defined(DEBUG) && !defined(NDEBUG)
+	#define xdbg_printf(type, ...) ((type) ? printf(__VA_ARGS__) : 0)
+#else
+	#define xdbg_printf(...)
+#endif
+
+
+#endif
@@ -0,0 +1,45 @@
+/******************************************************************************
+ * xgpio.h: Host stand-in for the Xilinx axi_gpio driver (xgpio)
+ ******************************************************************************
+ * axi_gpio_video of the simulated board (board_sim.h): channel 1 drives HPD,
+ * channel 2 reads the pixel clock lock of the video input; a change of
+ * channel 2 raises the GPIO interrupt.
+ ******************************************************************************/
+
+
+#ifndef XGPIO_H
+#define XGPIO_H
+
+
+#include "xil_types.h"
+#include "xstatus.h"
+
+
+#define XGPIO_IR_CH1_MASK 0x1
+#define XGPIO_IR_CH2_MASK 0x2
+
+
+typedef struct {
+	UINTPTR BaseAddress;
+	u32     IsReady;
+	u32     Data[2];
+	u32     Tri[2];
+	u32     InterruptEnabled;
+	u32     InterruptGlobalEnabled;
+	u32     InterruptStatus;
+} XGpio;
+
+
+int  XGpio_Initialize(XGpio* InstancePtr, u16 DeviceId);
+int  XGpio_SelfTest(XGpio* InstancePtr);
+
+void XGpio_SetDataDirection(XGpio* InstancePtr, unsigned Channel, u32 DirectionMask);
+u32  XGpio_DiscreteRead(XGpio* InstancePtr, unsigned Channel);
+void XGpio_DiscreteWrite(XGpio* InstancePtr, unsigned Channel, u32 Data);
+
+void XGpio_InterruptGlobalEnable(XGpio* InstancePtr);
+void XGpio_InterruptEnable(XGpio* InstancePtr, u32 Mask);
+void XGpio_InterruptClear(XGpio* InstancePtr, u32 Mask);
+
+
+#endif
@@ -0,0 +1,23 @@
+/******************************************************************************
+ * xil_assert.h: Host stand-in for the Xilinx BSP (standalone) xil_assert
+ ******************************************************************************/
+
+
+#ifndef XIL_ASSERT_H
+#define XIL_ASSERT_H
+
+
+#include <assert.h>
+
+#include "xil_types.h"
+#include "xil_printf.h"
+
+
+#define XIL_COMPONENT_IS_READY   0x11111111U
+#define XIL_COMPONENT_IS_STARTED 0x22222222U
+
+#define Xil_AssertVoid(Expression)    assert(Expression)
+#define Xil_AssertNonvoid(Expression) assert(Expression)
+
+
+#endif
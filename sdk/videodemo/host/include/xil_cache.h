@@ -0,0 +1,43 @@
+/******************************************************************************
+ * xil_cache.h: Host stand-in for the Xilinx BSP (standalone) xil_cache
+ ******************************************************************************
+ * No cache to maintain on the host; flush and invalidate calls are counted
+ * in cache lines of the MicroBlaze D-cache instead (hdmi.hwh:
+ * C_DCACHE_LINE_LEN = 8 words), so flush ranges can be checked off-board.
+ ******************************************************************************/
+
+
+#ifndef XIL_CACHE_H
+#define XIL_CACHE_H
+
+
+#include "xil_types.h"
+
+
+#define XIL_CACHE_LINE_LEN 32
+#define XIL_CACHE_SIZE     32768
+
+
+typedef struct {
+	u64 flush_calls;
+	u64 flush_lines;
+	u64 invalidate_calls;
+	u64 invalidate_lines;
+} XilCacheStats;
+
+extern XilCacheStats Xil_CacheStats;
+
+
+void Xil_DCacheFlushRange(UINTPTR adr, u32 len);
+void Xil_DCacheInvalidateRange(UINTPTR adr, u32 len);
+
+void Xil_DCacheFlush();
+void Xil_DCacheInvalidate();
+
+void Xil_ICacheEnable();
+void Xil_DCacheEnable();
+
+void Xil_CacheStats_reset();
+
+
+#endif
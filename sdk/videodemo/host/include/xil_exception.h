@@ -0,0 +1,27 @@
+/******************************************************************************
+ * xil_exception.h: Host stand-in for the Xilinx BSP (standalone) xil_exception
+ ******************************************************************************
+ * Only the external interrupt exception exists; it is taken in the main
+ * thread at the polling points of the simulated board (BoardSim_poll).
+ ******************************************************************************/
+
+
+#ifndef XIL_EXCEPTION_H
+#define XIL_EXCEPTION_H
+
+
+#include "xil_types.h"
+
+
+#define XIL_EXCEPTION_ID_INT 1
+
+typedef void (*Xil_ExceptionHandler)(void* Data);
+
+
+void Xil_ExceptionInit();
+void Xil_ExceptionRegisterHandler(u32 Id, Xil_ExceptionHandler Handler, void* Data);
+void Xil_ExceptionEnable();
+void Xil_ExceptionDisable();
+
+
+#endif
@@ -0,0 +1,21 @@
+/******************************************************************************
+ * xil_io.h: Host stand-in for the Xilinx BSP (standalone) xil_io
+ ******************************************************************************
+ * Register accesses of cores without a driver stand-in (axi_dynclk) go to
+ * the simulated board (board_sim.h).
+ ******************************************************************************/
+
+
+#ifndef XIL_IO_H
+#define XIL_IO_H
+
+
+#include "xil_types.h"
+#include "xil_printf.h"
+
+
+u32  Xil_In32(UINTPTR Addr);
+void Xil_Out32(UINTPTR Addr, u32 Value);
+
+
+#endif
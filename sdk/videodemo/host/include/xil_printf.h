@@ -0,0 +1,16 @@
+/******************************************************************************
+ * xil_printf.h: Host stand-in for the Xilinx BSP (standalone) xil_printf
+ ******************************************************************************/
+
+
+#ifndef XIL_PRINTF_H
+#define XIL_PRINTF_H
+
+
+#include <stdio.h>
+
+
+#define xil_printf printf
+
+
+#endif
@@ -0,0 +1,49 @@
+/******************************************************************************
+ * xintc.h: Host stand-in for the Xilinx axi_intc driver (xintc)
+ ******************************************************************************
+ * Interrupt lines of the simulated board are latched in Pending
+ * (BoardSim_poll) and serviced by XIntc_InterruptHandler once the interrupt
+ * exception is enabled.
+ ******************************************************************************/
+
+
+#ifndef XINTC_H
+#define XINTC_H
+
+
+#include "xil_types.h"
+#include "xil_assert.h"
+#include "xil_exception.h"
+#include "xstatus.h"
+
+
+#define XIN_SIMULATION_MODE 1
+#define XIN_REAL_MODE       2
+
+#define XPAR_INTC_MAX_NUM_INTR_INPUTS 32
+
+
+typedef struct {
+	XInterruptHandler Handler;
+	void*             CallBackRef;
+} XIntc_VectorTableEntry;
+
+typedef struct {
+	UINTPTR BaseAddress;
+	u32     IsReady;
+	u32     IsStarted;
+	u32     Enabled;
+	u32     Pending;
+	XIntc_VectorTableEntry HandlerTable[XPAR_INTC_MAX_NUM_INTR_INPUTS];
+} XIntc;
+
+
+int  XIntc_Initialize(XIntc* InstancePtr, u16 DeviceId);
+int  XIntc_Start(XIntc* InstancePtr, u8 Mode);
+int  XIntc_Connect(XIntc* InstancePtr, u8 Id, XInterruptHandler Handler, void* CallBackRef);
+void XIntc_Enable(XIntc* InstancePtr, u8 Id);
+void XIntc_Disable(XIntc* InstancePtr, u8 Id);
+void XIntc_InterruptHandler(XIntc* InstancePtr);
+
+
+#endif
@@ -0,0 +1,42 @@
+/******************************************************************************
+ * xparameters.h: Host stand-in for the BSP xparameters of the hdmi design
+ ******************************************************************************
+ * Values as in src/bd/hdmi/hw_handoff/hdmi.hwh (address map, interrupt
+ * concat inputs In0..In5, 100 MHz AXI clock); only what the demo uses.
+ ******************************************************************************/
+
+
+#ifndef XPARAMETERS_H
+#define XPARAMETERS_H
+
+
+#define XPAR_AXIVDMA_0_DEVICE_ID         0
+#define XPAR_AXI_VDMA_0_BASEADDR         0x44A00000
+
+#define XPAR_VTC_0_DEVICE_ID             0
+#define XPAR_V_TC_0_BASEADDR             0x44A10000
+#define XPAR_VTC_1_DEVICE_ID             1
+#define XPAR_V_TC_1_BASEADDR             0x44A30000
+
+#define XPAR_AXI_DYNCLK_0_BASEADDR       0x44A20000
+
+#define XPAR_AXI_GPIO_VIDEO_DEVICE_ID    0
+#define XPAR_AXI_GPIO_VIDEO_BASEADDR     0x40000000
+
+#define XPAR_AXI_TIMER_0_DEVICE_ID       0
+#define XPAR_AXI_TIMER_0_BASEADDR        0x41C00000
+#define XPAR_AXI_TIMER_0_CLOCK_FREQ_HZ   100000000
+
+#define XPAR_UARTLITE_0_BASEADDR         0x40600000
+
+#define XPAR_INTC_0_DEVICE_ID            0
+#define XPAR_INTC_0_BASEADDR             0x41200000
+#define XPAR_INTC_0_AXIVDMA_0_MM2S_VEC_ID 0
+#define XPAR_INTC_0_AXIVDMA_0_S2MM_VEC_ID 1
+#define XPAR_INTC_0_VTC_0_VEC_ID         2
+#define XPAR_INTC_0_VTC_1_VEC_ID         3
+#define XPAR_INTC_0_GPIO_0_VEC_ID        4
+#define XPAR_INTC_0_TMRCTR_0_VEC_ID      5
+
+
+#endif
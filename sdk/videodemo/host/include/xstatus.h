@@ -0,0 +1,23 @@
+/******************************************************************************
+ * xstatus.h: Host stand-in for the Xilinx BSP (standalone) xstatus
+ ******************************************************************************/
+
+
+#ifndef XSTATUS_H
+#define XSTATUS_H
+
+
+#include "xil_types.h"
+#include "xil_assert.h"
+
+
+#define XST_SUCCESS      0L
+#define XST_FAILURE      1L
+#define XST_DEVICE_NOT_FOUND 2L
+#define XST_NO_DATA      13L
+#define XST_DMA_ERROR    509L
+
+typedef s32 XStatus;
+
+
+#endif
@@ -0,0 +1,42 @@
+/******************************************************************************
+ * xtmrctr_l.h: Host stand-in for the Xilinx axi_timer low-level driver
+ ******************************************************************************
+ * Both counters of axi_timer_0 count up at XPAR_AXI_TIMER_0_CLOCK_FREQ_HZ
+ * of CLOCK_MONOTONIC (BoardSim_now_ns); the BSP macros are functions here.
+ ******************************************************************************/
+
+
+#ifndef XTMRCTR_L_H
+#define XTMRCTR_L_H
+
+
+#include "xil_types.h"
+
+
+#define XTC_DEVICE_TIMER_COUNT 2
+
+#define XTC_CSR_ENABLE_ALL_MASK    0x00000400
+#define XTC_CSR_ENABLE_PWM_MASK    0x00000200
+#define XTC_CSR_INT_OCCURED_MASK   0x00000100
+#define XTC_CSR_ENABLE_TMR_MASK    0x00000080
+#define XTC_CSR_ENABLE_INT_MASK    0x00000040
+#define XTC_CSR_LOAD_MASK          0x00000020
+#define XTC_CSR_AUTO_RELOAD_MASK   0x00000010
+#define XTC_CSR_EXT_CAPTURE_MASK   0x00000008
+#define XTC_CSR_EXT_GENERATE_MASK  0x00000004
+#define XTC_CSR_DOWN_COUNT_MASK    0x00000002
+#define XTC_CSR_CAPTURE_MODE_MASK  0x00000001
+
+
+void XTmrCtr_SetControlStatusReg(UINTPTR BaseAddress, u8 TmrCtrNumber, u32 RegisterValue);
+u32  XTmrCtr_GetControlStatusReg(UINTPTR BaseAddress, u8 TmrCtrNumber);
+u32  XTmrCtr_GetTimerCounterReg(UINTPTR BaseAddress, u8 TmrCtrNumber);
+void XTmrCtr_SetLoadReg(UINTPTR BaseAddress, u8 TmrCtrNumber, u32 RegisterValue);
+u32  XTmrCtr_GetLoadReg(UINTPTR BaseAddress, u8 TmrCtrNumber);
+
+void XTmrCtr_Enable(UINTPTR BaseAddress, u8 TmrCtrNumber);
+void XTmrCtr_Disable(UINTPTR BaseAddress, u8 TmrCtrNumber);
+void XTmrCtr_LoadTimerCounterReg(UINTPTR BaseAddress, u8 TmrCtrNumber);
+
+
+#endif
@@ -0,0 +1,29 @@
+/******************************************************************************
+ * xuartlite_l.h: Host stand-in for the Xilinx axi_uartlite low-level driver
+ ******************************************************************************
+ * Receive side of the simulated UART (board_sim.h): stdin in raw mode or a
+ * pseudo terminal (HMOD_HOST_UART = pty). Polling the receive FIFO is also
+ * where pending interrupts of the simulated board are taken.
+ ******************************************************************************/
+
+
+#ifndef XUARTLITE_L_H
+#define XUARTLITE_L_H
+
+
+#include "xil_types.h"
+
+
+#define XUL_RX_FIFO_OFFSET 0
+#define XUL_TX_FIFO_OFFSET 4
+#define XUL_STATUS_REG_OFFSET  8
+#define XUL_CONTROL_REG_OFFSET 12
+
+
+int  XUartLite_IsReceiveEmpty(UINTPTR BaseAddress);
+u32  XUartLite_ReadReg(UINTPTR BaseAddress, u32 RegOffset);
+void XUartLite_SendByte(UINTPTR BaseAddress, u8 Data);
+u8   XUartLite_RecvByte(UINTPTR BaseAddress);
+
+
+#endif
@@ -0,0 +1,117 @@
+/******************************************************************************
+ * xvtc.h: Host stand-in for the Xilinx v_tc driver (xvtc)
+ ******************************************************************************
+ * Generator (display) and detector (video input) state; the detector locks
+ * onto the simulated video input (board_sim.h) and raises the lock
+ * interrupt while it is enabled.
+ ******************************************************************************/
+
+
+#ifndef XVTC_H
+#define XVTC_H
+
+
+#include <string.h>
+
+#include "xil_types.h"
+#include "xstatus.h"
+
+
+#define XVTC_HANDLER_FRAMESYNC 1
+#define XVTC_HANDLER_LOCK      2
+#define XVTC_HANDLER_DETECTOR  3
+#define XVTC_HANDLER_GENERATOR 4
+#define XVTC_HANDLER_ERROR     5
+
+#define XVTC_IXR_LOCK_MASK     0x00000100
+#define XVTC_STAT_LOCKED_MASK  XVTC_IXR_LOCK_MASK
+
+
+typedef void (*XVtc_CallBack)(void* CallBackRef, u32 Mask);
+
+typedef struct {
+	u16     DeviceId;
+	UINTPTR BaseAddress;
+} XVtc_Config;
+
+typedef struct {
+	u16 HActiveVideo;
+	u16 HFrontPorch;
+	u16 HSyncWidth;
+	u16 HBackPorch;
+	u16 HSyncPolarity;
+
+	u16 VActiveVideo;
+	u16 V0FrontPorch;
+	u16 V0SyncWidth;
+	u16 V0BackPorch;
+	u16 V1FrontPorch;
+	u16 V1SyncWidth;
+	u16 V1BackPorch;
+	u16 VSyncPolarity;
+
+	u8  Interlaced;
+} XVtc_Timing;
+
+typedef struct {
+	u8 FieldIdPolSrc;
+	u8 ActiveChromaPolSrc;
+	u8 ActiveVideoPolSrc;
+	u8 HSyncPolSrc;
+	u8 VSyncPolSrc;
+	u8 HBlankPolSrc;
+	u8 VBlankPolSrc;
+
+	u8 VChromaSrc;
+	u8 VActiveSrc;
+	u8 VBackPorchSrc;
+	u8 VSyncSrc;
+	u8 VFrontPorchSrc;
+	u8 VTotalSrc;
+	u8 HActiveSrc;
+	u8 HBackPorchSrc;
+	u8 HSyncSrc;
+	u8 HFrontPorchSrc;
+	u8 HTotalSrc;
+
+	u8 InterlacedMode;
+} XVtc_SourceSelect;
+
+typedef struct {
+	XVtc_Config Config;
+	u32         IsReady;
+
+	u32         GeneratorEnabled;
+	u32         DetectorEnabled;
+	u32         IntrEnabled;
+	XVtc_Timing GeneratorTiming;
+	XVtc_SourceSelect Source;
+
+	XVtc_CallBack LockCallBack;
+	void*         LockRef;
+} XVtc;
+
+
+XVtc_Config* XVtc_LookupConfig(u16 DeviceId);
+int  XVtc_CfgInitialize(XVtc* InstancePtr, XVtc_Config* CfgPtr, UINTPTR EffectiveAddr);
+int  XVtc_SelfTest(XVtc* InstancePtr);
+
+void XVtc_RegUpdateEnable(XVtc* InstancePtr);
+void XVtc_SetGeneratorTiming(XVtc* InstancePtr, XVtc_Timing* TimingPtr);
+void XVtc_SetSource(XVtc* InstancePtr, XVtc_SourceSelect* SourcePtr);
+void XVtc_EnableGenerator(XVtc* InstancePtr);
+void XVtc_DisableGenerator(XVtc* InstancePtr);
+void XVtc_EnableDetector(XVtc* InstancePtr);
+void XVtc_DisableDetector(XVtc* InstancePtr);
+
+u32  XVtc_GetDetectionStatus(XVtc* InstancePtr);
+void XVtc_GetDetectorTiming(XVtc* InstancePtr, XVtc_Timing* TimingPtr);
+
+int  XVtc_SetCallBack(XVtc* InstancePtr, u32 HandlerType, void* CallBackFunc, void* CallBackRef);
+void XVtc_IntrEnable(XVtc* InstancePtr, u32 IntrType);
+void XVtc_IntrDisable(XVtc* InstancePtr, u32 IntrType);
+void XVtc_IntrClear(XVtc* InstancePtr, u32 IntrType);
+void XVtc_IntrHandler(void* InstancePtr);
+
+
+#endif
@@ -0,0 +1,541 @@
+/******************************************************************************
+ * frame_io.c: Streaming video file readers and writers (Y4M, raw) for HMod
+ ******************************************************************************/
+
+
+#define _GNU_SOURCE
+
+#include <fcntl.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "frame_io.h"
+
+
+#define FRAME_IO_Y4M_HEADER 1024
+
+
+static const char* const format_names[] = {
+	"y4m", "rgb24", "yuv420p", "yuv422p", "yuv444p", "gray" };
+
+
+FrameIoFormat FrameIo_format(const char* name, FrameIoFormat fallback) {
+	const char* ext = strrchr(name, '.');
+
+	if(!ext)
+		return fallback;
+
+	if(!strcasecmp(ext, ".y4m"))  return FRAME_IO_Y4M;
+	if(!strcasecmp(ext, ".rgb"))  return FRAME_IO_RGB24;
+	if(!strcasecmp(ext, ".yuv"))  return FRAME_IO_YUV420P;
+	if(!strcasecmp(ext, ".gray")) return FRAME_IO_GRAY;
+
+	return fallback;
+}
+
+int FrameIo_parse_format(const char* name) {
+	for(u32 i = 0; i < sizeof(format_names) / sizeof(format_names[0]); i++)
+		if(!strcasecmp(name, format_names[i]))
+			return i;
+
+	return -1;
+}
+
+
+// Bildgroesse und Ebenen fuer das Pixelformat chroma
+static void FrameIo_layout(FrameIoLayout* layout, FrameIoFormat format, FrameIoFormat chroma,
+ u32 width, u32 height) {
+	layout->format   = format;
+	layout->chroma   = chroma;
+	layout->width    = width;
+	layout->height   = height;
+	layout->cx_shift = chroma == FRAME_IO_YUV420P || chroma == FRAME_IO_YUV422P;
+	layout->cy_shift = chroma == FRAME_IO_YUV420P;
+
+	const u32 cw = (width  + (1 << layout->cx_shift) - 1) >> layout->cx_shift;
+	const u32 ch = (height + (1 << layout->cy_shift) - 1) >> layout->cy_shift;
+
+	if(chroma == FRAME_IO_RGB24)
+		layout->frame_bytes = 3 * width * height;
+	else if(chroma == FRAME_IO_GRAY)
+		layout->frame_bytes = width * height;
+	else
+		layout->frame_bytes = width * height + 2 * cw * ch;
+}
+
+
+// BT.601, begrenzter Bereich (Y 16..235, Cb/Cr 16..240)
+
+static inline u8 FrameIo_clip(int v) {
+	return v < 0 ? 0 : v > 255 ? 255 : v;
+}
+
+static inline u8 FrameIo_y(const u8* p) {
+	return ((66 * p[0] + 129 * p[1] + 25 * p[2] + 128) >> 8) + 16;
+}
+
+static inline int FrameIo_cb(const u8* p) {
+	return -38 * p[0] - 74 * p[1] + 112 * p[2];
+}
+
+static inline int FrameIo_cr(const u8* p) {
+	return 112 * p[0] - 94 * p[1] - 18 * p[2];
+}
+
+// Chroma: Mittelwert je Block, beim Lesen wiederholt
+static void FrameIo_from_rgb(const FrameIoLayout* layout, const u8* rgb, u32 stride, u8* dst) {
+	const u32 w  = layout->width;
+	const u32 h  = layout->height;
+	const u32 bx = 1 << layout->cx_shift;
+	const u32 by = 1 << layout->cy_shift;
+	const u32 cw = (w + bx - 1) >> layout->cx_shift;
+	const u32 ch = (h + by - 1) >> layout->cy_shift;
+
+	if(layout->chroma == FRAME_IO_RGB24) {
+		for(u32 y = 0; y < h; y++)
+			memcpy(dst + y * 3 * w, rgb + y * stride, 3 * w);
+
+		return;
+	}
+
+	for(u32 y = 0; y < h; y++) {
+		const u8* p = rgb + y * stride;
+
+		for(u32 x = 0; x < w; x++, p += 3)
+			dst[y * w + x] = FrameIo_y(p);
+	}
+
+	if(layout->chroma == FRAME_IO_GRAY)
+		return;
+
+	u8* cb = dst + w * h;
+	u8* cr = cb + cw * ch;
+
+	for(u32 cy = 0; cy < ch; cy++) {
+		for(u32 cx = 0; cx < cw; cx++) {
+			const u32 x0 = cx << layout->cx_shift, x1 = x0 + bx < w ? x0 + bx : w;
+			const u32 y0 = cy << layout->cy_shift, y1 = y0 + by < h ? y0 + by : h;
+			const int n  = (x1 - x0) * (y1 - y0);
+			int       sb = 0, sr = 0;
+
+			for(u32 y = y0; y < y1; y++) {
+				const u8* p = rgb + y * stride + 3 * x0;
+
+				for(u32 x = x0; x < x1; x++, p += 3) {
+					sb += FrameIo_cb(p);
+					sr += FrameIo_cr(p);
+				}
+			}
+
+			cb[cy * cw + cx] = FrameIo_clip(((sb / n + 128) >> 8) + 128);
+			cr[cy * cw + cx] = FrameIo_clip(((sr / n + 128) >> 8) + 128);
+		}
+	}
+}
+
+static void FrameIo_to_rgb(const FrameIoLayout* layout, const u8* src, u8* rgb, u32 stride) {
+	const u32 w  = layout->width;
+	const u32 h  = layout->height;
+	const u32 cw = (w + (1 << layout->cx_shift) - 1) >> layout->cx_shift;
+	const u32 ch = (h + (1 << layout->cy_shift) - 1) >> layout->cy_shift;
+
+	if(layout->chroma == FRAME_IO_RGB24) {
+		for(u32 y = 0; y < h; y++)
+			memcpy(rgb + y * stride, src + y * 3 * w, 3 * w);
+
+		return;
+	}
+
+	const u8* cb   = src + w * h;
+	const u8* cr   = cb + cw * ch;
+	const bool mono = layout->chroma == FRAME_IO_GRAY;
+
+	for(u32 y = 0; y < h; y++) {
+		const u8* py = src + y * w;
+		const u32 co = (y >> layout->cy_shift) * cw;
+		u8*       p  = rgb + y * stride;
+
+		for(u32 x = 0; x < w; x++, p += 3) {
+			const int c = 298 * (py[x] - 16);
+			const int d = mono ? 0 : cb[co + (x >> layout->cx_shift)] - 128;
+			const int e = mono ? 0 : cr[co + (x >> layout->cx_shift)] - 128;
+
+			p[0] = FrameIo_clip((c + 409 * e + 128) >> 8);
+			p[1] = FrameIo_clip((c - 100 * d - 208 * e + 128) >> 8);
+			p[2] = FrameIo_clip((c + 516 * d + 128) >> 8);
+		}
+	}
+}
+
+
+// mmap-Fenster
+
+static void FrameIoMap_open(FrameIoMap* map, int fd, u32 write, u64 size, u32 frame) {
+	const u64 page    = sysconf(_SC_PAGESIZE);
+	const u64 overlap = (frame + page - 1) / page * page;
+
+	map->fd    = fd;
+	map->write = write;
+	map->step  = FRAME_IO_WINDOW > overlap ? FRAME_IO_WINDOW : overlap;
+	map->len   = map->step + overlap;
+	map->size  = size;
+
+	for(u32 i = 0; i < 2; i++) {
+		map->map[i]    = NULL;
+		map->index[i]  = 0;
+		map->mapped[i] = 0;
+	}
+}
+
+// Fenster k in map[k & 1], vorheriges Fenster dieses Platzes freigeben
+static bool FrameIoMap_window(FrameIoMap* map, u64 k) {
+	const u32 slot = k & 1;
+	const u64 off  = k * map->step;
+	u64       len  = map->len;
+
+	if(map->map[slot] && map->index[slot] == k)
+		return true;
+
+	if(map->map[slot])
+		munmap(map->map[slot], map->mapped[slot]);
+
+	map->map[slot] = NULL;
+
+	if(map->write) {
+		if(off + len > map->size) {
+			if(ftruncate(map->fd, off + len))
+				return false;
+
+			map->size = off + len;
+		}
+	} else {
+		if(off >= map->size)
+			return false;
+
+		if(len > map->size - off)
+			len = map->size - off;
+	}
+
+	void* p = mmap(NULL, len, map->write ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, map->fd, off);
+
+	if(p == MAP_FAILED)
+		return false;
+
+	if(!map->write) {
+		madvise(p, len, MADV_SEQUENTIAL);
+		madvise(p, len, MADV_WILLNEED);
+	}
+
+	map->map[slot]    = p;
+	map->index[slot]  = k;
+	map->mapped[slot] = len;
+
+	return true;
+}
+
+// Zeiger auf Dateiposition pos, avail: bis Fensterende; naechstes Fenster vorab
+static u8* FrameIoMap_get(FrameIoMap* map, u64 pos, u64* avail) {
+	const u64 k = pos / map->step;
+
+	if(!FrameIoMap_window(map, k))
+		return NULL;
+
+	if(map->write || (k + 1) * map->step < map->size)
+		FrameIoMap_window(map, k + 1);
+
+	const u32 slot = k & 1;
+
+	*avail = map->mapped[slot] - (pos - k * map->step);
+
+	return map->map[slot] + (pos - k * map->step);
+}
+
+static void FrameIoMap_close(FrameIoMap* map) {
+	for(u32 i = 0; i < 2; i++)
+		if(map->map[i])
+			munmap(map->map[i], map->mapped[i]);
+
+	if(map->fd >= 0)
+		close(map->fd);
+
+	map->fd = -1;
+}
+
+
+// Y4M-Kopf "YUV4MPEG2 W.. H.. [F..:..] [C..] ...\n", Rueckgabe: Laenge oder 0
+static u32 FrameIo_y4m_header(int fd, u32* width, u32* height, u32* rate_num, u32* rate_den,
+ FrameIoFormat* chroma) {
+	char          buf[FRAME_IO_Y4M_HEADER + 1];
+	const ssize_t n = pread(fd, buf, FRAME_IO_Y4M_HEADER, 0);
+
+	if(n < 10 || memcmp(buf, "YUV4MPEG2 ", 10))
+		return 0;
+
+	buf[n] = 0;
+
+	char* end = strchr(buf, '\n');
+
+	if(!end)
+		return 0;
+
+	*end    = 0;
+	*chroma = FRAME_IO_YUV420P;
+
+	for(char* tok = strtok(buf + 10, " "); tok; tok = strtok(NULL, " ")) {
+		switch(tok[0]) {
+		case 'W': *width  = atoi(tok + 1); break;
+		case 'H': *height = atoi(tok + 1); break;
+		case 'F': sscanf(tok + 1, "%u:%u", rate_num, rate_den); break;
+		case 'C':
+			if(!strcmp(tok + 1, "420") || !strcmp(tok + 1, "420jpeg") ||
+			 !strcmp(tok + 1, "420mpeg2") || !strcmp(tok + 1, "420paldv"))
+				*chroma = FRAME_IO_YUV420P;
+			else if(!strcmp(tok + 1, "422"))
+				*chroma = FRAME_IO_YUV422P;
+			else if(!strcmp(tok + 1, "444"))
+				*chroma = FRAME_IO_YUV444P;
+			else if(!strcmp(tok + 1, "mono"))
+				*chroma = FRAME_IO_GRAY;
+			else
+				return 0; // Tiefe > 8 Bit, Alpha
+			break;
+		}
+	}
+
+	return end - buf + 1;
+}
+
+
+int FrameReader_open(FrameReader* reader, const char* path, FrameIoFormat format,
+ u32 width, u32 height, u32 stride) {
+	FrameIoFormat chroma   = format;
+	u32           rate_num = 0, rate_den = 1;
+	struct stat   st;
+
+	memset(reader, 0, sizeof(*reader));
+	reader->map.fd = -1;
+
+	const int fd = open(path, O_RDONLY);
+
+	if(fd < 0 || fstat(fd, &st)) {
+		perror(path);
+
+		if(fd >= 0)
+			close(fd);
+
+		return -1;
+	}
+
+	if(format == FRAME_IO_Y4M) {
+		width  = 0;
+		height = 0;
+		reader->pos = FrameIo_y4m_header(fd, &width, &height, &rate_num, &rate_den, &chroma);
+
+		if(!reader->pos || !width || !height) {
+			fprintf(stderr, "%s: no 8 bit YUV4MPEG2 stream\n", path);
+			close(fd);
+
+			return -1;
+		}
+	}
+
+	if(!stride)
+		stride = 3 * width;
+
+	if(!width || !height || stride < 3 * width) {
+		fprintf(stderr, "%s: invalid frame size %ux%u (stride %u)\n", path, width, height, stride);
+		close(fd);
+
+		return -1;
+	}
+
+	FrameIo_layout(&reader->layout, format, chroma, width, height);
+	reader->layout.rate_num = rate_num;
+	reader->layout.rate_den = rate_den;
+	reader->stride          = stride;
+
+	// RGB24 ohne Zeilenabstand: direkt aus dem Fenster
+	if(format != FRAME_IO_RGB24 || stride != 3 * width)
+		reader->rgb = calloc((size_t)stride * height, 1);
+
+	FrameIoMap_open(&reader->map, fd, 0, st.st_size,
+		reader->layout.frame_bytes + (format == FRAME_IO_Y4M ? FRAME_IO_Y4M_FRAME_HEADER : 0));
+
+	return 0;
+}
+
+// Nutzdaten des naechsten Bildes im Fenster oder NULL
+static const u8* FrameReader_data(FrameReader* reader) {
+	u64       avail;
+	u32       header = 0;
+	const u8* p      = FrameIoMap_get(&reader->map, reader->pos, &avail);
+
+	if(!p)
+		return NULL;
+
+	if(reader->layout.format == FRAME_IO_Y4M) {
+		const u8* end = avail >= 5 && !memcmp(p, "FRAME", 5) ?
+			memchr(p, '\n', avail < FRAME_IO_Y4M_FRAME_HEADER ? avail : FRAME_IO_Y4M_FRAME_HEADER) : NULL;
+
+		if(!end)
+			return NULL;
+
+		header = end - p + 1;
+	}
+
+	// unvollstaendiges letztes Bild
+	if(avail < header + reader->layout.frame_bytes)
+		return NULL;
+
+	reader->pos += header + reader->layout.frame_bytes;
+	reader->frames++;
+
+	return p + header;
+}
+
+const u8* FrameReader_next(FrameReader* reader) {
+	const u8* p = FrameReader_data(reader);
+
+	if(!p || !reader->rgb)
+		return p;
+
+	FrameIo_to_rgb(&reader->layout, p, reader->rgb, reader->stride);
+
+	return reader->rgb;
+}
+
+int FrameReader_read(FrameReader* reader, u8* rgb) {
+	const u8* p = FrameReader_data(reader);
+
+	if(!p)
+		return -1;
+
+	FrameIo_to_rgb(&reader->layout, p, rgb, reader->stride);
+
+	return 0;
+}
+
+void FrameReader_close(FrameReader* reader) {
+	FrameIoMap_close(&reader->map);
+
+	free(reader->rgb);
+	reader->rgb = NULL;
+}
+
+
+int FrameWriter_open(FrameWriter* writer, const char* path, FrameIoFormat format,
+ FrameIoFormat chroma, u32 width, u32 height, u32 stride, u32 rate_num, u32 rate_den) {
+	static const char* const tags[] = {
+		[FRAME_IO_YUV420P] = "420jpeg", [FRAME_IO_YUV422P] = "422",
+		[FRAME_IO_YUV444P] = "444",     [FRAME_IO_GRAY]    = "mono" };
+
+	memset(writer, 0, sizeof(*writer));
+	writer->map.fd = -1;
+
+	if(format != FRAME_IO_Y4M)
+		chroma = format;
+	else if(chroma < FRAME_IO_YUV420P)
+		chroma = FRAME_IO_YUV444P;
+
+	if(!width || !height || stride < 3 * width) {
+		fprintf(stderr, "%s: invalid frame size %ux%u (stride %u)\n", path, width, height, stride);
+
+		return -1;
+	}
+
+	const int fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+
+	if(fd < 0) {
+		perror(path);
+
+		return -1;
+	}
+
+	FrameIo_layout(&writer->layout, format, chroma, width, height);
+	writer->layout.rate_num = rate_num ? rate_num : 30;
+	writer->layout.rate_den = rate_num ? rate_den : 1;
+	writer->stride          = stride;
+
+	if(format == FRAME_IO_Y4M) {
+		char      header[FRAME_IO_Y4M_HEADER];
+		const int n = snprintf(header, sizeof(header), "YUV4MPEG2 W%u H%u F%u:%u Ip A1:1 C%s\n",
+			width, height, writer->layout.rate_num, writer->layout.rate_den, tags[chroma]);
+
+		if(pwrite(fd, header, n, 0) != n) {
+			perror(path);
+			close(fd);
+
+			return -1;
+		}
+
+		writer->pos = n;
+	}
+
+	if(format != FRAME_IO_RGB24 || stride != 3 * width)
+		writer->rgb = calloc((size_t)stride * height, 1);
+
+	FrameIoMap_open(&writer->map, fd, 1, writer->pos,
+		writer->layout.frame_bytes + (format == FRAME_IO_Y4M ? FRAME_IO_Y4M_FRAME_HEADER : 0));
+
+	return 0;
+}
+
+u8* FrameWriter_frame(FrameWriter* writer) {
+	u64 avail;
+	u8* p;
+
+	if(writer->rgb)
+		return writer->frame = writer->rgb;
+
+	// RGB24 ohne Zeilenabstand: direkt ins Fenster
+	if(!(p = FrameIoMap_get(&writer->map, writer->pos, &avail)))
+		return writer->frame = NULL;
+
+	return writer->frame = p;
+}
+
+int FrameWriter_write(FrameWriter* writer, const u8* rgb) {
+	static const char frame_header[] = "FRAME\n";
+
+	const u32 header = writer->layout.format == FRAME_IO_Y4M ? sizeof(frame_header) - 1 : 0;
+	u64       avail;
+	u8*       p      = FrameIoMap_get(&writer->map, writer->pos, &avail);
+
+	if(!p)
+		return -1;
+
+	memcpy(p, frame_header, header);
+
+	// RGB24 ohne Zeilenabstand: bereits im Fenster (FrameWriter_frame)
+	if(rgb != p)
+		FrameIo_from_rgb(&writer->layout, rgb, writer->stride, p + header);
+
+	writer->pos += header + writer->layout.frame_bytes;
+	writer->frames++;
+
+	return 0;
+}
+
+int FrameWriter_commit(FrameWriter* writer) {
+	u8* frame = writer->frame;
+
+	writer->frame = NULL;
+
+	return frame ? FrameWriter_write(writer, frame) : -1;
+}
+
+void FrameWriter_close(FrameWriter* writer) {
+	if(writer->map.fd >= 0 && ftruncate(writer->map.fd, writer->pos))
+		perror("FrameWriter_close");
+
+	FrameIoMap_close(&writer->map);
+
+	free(writer->rgb);
+	writer->rgb = NULL;
+}
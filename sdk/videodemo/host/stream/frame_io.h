@@ -0,0 +1,122 @@
+/******************************************************************************
+ * frame_io.h: Streaming video file readers and writers (Y4M, raw) for HMod
+ ******************************************************************************
+ * Frames are exchanged as RGB24 with a caller-given stride, i.e. in the
+ * framebuffer layout NexysVideoHDMIHMod works on. Y4M (C444, C422, C420*,
+ * Cmono) and raw planar YCbCr are converted (BT.601, limited range); raw
+ * RGB24 with stride = 3 * width is handed out in place.
+ *
+ * Files are accessed through two mmap windows of FRAME_IO_WINDOW bytes
+ * (double buffering): while frames are taken from the current window, the
+ * next one is already mapped and prefetched (reader) or mapped with the file
+ * extended to it (writer). Windows overlap by one frame, so each frame is contiguous in
+ * one of them; a window left behind is unmapped, so only about two windows
+ * of a file are ever resident.
+ ******************************************************************************/
+
+
+#ifndef FRAME_IO_H
+#define FRAME_IO_H
+
+
+#include "xil_types.h"
+
+
+#define FRAME_IO_WINDOW (64u << 20)
+
+// Y4M: Kopfzeile "FRAME[ Parameter]\n" je Bild, hoechstens so lang
+#define FRAME_IO_Y4M_FRAME_HEADER 256
+
+
+typedef enum {
+	FRAME_IO_Y4M = 0,
+	FRAME_IO_RGB24,
+	FRAME_IO_YUV420P,
+	FRAME_IO_YUV422P,
+	FRAME_IO_YUV444P,
+	FRAME_IO_GRAY
+} FrameIoFormat;
+
+typedef struct {
+	FrameIoFormat format;
+	FrameIoFormat chroma; // Pixelformat: FRAME_IO_RGB24, FRAME_IO_YUV*, FRAME_IO_GRAY
+	u32 width;
+	u32 height;
+	u32 cx_shift;    // Chroma-Unterabtastung, log2
+	u32 cy_shift;
+	u32 frame_bytes; // Nutzdaten je Bild (ohne Y4M-Kopfzeile)
+	u32 rate_num;
+	u32 rate_den;
+} FrameIoLayout;
+
+// zwei Fenster k = index[i] ueber [k * step, k * step + len)
+typedef struct {
+	int fd;
+	u32 write;
+	u64 step;
+	u64 len;
+	u64 size;     // Dateigroesse (Writer: angelegt)
+	u8* map[2];
+	u64 index[2];
+	u64 mapped[2];
+} FrameIoMap;
+
+typedef struct {
+	FrameIoLayout layout;
+	FrameIoMap    map;
+	u64 pos;      // Dateiposition des naechsten Bildes
+	u32 frames;   // gelesene Bilder
+	u32 stride;
+	u8* rgb;      // Konvertierung, NULL: RGB24 direkt aus dem Fenster
+} FrameReader;
+
+typedef struct {
+	FrameIoLayout layout;
+	FrameIoMap    map;
+	u64 pos;
+	u32 frames;   // geschriebene Bilder
+	u32 stride;
+	u8* rgb;
+	u8* frame;    // von FrameWriter_frame ausgegebener Puffer
+} FrameWriter;
+
+
+// Format aus Dateiendung (.y4m, .rgb, .yuv, .gray), sonst FRAME_IO_Y4M
+FrameIoFormat FrameIo_format(const char* name, FrameIoFormat fallback);
+
+// Name (y4m, rgb24, yuv420p, yuv422p, yuv444p, gray), -1 falls unbekannt
+int FrameIo_parse_format(const char* name);
+
+
+// Y4M: width, height, Rate aus der Datei; raw: width x height angeben;
+// stride >= 3 * width, 0: 3 * width; Rueckgabe 0 oder -1 (Meldung auf stderr)
+int  FrameReader_open(FrameReader* reader, const char* path, FrameIoFormat format,
+ u32 width, u32 height, u32 stride);
+
+// naechstes Bild als RGB24, NULL am Dateiende; gueltig bis zum naechsten Aufruf
+const u8* FrameReader_next(FrameReader* reader);
+
+// naechstes Bild nach rgb (stride wie bei FrameReader_open), -1 am Dateiende
+int  FrameReader_read(FrameReader* reader, u8* rgb);
+
+void FrameReader_close(FrameReader* reader);
+
+
+// Y4M: Farbformat C444 (FRAME_IO_YUV444P, Standard), C422, C420jpeg oder mono
+// per chroma; raw: chroma ignoriert
+int  FrameWriter_open(FrameWriter* writer, const char* path, FrameIoFormat format,
+ FrameIoFormat chroma, u32 width, u32 height, u32 stride, u32 rate_num, u32 rate_den);
+
+// Puffer RGB24 (stride) fuer das naechste Bild, danach FrameWriter_commit;
+// unveraendert gelassene Pixel sind schwarz bzw. aus dem vorherigen Bild
+u8*  FrameWriter_frame(FrameWriter* writer);
+int  FrameWriter_commit(FrameWriter* writer);
+
+// Bild aus rgb (stride wie bei FrameWriter_open) anhaengen
+int  FrameWriter_write(FrameWriter* writer, const u8* rgb);
+
+// Datei auf die geschriebenen Bilder kuerzen
+void FrameWriter_close(FrameWriter* writer);
+
+
+#endif
@@ -0,0 +1,372 @@
+/******************************************************************************
+ * hmod_stream.c: Stream video files through NexysVideoHDMIHMod
+ ******************************************************************************
+ * Usage: hmod_stream [options] input [output]
+ *   -i format   input format  (y4m, rgb24, yuv420p, yuv422p, yuv444p, gray;
+ *               default from the file extension, else y4m)
+ *   -o format   output format (as -i)
+ *   -c format   Y4M output chroma (yuv444p (default), yuv422p, yuv420p, gray)
+ *   -s WxH      frame size of raw input
+ *   -r num:den  frame rate of Y4M output (default: input, else 30:1)
+ *   -m mode     hex:   sq2hex, hex pixels scattered (mode_d = 0)
+ *               sq:    sq2hex + hex2sq (mode_d = 1, default)
+ *               fused: sq2hex + hex2sq as one mapping (mode_d = 2)
+ *   -n order    Hexarray order (default 5)
+ *   -k scale    (default 1)
+ *   -R radius   (default 1)
+ *   -t mode_i   interpolation (default 0)
+ *   -f frames   stop after this many frames
+ *   -p slots    staged pipeline with this many frame slots, one thread per
+ *               stage (stream/pipeline.h); 0: serial (default)
+ *   -P file     HMod stage timings (HMOD_PROF, serial only, not with -p)
+ *               to file, .json: JSON, otherwise CSV
+ *   -G ms       quality governor with this target time per frame (HMod
+ *               only, serial only, not with -p), deadline: frame period of
+ *               -r (else 30:1); levels from -n, -t, -R down to order 3
+ *   -d          incremental (mode_d = 0, 1, serial only, not with -m fused
+ *               or -p): resample only hex pixels whose source tiles changed,
+ *               render only their surroundings; the dirty ratio is reported
+ *               at the end
+ *   -x filter   hex filter between sq2hex and hex2sq (mode_d = 0, 1, serial
+ *               only, not with -d): none, gauss, gauss49, laplace, sobel
+ *
+ * Frames are processed one at a time in the framebuffer layout of the live
+ * path (RGB24, same resolution in and out), reading and writing through
+ * frame_io's mmap windows, so files of any length stream in constant memory.
+ * Without output only reading and HMod are timed. At the end the time per
+ * frame, frames/s and MB/s of each stage (read + conversion, HMod, conversion
+ * + write) are reported. Raw RGB24 is read and written in place, its page
+ * faults are then counted to HMod. Governor events (misses, level switches)
+ * are printed as they happen.
+ ******************************************************************************/
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <unistd.h>
+
+#include "CHIPCore.h"
+#include "Nexys-Video-HDMIHMod.h"
+
+#include "frame_io.h"
+#include "pipeline.h"
+#include "hmod_timer.h"
+#include "prof_export.h"
+
+
+typedef struct {
+	const char* name;
+	u64         ticks;
+	u64         bytes;
+} StreamStage;
+
+
+static void usage(const char* prog) {
+	fprintf(stderr, "usage: %s [-i format] [-o format] [-c chroma] [-s WxH] [-r num:den]\n"
+		"       [-m hex|sq|fused] [-n order] [-k scale] [-R radius] [-t mode_i] [-f frames]\n"
+		"       [-p slots] [-P file] [-G ms] [-d] [-x filter]\n"
+		"       input [output]\n", prog);
+
+	exit(EXIT_FAILURE);
+}
+
+static FrameIoFormat parse_format(const char* prog, const char* name) {
+	const int format = FrameIo_parse_format(name);
+
+	if(format < 0) {
+		fprintf(stderr, "%s: unknown format %s\n", prog, name);
+		usage(prog);
+	}
+
+	return format;
+}
+
+static void report_gov(const HModGovernor* gov, u32* printed) {
+	for(; *printed < gov->logged; (*printed)++) {
+		const HModGovLog* log = &gov->log[*printed % HMOD_GOV_LOG];
+
+		printf("frame %5u: %-4s level %u -> %u, %.3f ms\n", log->frame,
+			NexysVideoHDMIHMod_gov_events[log->event], log->from, log->to, HModTimer_to_ns(log->cost) * 1e-6);
+	}
+}
+
+static void report(const StreamStage* stage, u32 frames) {
+	const double s = HModTimer_to_ns(stage->ticks) * 1e-9;
+
+	printf("%-6s %9.3f ms %9.1f frames/s %9.1f MB/s\n", stage->name,
+		frames ? 1e3 * s / frames : 0.0,
+		s > 0 ? frames / s : 0.0,
+		s > 0 ? stage->bytes / s * 1e-6 : 0.0);
+}
+
+
+int main(int argc, char** argv) {
+	int           format_in  = -1;
+	int           format_out = -1;
+	FrameIoFormat chroma     = FRAME_IO_YUV444P;
+	u32           width      = 0;
+	u32           height     = 0;
+	u32           rate_num   = 0;
+	u32           rate_den   = 1;
+	u32           mode_d     = 1;
+	u32           order      = 5;
+	float         scale      = 1.0f;
+	float         radius     = 1.0f;
+	u32           mode_i     = 0;
+	u32           limit      = 0;
+	u32           slots      = 0;
+	const char*   prof       = NULL;
+	double        gov_ms     = 0;
+	bool          delta      = false;
+	u32           filter     = HMOD_CONV_NONE;
+	int           opt;
+
+	FrameReader reader;
+	FrameWriter writer;
+	u8*         dest = NULL;
+
+	HModGovernor gov;
+	u32          gov_printed = 0;
+
+	StreamStage st_read  = { .name = "read" };
+	StreamStage st_hmod  = { .name = "hmod" };
+	StreamStage st_write = { .name = "write" };
+	StreamStage st_total = { .name = "total" };
+
+
+	while((opt = getopt(argc, argv, "i:o:c:s:r:m:n:k:R:t:f:p:P:G:dx:")) != -1) {
+		switch(opt) {
+		case 'i': format_in  = parse_format(argv[0], optarg); break;
+		case 'o': format_out = parse_format(argv[0], optarg); break;
+		case 'c': chroma     = parse_format(argv[0], optarg); break;
+		case 's':
+			if(sscanf(optarg, "%ux%u", &width, &height) != 2)
+				usage(argv[0]);
+			break;
+		case 'r':
+			if(sscanf(optarg, "%u:%u", &rate_num, &rate_den) != 2 || !rate_num || !rate_den)
+				usage(argv[0]);
+			break;
+		case 'm':
+			if(!strcmp(optarg, "hex"))        mode_d = 0;
+			else if(!strcmp(optarg, "sq"))    mode_d = 1;
+			else if(!strcmp(optarg, "fused")) mode_d = 2;
+			else usage(argv[0]);
+			break;
+		case 'n': order  = atoi(optarg); break;
+		case 'k': scale  = atof(optarg); break;
+		case 'R': radius = atof(optarg); break;
+		case 't': mode_i = atoi(optarg); break;
+		case 'f': limit  = atoi(optarg); break;
+		case 'p': slots  = atoi(optarg); break;
+		case 'P': prof   = optarg;       break;
+		case 'G': gov_ms = atof(optarg); break;
+		case 'd': delta  = true;         break;
+		case 'x':
+			for(filter = 0; filter < HMOD_CONV_FILTERS; filter++)
+				if(!strcmp(optarg, NexysVideoHDMIHMod_filters[filter]))
+					break;
+
+			if(filter == HMOD_CONV_FILTERS)
+				usage(argv[0]);
+			break;
+		default:  usage(argv[0]);
+		}
+	}
+
+	if(optind >= argc || argc - optind > 2)
+		usage(argv[0]);
+
+	// Stufenzeiten (HMOD_PROF) bzw. Kosten fuer den Regler nur im seriellen
+	// Pfad gemessen
+	if((prof || gov_ms > 0) && slots)
+		usage(argv[0]);
+
+	// inkrementell nur im seriellen Pfad mit Hex-Bild
+	if(delta && (mode_d == 2 || slots))
+		usage(argv[0]);
+
+	// Hex-Filter nur zwischen sq2hex und hex2sq im seriellen Pfad
+	if(filter != HMOD_CONV_NONE && (mode_d == 2 || slots || delta))
+		usage(argv[0]);
+
+	const char* in  = argv[optind];
+	const char* out = optind + 1 < argc ? argv[optind + 1] : NULL;
+
+	if(format_in < 0)
+		format_in = FrameIo_format(in, FRAME_IO_Y4M);
+
+	if(out && format_out < 0)
+		format_out = FrameIo_format(out, FRAME_IO_Y4M);
+
+	// Y4M: Groesse aus dem Dateikopf
+	if(FrameReader_open(&reader, in, format_in, width, height, 0))
+		return EXIT_FAILURE;
+
+	width  = reader.layout.width;
+	height = reader.layout.height;
+
+	const u32 stride = reader.stride;
+
+	if(!rate_num && reader.layout.rate_num) {
+		rate_num = reader.layout.rate_num;
+		rate_den = reader.layout.rate_den;
+	}
+
+	if(out) {
+		if(FrameWriter_open(&writer, out, format_out, chroma, width, height, stride, rate_num, rate_den))
+			return EXIT_FAILURE;
+	} else if(!slots) {
+		dest = calloc((size_t)stride * height, 1);
+	}
+
+
+	HModTimer_init();
+
+	u64 t = HModTimer_ticks();
+
+	NexysVideoHDMIHMod_init(width, height, order, scale, radius);
+
+	printf("\n\n%ux%u, order = %u, mode_d = %u, mode_i = %u, init %.1f ms\n",
+		width, height, order, mode_d, mode_i, HModTimer_to_ns(HModTimer_ticks() - t) * 1e-6);
+
+	if(slots) {
+		HModPipeline pipeline;
+		u32          frames = 0;
+		bool         failed = true;
+
+		if(!HModPipeline_init(&pipeline, &reader, out ? &writer : NULL, slots,
+		 order, scale, radius, mode_i, mode_d, limit)) {
+			frames = HModPipeline_run(&pipeline);
+			failed = atomic_load(&pipeline.failed);
+			HModPipeline_report(&pipeline);
+		} else {
+			fprintf(stderr, "%s: out of memory for %u slots\n", argv[0], slots);
+		}
+
+		HModPipeline_free(&pipeline);
+		FrameReader_close(&reader);
+
+		if(out)
+			FrameWriter_close(&writer);
+
+		NexysVideoHDMIHMod_free();
+
+		return frames && !failed ? EXIT_SUCCESS : EXIT_FAILURE;
+	}
+
+	NexysVideoHDMIHMod_prof_init();
+	NexysVideoHDMIHMod_delta_init(delta);
+	NexysVideoHDMIHMod_conv_init(filter);
+
+	if(gov_ms > 0) {
+		HModLevel levels[HMOD_GOV_LEVELS];
+
+		const u32 n      = NexysVideoHDMIHMod_gov_ladder(levels, order, mode_i, radius);
+		const u64 target = gov_ms * 1e-3 * HModTimer_freq();
+		const u64 budget = HModTimer_freq() * (rate_num ? rate_den : 1) / (rate_num ? rate_num : 30);
+
+		NexysVideoHDMIHMod_gov_init(&gov, levels, n, stride, width, height, scale, mode_d, target, budget);
+
+		printf("\n\ngovernor: %u levels, target %.3f ms, deadline %.3f ms\n", n,
+			HModTimer_to_ns(target) * 1e-6, HModTimer_to_ns(budget) * 1e-6);
+	}
+
+	const u64 t_start = HModTimer_ticks();
+	u32       frames  = 0;
+
+	while(!limit || frames < limit) {
+		t = HModTimer_ticks();
+
+		const u8* src = FrameReader_next(&reader);
+
+		if(!src)
+			break;
+
+		const u64 t_read = HModTimer_ticks();
+
+		st_read.ticks += t_read - t;
+
+		if(out && !(dest = FrameWriter_frame(&writer)))
+			break;
+
+		const u64 t_frame = HModTimer_ticks();
+
+		HMOD_PROF_BEGIN();
+
+		// srcFrame wird nur gelesen (ggf. direkt aus dem Fenster)
+		NexysVideoHDMIHMod((u8*)src, dest, stride, width, height,
+			order, scale, radius, mode_i, mode_d);
+
+		HMOD_PROF_END();
+
+		const u64 t_hmod = HModTimer_ticks();
+
+		st_hmod.ticks += t_hmod - t_frame;
+
+		// naechstes Bild mit der neuen Stufe
+		if(gov_ms > 0) {
+			if(NexysVideoHDMIHMod_gov_frame(&gov, t_hmod - t_frame)) {
+				order  = gov.level[gov.cur].order;
+				mode_i = gov.level[gov.cur].mode_i;
+				radius = gov.level[gov.cur].radius;
+			}
+
+			report_gov(&gov, &gov_printed);
+		}
+
+		if(out && FrameWriter_commit(&writer))
+			break;
+
+		st_write.ticks += HModTimer_ticks() - t_hmod + t_frame - t_read;
+
+		frames++;
+	}
+
+	st_total.ticks = HModTimer_ticks() - t_start;
+	st_read.bytes  = (u64)frames * reader.layout.frame_bytes;
+	st_hmod.bytes  = (u64)frames * stride * height;
+	st_write.bytes = out ? (u64)frames * writer.layout.frame_bytes : 0;
+	st_total.bytes = st_read.bytes + st_write.bytes;
+
+	printf("%u frames\n", frames);
+
+	report(&st_read, frames);
+	report(&st_hmod, frames);
+
+	if(out)
+		report(&st_write, frames);
+
+	report(&st_total, frames);
+
+	// Anteile ueber alle Bilder
+	if(delta && hmod_delta.frames) {
+		printf("delta: %.2f %% hex pixels resampled, %.2f %% changed, %.2f %% output rendered\n",
+			100.0 * hmod_delta.sampled / hmod_delta.hex, 100.0 * hmod_delta.changes / hmod_delta.hex,
+			hmod_delta.pixels ? 100.0 * hmod_delta.rendered / hmod_delta.pixels : 0.0);
+	}
+
+	if(gov_ms > 0) {
+		printf("governor: level %u/%u (order %u, mode_i %u, radius %.2f), %u misses, %u switches\n",
+			gov.cur, gov.n - 1, order, mode_i, radius, gov.misses, gov.switches);
+
+		NexysVideoHDMIHMod_gov_stop(&gov);
+	}
+
+	if(prof)
+		ProfExport_write(prof);
+
+
+	FrameReader_close(&reader);
+
+	if(out)
+		FrameWriter_close(&writer);
+	else
+		free(dest);
+
+	NexysVideoHDMIHMod_free();
+
+	return frames ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,272 @@
+/******************************************************************************
+ * pipeline.c: Staged HMod pipeline for hmod_stream (one thread per stage)
+ ******************************************************************************/
+
+
+#define _GNU_SOURCE
+
+#include <sched.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "Nexys-Video-HDMIHMod.h"
+
+#include "hmod_timer.h"
+#include "pipeline.h"
+
+
+// Warten: zuerst abgeben, danach schlafen (auch mit weniger Kernen als Stufen)
+#define HMOD_PIPELINE_YIELDS   64
+#define HMOD_PIPELINE_SLEEP_NS 20000
+
+
+static void HModPipeline_backoff(u32* n) {
+	if(*n < HMOD_PIPELINE_YIELDS) {
+		(*n)++;
+		sched_yield();
+	} else {
+		const struct timespec ts = { 0, HMOD_PIPELINE_SLEEP_NS };
+
+		nanosleep(&ts, NULL);
+	}
+}
+
+// HMOD_PIPELINE_END auch, sobald failed gesetzt ist
+static u32 HModPipeline_pop(HModPipeline* p, SpscQueue* q) {
+	u32 item;
+	u32 n = 0;
+
+	while(!SpscQueue_pop(q, &item)) {
+		if(atomic_load_explicit(&p->failed, memory_order_acquire))
+			return HMOD_PIPELINE_END;
+
+		HModPipeline_backoff(&n);
+	}
+
+	return item;
+}
+
+static void HModPipeline_push(SpscQueue* q, u32 item) {
+	u32 n = 0;
+
+	while(!SpscQueue_push(q, item))
+		HModPipeline_backoff(&n);
+}
+
+
+// Stufen
+
+static bool HModPipeline_read(HModPipeline* p, HModPipelineSlot* slot) {
+	if(p->limit && p->read >= p->limit)
+		return false;
+
+	if(FrameReader_read(p->reader, slot->src))
+		return false;
+
+	p->read++;
+
+	return true;
+}
+
+static bool HModPipeline_sq2hex(HModPipeline* p, HModPipelineSlot* slot) {
+	NexysVideoHDMIHMod_sq2hex(slot->src, &slot->hex, p->stride, p->width, p->height,
+		p->order, p->scale, p->mode_i);
+
+	return true;
+}
+
+static bool HModPipeline_hex2sq(HModPipeline* p, HModPipelineSlot* slot) {
+	NexysVideoHDMIHMod_hex2sq(slot->hex, slot->dest, p->stride, p->width, p->height,
+		p->scale, p->radius, p->mode_i, p->mode_d);
+
+	return true;
+}
+
+static bool HModPipeline_sq2sq(HModPipeline* p, HModPipelineSlot* slot) {
+	NexysVideoHDMIHMod(slot->src, slot->dest, p->stride, p->width, p->height,
+		p->order, p->scale, p->radius, p->mode_i, p->mode_d);
+
+	return true;
+}
+
+static bool HModPipeline_write(HModPipeline* p, HModPipelineSlot* slot) {
+	return !FrameWriter_write(p->writer, slot->dest);
+}
+
+
+typedef struct {
+	HModPipeline*      pipeline;
+	HModPipelineStage* stage;
+} HModPipelineThread;
+
+static void* HModPipeline_thread(void* arg) {
+	HModPipeline*      p = ((HModPipelineThread*)arg)->pipeline;
+	HModPipelineStage* s = ((HModPipelineThread*)arg)->stage;
+
+	for(;;) {
+		const u64 t0   = HModTimer_ticks();
+		const u32 slot = HModPipeline_pop(p, s->in);
+		const u64 t1   = HModTimer_ticks();
+
+		s->wait_ticks += t1 - t0;
+
+		if(slot == HMOD_PIPELINE_END) {
+			// Ende weiterreichen, die letzte Stufe gibt nichts mehr frei
+			if(!s->last && !atomic_load_explicit(&p->failed, memory_order_acquire))
+				HModPipeline_push(s->out, HMOD_PIPELINE_END);
+
+			break;
+		}
+
+		if(!s->run(p, &p->slots[slot])) {
+			// read: Dateiende bzw. limit, sonst Fehler; read wartet sonst
+			// auf Slots, die nicht mehr zurueckkommen
+			if(s == &p->stage[0])
+				HModPipeline_push(s->out, HMOD_PIPELINE_END);
+			else
+				atomic_store_explicit(&p->failed, true, memory_order_release);
+
+			break;
+		}
+
+		s->busy_ticks += HModTimer_ticks() - t1;
+		s->frames++;
+
+		HModPipeline_push(s->out, slot);
+	}
+
+	return NULL;
+}
+
+
+static void HModPipeline_stage(HModPipeline* p, const char* name,
+ bool (*run)(HModPipeline*, HModPipelineSlot*)) {
+	HModPipelineStage* s = &p->stage[p->num_stages++];
+
+	memset(s, 0, sizeof(*s));
+
+	s->name = name;
+	s->run  = run;
+}
+
+int HModPipeline_init(HModPipeline* p, FrameReader* reader, FrameWriter* writer,
+ u32 num_slots, u32 order, float scale, float radius, u32 mode_i, u32 mode_d, u32 limit) {
+	const size_t bytes = (size_t)reader->stride * reader->layout.height;
+
+	memset(p, 0, sizeof(*p));
+	atomic_init(&p->failed, false);
+
+	p->reader    = reader;
+	p->writer    = writer;
+	p->width     = reader->layout.width;
+	p->height    = reader->layout.height;
+	p->stride    = reader->stride;
+	p->order     = order;
+	p->scale     = scale;
+	p->radius    = radius;
+	p->mode_i    = mode_i;
+	p->mode_d    = mode_d;
+	p->limit     = limit;
+	p->num_slots = num_slots < HMOD_PIPELINE_MIN_SLOTS ? HMOD_PIPELINE_MIN_SLOTS : num_slots;
+
+	HModPipeline_stage(p, "read", HModPipeline_read);
+
+	if(mode_d == 2) {
+		HModPipeline_stage(p, "sq2sq", HModPipeline_sq2sq);
+	} else {
+		HModPipeline_stage(p, "sq2hex", HModPipeline_sq2hex);
+		HModPipeline_stage(p, mode_d ? "hex2sq" : "blit", HModPipeline_hex2sq);
+	}
+
+	if(writer)
+		HModPipeline_stage(p, "write", HModPipeline_write);
+
+	// Queue k vor Stufe k, Platz fuer alle Slots und das Endezeichen
+	for(u32 k = 0; k < p->num_stages; k++) {
+		if(!SpscQueue_init(&p->queue[k], p->num_slots + 1))
+			return -1;
+
+		p->stage[k].in   = &p->queue[k];
+		p->stage[k].out  = &p->queue[(k + 1) % p->num_stages];
+		p->stage[k].last = k == p->num_stages - 1;
+	}
+
+	// einmalig, danach keine Allokation je Bild
+	if(!(p->slots = (HModPipelineSlot*)calloc(p->num_slots, sizeof(HModPipelineSlot))))
+		return -1;
+
+	for(u32 i = 0; i < p->num_slots; i++) {
+		HModPipelineSlot* slot = &p->slots[i];
+
+		slot->src  = (u8*)calloc(bytes, 1);
+		slot->dest = (u8*)calloc(bytes, 1);
+
+		if(!slot->src || !slot->dest)
+			return -1;
+
+		if(mode_d != 2)
+			Hexarray_init(&slot->hex, order);
+
+		SpscQueue_push(&p->queue[0], i);
+	}
+
+	return 0;
+}
+
+u32 HModPipeline_run(HModPipeline* p) {
+	HModPipelineThread args[HMOD_PIPELINE_MAX_STAGES];
+	const u64          t = HModTimer_ticks();
+
+	for(u32 k = 0; k < p->num_stages; k++) {
+		args[k].pipeline = p;
+		args[k].stage    = &p->stage[k];
+
+		pthread_create(&p->stage[k].thread, NULL, HModPipeline_thread, &args[k]);
+	}
+
+	for(u32 k = 0; k < p->num_stages; k++)
+		pthread_join(p->stage[k].thread, NULL);
+
+	p->wall_ticks = HModTimer_ticks() - t;
+
+	return p->stage[p->num_stages - 1].frames;
+}
+
+void HModPipeline_report(const HModPipeline* p) {
+	const double wall   = HModTimer_to_ns(p->wall_ticks) * 1e-9;
+	const u32    frames = p->stage[p->num_stages - 1].frames;
+
+	printf("%u frames, %u slots, %.1f frames/s\n", frames, p->num_slots, wall > 0 ? frames / wall : 0.0);
+	printf("stage   ms/frame   busy   wait   queue (mean/max)\n");
+
+	for(u32 k = 0; k < p->num_stages; k++) {
+		const HModPipelineStage* s = &p->stage[k];
+		const SpscQueue*         q = s->in;
+
+		printf("%-6s %9.3f %5.1f%% %5.1f%%   %5.2f / %u%s\n", s->name,
+			s->frames ? HModTimer_to_ns(s->busy_ticks) * 1e-6 / s->frames : 0.0,
+			p->wall_ticks ? 100.0 * s->busy_ticks / p->wall_ticks : 0.0,
+			p->wall_ticks ? 100.0 * s->wait_ticks / p->wall_ticks : 0.0,
+			q->pops ? (double)q->occupancy_sum / q->pops : 0.0, q->occupancy_max,
+			k ? "" : " free slots");
+	}
+}
+
+void HModPipeline_free(HModPipeline* p) {
+	if(p->slots) {
+		for(u32 i = 0; i < p->num_slots; i++) {
+			free(p->slots[i].src);
+			free(p->slots[i].dest);
+
+			if(p->slots[i].hex.p)
+				Hexarray_free(&p->slots[i].hex);
+		}
+
+		free(p->slots);
+		p->slots = NULL;
+	}
+
+	for(u32 k = 0; k < p->num_stages; k++)
+		SpscQueue_free(&p->queue[k]);
+}
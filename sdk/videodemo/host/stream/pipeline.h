@@ -0,0 +1,105 @@
+/******************************************************************************
+ * pipeline.h: Staged HMod pipeline for hmod_stream (one thread per stage)
+ ******************************************************************************
+ * Stages: read (FrameReader) -> sq2hex -> hex2sq or blit (mode_d = 1, 0)
+ * -> write (FrameWriter); mode_d = 2 has a single sq2sq stage instead of
+ * sq2hex and hex2sq, without writer the last stage is HMod.
+ *
+ * num_slots frame slots (source frame, Hexarray, output frame) are allocated
+ * once and circulate through SPSC queues: queue k feeds stage k, the last
+ * stage hands its slots back to queue 0 (free slots). The queues can hold
+ * all slots, so pushing never blocks; backpressure comes from the slot pool:
+ * once all slots are in flight, read waits for the slowest stage.
+ *
+ * If a stage after read fails (e.g. a write error), it sets failed; all
+ * stages then stop at their next pop instead of waiting for slots that never
+ * come back.
+ *
+ * Reported per stage: busy time per frame and utilization (busy / wall),
+ * time waiting for input (for read: blocked on free slots); per queue: mean
+ * and maximum occupancy.
+ ******************************************************************************/
+
+
+#ifndef PIPELINE_H
+#define PIPELINE_H
+
+
+#include <pthread.h>
+
+#include "CHIPCore.h"
+
+#include "frame_io.h"
+#include "spsc.h"
+
+
+#define HMOD_PIPELINE_MAX_STAGES 4
+#define HMOD_PIPELINE_MIN_SLOTS  2
+
+// Ende des Stroms, von Stufe zu Stufe weitergereicht
+#define HMOD_PIPELINE_END 0xFFFFFFFFu
+
+
+typedef struct {
+	u8*      src;
+	Hexarray hex;  // nicht bei mode_d = 2
+	u8*      dest;
+} HModPipelineSlot;
+
+typedef struct HModPipeline HModPipeline;
+
+typedef struct {
+	const char* name;
+	bool      (*run)(HModPipeline* pipeline, HModPipelineSlot* slot); // false: Ende
+	SpscQueue*  in;
+	SpscQueue*  out;
+	u32         last;
+
+	pthread_t thread;
+	u64       busy_ticks; // HModTimer_ticks
+	u64       wait_ticks;
+	u32       frames;
+} HModPipelineStage;
+
+struct HModPipeline {
+	FrameReader* reader;
+	FrameWriter* writer; // NULL: ohne Ausgabe
+
+	u32   width;
+	u32   height;
+	u32   stride;
+	u32   order;
+	float scale;
+	float radius;
+	u32   mode_i;
+	u32   mode_d;
+	u32   limit;  // 0: bis Dateiende
+	u32   read;   // von der Stufe read geholte Bilder
+
+	_Atomic bool failed; // eine Stufe nach read ist fehlgeschlagen: alle beenden
+
+	u32               num_slots;
+	HModPipelineSlot* slots;
+
+	u32               num_stages;
+	HModPipelineStage stage[HMOD_PIPELINE_MAX_STAGES];
+	SpscQueue         queue[HMOD_PIPELINE_MAX_STAGES];
+
+	u64 wall_ticks;
+};
+
+
+// NexysVideoHDMIHMod_init bereits aufgerufen; Rueckgabe 0 oder -1
+int  HModPipeline_init(HModPipeline* pipeline, FrameReader* reader, FrameWriter* writer,
+ u32 num_slots, u32 order, float scale, float radius, u32 mode_i, u32 mode_d, u32 limit);
+
+// alle Stufen bis zum Ende des Stroms bzw. bis zum ersten Fehler (failed),
+// Rueckgabe: geschriebene Bilder
+u32  HModPipeline_run(HModPipeline* pipeline);
+
+void HModPipeline_report(const HModPipeline* pipeline);
+
+void HModPipeline_free(HModPipeline* pipeline);
+
+
+#endif
@@ -0,0 +1,98 @@
+/******************************************************************************
+ * spsc.h: Lock-free single-producer single-consumer ring of slot indices
+ ******************************************************************************
+ * One thread pushes, one thread pops; head and tail are only written by
+ * their owner and live on separate cache lines. The capacity is a power of
+ * two fixed at init, nothing is allocated afterwards. The consumer samples
+ * the fill level on every pop (occupancy statistics).
+ ******************************************************************************/
+
+
+#ifndef SPSC_H
+#define SPSC_H
+
+
+#include <stdalign.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+#include "xil_types.h"
+
+
+#define SPSC_LINE 64
+
+
+typedef struct {
+	alignas(SPSC_LINE) _Atomic u32 tail; // Produzent
+	alignas(SPSC_LINE) _Atomic u32 head; // Konsument
+
+	alignas(SPSC_LINE) u32* items;
+	u32 mask;
+
+	// Fuellstand vor jedem pop (Konsument)
+	u64 occupancy_sum;
+	u32 occupancy_max;
+	u32 pops;
+} SpscQueue;
+
+
+// capacity wird auf eine Zweierpotenz aufgerundet
+static inline bool SpscQueue_init(SpscQueue* q, u32 capacity) {
+	u32 n = 1;
+
+	while(n < capacity)
+		n <<= 1;
+
+	atomic_init(&q->tail, 0);
+	atomic_init(&q->head, 0);
+
+	q->items         = (u32*)malloc(n * sizeof(u32));
+	q->mask          = n - 1;
+	q->occupancy_sum = 0;
+	q->occupancy_max = 0;
+	q->pops          = 0;
+
+	return q->items != NULL;
+}
+
+static inline void SpscQueue_free(SpscQueue* q) {
+	free(q->items);
+	q->items = NULL;
+}
+
+static inline bool SpscQueue_push(SpscQueue* q, u32 item) {
+	const u32 tail = atomic_load_explicit(&q->tail, memory_order_relaxed);
+	const u32 head = atomic_load_explicit(&q->head, memory_order_acquire);
+
+	if(tail - head > q->mask)
+		return false;
+
+	q->items[tail & q->mask] = item;
+	atomic_store_explicit(&q->tail, tail + 1, memory_order_release);
+
+	return true;
+}
+
+static inline bool SpscQueue_pop(SpscQueue* q, u32* item) {
+	const u32 head = atomic_load_explicit(&q->head, memory_order_relaxed);
+	const u32 tail = atomic_load_explicit(&q->tail, memory_order_acquire);
+	const u32 n    = tail - head;
+
+	if(!n)
+		return false;
+
+	*item = q->items[head & q->mask];
+	atomic_store_explicit(&q->head, head + 1, memory_order_release);
+
+	q->occupancy_sum += n;
+	q->pops++;
+
+	if(n > q->occupancy_max)
+		q->occupancy_max = n;
+
+	return true;
+}
+
+
+#endif
@@ -28,6 +28,7 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include <math.h>
 
@@ -37,21 +38,31 @@
 
 
 float*   pc_reals     = NULL;
+int16_t* pc_reals_q   = NULL;
 iPoint2d pc_reals_min = { .x = 0, .y = 0 };
 iPoint2d pc_reals_max = { .x = 0, .y = 0 };
 
-float*   pc_spatials     = NULL;
+int16_t* pc_spatials     = NULL;
 iPoint2d pc_spatials_min = { .x = 0, .y = 0 };
 iPoint2d pc_spatials_max = { .x = 0, .y = 0 };
 
-unsigned int** pc_nearest = NULL;
+unsigned int* pc_lattice      = NULL;
+iPoint2d      pc_lattice_min  = { .x = 0, .y = 0 };
+uPoint2d      pc_lattice_dims = { .x = 0, .y = 0 };
 
-unsigned int** pc_adds = NULL;
+unsigned int*  pc_order          = NULL;
+unsigned int   pc_order_interior = 0;
+uPoint2d       pc_order_dims     = { .x = 0, .y = 0 };
+float          pc_order_scale    = 0.0f;
+
+Hexbank pc_banks_sq2hex[HEXSAMP_BANKS];
+Hexbank pc_banks_hex2sq[HEXSAMP_BANKS];
 
 
 void pArray2d_init(pArray2d* array, unsigned int x, unsigned int y) {
-	array->x = x;
-	array->y = y;
+	array->x      = x;
+	array->y      = y;
+	array->stride = 3 * x;
 
 	array->p = (u8*)calloc(3 * x * y, sizeof(u8));
 }
@@ -617,139 +628,1735 @@ float kernel(float x, float y, unsigned int technique) {
 	return f.x * f.y;
 }
 
+
+// Gitter: a = x - y / sqrt(3), b = 2 * y / sqrt(3), gerundet ueber die
+// dritte Koordinate c = -a - b (naechster Mittelpunkt im Sechseck)
+iPoint2d Hexsamp_lattice(float x, float y) {
+	const float sqrt3 = sqrtf(3.0f);
+	const float a     = x - y / sqrt3;
+	const float b     = 2 * y / sqrt3;
+	const float c     = -a - b;
+	      float ra    = roundf(a);
+	      float rb    = roundf(b);
+	const float rc    = roundf(c);
+	const float da    = fabsf(ra - a);
+	const float db    = fabsf(rb - b);
+	const float dc    = fabsf(rc - c);
+
+	if(da > db && da > dc) {
+		ra = -rb - rc;
+	} else if(db > dc) {
+		rb = -ra - rc;
+	}
+
+	const iPoint2d l = { .x = (int)ra, .y = (int)rb };
+
+	return l;
+}
+
+void Hexsamp_lattice_dims(iPoint2d reals_min, iPoint2d reals_max,
+ iPoint2d* min, uPoint2d* dims) {
+	const float sqrt3 = sqrtf(3.0f);
+	const int   pad   = 2 * PC_LATTICE_PAD;
+
+	// Ecken des Rechtecks
+	min->x  = (int)floorf(reals_min.x - reals_max.y / sqrt3) - pad;
+	min->y  = (int)floorf(2 * reals_min.y / sqrt3)           - pad;
+	dims->x = (int)ceilf(reals_max.x - reals_min.y / sqrt3)  + pad + 1 - min->x;
+	dims->y = (int)ceilf(2 * reals_max.y / sqrt3)            + pad + 1 - min->y;
+}
+
+unsigned int Hexsamp_lattice_index(fPoint2d p, iPoint2d min, uPoint2d dims) {
+	const iPoint2d l = Hexsamp_lattice(p.x, p.y);
+
+	return (l.x - min.x) * dims.y + l.y - min.y;
+}
+
+typedef struct { int band; int col; int row; unsigned int i; } Hexsamp_key;
+
+static int Hexsamp_key_cmp(const void* a, const void* b) {
+	const Hexsamp_key* ka = (const Hexsamp_key*)a;
+	const Hexsamp_key* kb = (const Hexsamp_key*)b;
+
+	if(ka->band != kb->band) return ka->band < kb->band ? -1 : 1;
+	if(ka->col  != kb->col)  return ka->col  < kb->col  ? -1 : 1;
+	if(ka->row  != kb->row)  return ka->row  < kb->row  ? -1 : 1;
+
+	return 0;
+}
+
+// Verarbeitungsreihenfolge: Baender zu je band Quellzeilen, darin spaltenweise
+void Hexsamp_sq2hex_order(unsigned int size, float scale, unsigned int band) {
+	const float  scale_q = scale / (1 << PC_REALS_Q);
+	Hexsamp_key* keys    = (Hexsamp_key*)malloc(size * sizeof(Hexsamp_key));
+
+	if(!band)
+		band = 1;
+
+	for(unsigned int i = 0; i < size; i++) {
+		keys[i].row  = (int)roundf(-scale_q * pc_reals_q[2 * i + 1]);
+		keys[i].col  = (int)roundf( scale_q * pc_reals_q[2 * i]);
+		keys[i].band = (int)floorf((float)keys[i].row / band);
+		keys[i].i    = i;
+	}
+
+	qsort(keys, size, sizeof(Hexsamp_key), Hexsamp_key_cmp);
+
+	free(pc_order);
+	pc_order = (unsigned int*)malloc(size * sizeof(unsigned int));
+
+	for(unsigned int j = 0; j < size; j++)
+		pc_order[j] = keys[j].i;
+
+	// Hexsamp_sq2hex_split ungueltig
+	pc_order_interior = 0;
+	pc_order_dims.x   = pc_order_dims.y = 0;
+	pc_order_scale    = 0.0f;
+
+	free(keys);
+}
+
+// Interior (alle 9 Stuetzstellen im Bild) zuerst, danach Rand; Reihenfolge
+// aus pc_order (falls vorhanden) bleibt innerhalb beider Teile erhalten
+void Hexsamp_sq2hex_split(unsigned int size, unsigned int x, unsigned int y,
+ float scale) {
+	const fPoint2d      cart_a  = { .x = x / 2.0f, .y = y / 2.0f };
+	const float         scale_q = scale / (1 << PC_REALS_Q);
+	      unsigned int* split   = (unsigned int*)malloc(size * sizeof(unsigned int));
+	      unsigned int  border  = size;
+
+	pc_order_interior = 0;
+
+	for(unsigned int j = 0; j < size; j++) {
+		const unsigned int i   = pc_order ? pc_order[j] : j;
+		const int          row = (int)roundf(cart_a.y - scale_q * pc_reals_q[2 * i + 1]);
+		const int          col = (int)roundf(cart_a.x + scale_q * pc_reals_q[2 * i]);
+
+		if(col >= 1 && col + 1 < (int)x && row >= 1 && row + 1 < (int)y) {
+			split[pc_order_interior++] = i;
+		} else {
+			split[--border] = i;
+		}
+	}
+
+	// Rand: umgekehrt eingetragen
+	for(unsigned int a = border, b = size - 1; a < b; a++, b--) {
+		const unsigned int t = split[a];
+
+		split[a] = split[b];
+		split[b] = t;
+	}
+
+	free(pc_order);
+	pc_order = split;
+
+	pc_order_dims.x = x;
+	pc_order_dims.y = y;
+	pc_order_scale  = scale;
+}
+
+static inline float Hexsamp_sq2hex_weight(float xh, float yh, unsigned int technique) {
+	float k = kernel(xh, yh, technique);
+
+
+	// Patch Transformation: Flcheninhalt
+	if((xh > 0.5f && xh < 1.0f) || (yh > 0.5f && yh < 1.0f)) {
+		float factor = 1.0f;
+
+		if(xh > 0.5f)
+			factor *= (1.5f - xh);
+
+		if(yh > 0.5f)
+			factor *= (1.5f - yh);
+
+		k *= factor;
+	}
+
+	return k;
+}
+
+// Polyphasen-Gewichte
+
+// Phase (je Achse) der Lage d, phases / 2 Phasen je Vorzeichen
+static inline unsigned int Hexsamp_phase(float d, unsigned int phases) {
+	const int p = (int)floorf(d * (1 << HEXSAMP_PHASE_BITS)) + (int)phases / 2;
+
+	return p < 0 ? 0 : p < (int)phases ? (unsigned int)p : phases - 1;
+}
+
+// Lage der Mitte von Phase p
+static inline float Hexsamp_phase_center(unsigned int p, unsigned int phases) {
+	return ((int)p - (int)phases / 2 + 0.5f) / (1 << HEXSAMP_PHASE_BITS);
+}
+
+// Nachbarn j < 7 bzw. 49 (add(Mitte, Hexint_init(j, 0))): Ort relativ zur
+// Mitte und Gitterversatz
+static unsigned int Hexsamp_neighbours(fPoint2d* real, iPoint2d* nb, float radius) {
+	const unsigned int nb_n = radius > 1.0f ? 49 : 7; // TODO?
+
+	for(unsigned int j = 0; j < nb_n; j++) {
+		real[j] = getReal(Hexint_init(j, 0));
+		nb[j]   = Hexsamp_lattice(real[j].x, real[j].y);
+	}
+
+	return nb_n;
+}
+
+static void Hexsamp_bank_free(Hexbank* bank) {
+	free(bank->n);
+	free(bank->taps);
+	free(bank->norm);
+
+	bank->n      = NULL;
+	bank->taps   = NULL;
+	bank->norm   = NULL;
+	bank->phases = 0;
+}
+
+void Hexsamp_banks_free() {
+	for(unsigned int b = 0; b < HEXSAMP_BANKS; b++) {
+		Hexsamp_bank_free(&pc_banks_sq2hex[b]);
+		Hexsamp_bank_free(&pc_banks_hex2sq[b]);
+	}
+}
+
+static void Hexsamp_bank_alloc(Hexbank* bank, unsigned int phases, unsigned int taps_max) {
+	bank->phases   = phases;
+	bank->taps_max = taps_max;
+	bank->n        = (u8*)    calloc(phases * phases, sizeof(u8));
+	bank->taps     = (Hextap*)malloc(phases * phases * taps_max * sizeof(Hextap));
+	bank->norm     = (float*) malloc(phases * phases * sizeof(float));
+}
+
+// taps_max auf die groesste Anzahl je Phase verkleinern
+static void Hexsamp_bank_compact(Hexbank* bank) {
+	const unsigned int size = bank->phases * bank->phases;
+	      unsigned int max  = 1;
+
+	for(unsigned int f = 0; f < size; f++) {
+		if(bank->n[f] > max)
+			max = bank->n[f];
+	}
+
+	for(unsigned int f = 1; f < size; f++)
+		memmove(bank->taps + f * max, bank->taps + f * bank->taps_max, bank->n[f] * sizeof(Hextap));
+
+	bank->taps     = (Hextap*)realloc(bank->taps, size * max * sizeof(Hextap));
+	bank->taps_max = max;
+}
+
+// |Phase| <= 1/2; Patch Transformation: Reichweite (77 -> 33 = 49 -> 9)
+static void Hexsamp_bank_sq2hex(Hexbank* bank) {
+	const unsigned int phases = 1 << HEXSAMP_PHASE_BITS;
+
+	Hexsamp_bank_alloc(bank, phases, 9);
+
+	for(unsigned int px = 0; px < phases; px++) {
+		for(unsigned int py = 0; py < phases; py++) {
+			const unsigned int f     = px * phases + py;
+			const fPoint2d     d     = { .x = Hexsamp_phase_center(px, phases),
+			                             .y = Hexsamp_phase_center(py, phases) };
+			      Hextap*      t     = bank->taps + f * bank->taps_max;
+			      float        out_n = 0.0f;
+
+			for(int x = -1; x < 2; x++) {
+				for(int y = -1; y < 2; y++) {
+					const float k = Hexsamp_sq2hex_weight(fabs(d.x - x), fabs(d.y - y), bank->technique);
+
+					if(k != 0.0f) {
+						t[bank->n[f]].p   = 3 * (x + 1) + y + 1;
+						t[bank->n[f]++].w = k;
+						out_n            += k;
+					}
+				}
+			}
+
+			// Patch Transformation: Normalisierung
+			bank->norm[f] = out_n > 0.0f ? 1 / out_n : 1.0f;
+		}
+	}
+
+	Hexsamp_bank_compact(bank);
+}
+
+// |Phase| <= 1/sqrt(3) (Abstand zum naechsten Hex-Pixel)
+static void Hexsamp_bank_hex2sq(Hexbank* bank) {
+	const unsigned int phases = 2 * (unsigned int)ceilf((1 << HEXSAMP_PHASE_BITS) / sqrtf(3.0f));
+	      fPoint2d     real[49];
+
+	bank->nb_n = Hexsamp_neighbours(real, bank->nb, bank->radius);
+
+	Hexsamp_bank_alloc(bank, phases, bank->nb_n);
+
+	for(unsigned int px = 0; px < phases; px++) {
+		for(unsigned int py = 0; py < phases; py++) {
+			const unsigned int f = px * phases + py;
+			const fPoint2d     d = { .x = Hexsamp_phase_center(px, phases),
+			                         .y = Hexsamp_phase_center(py, phases) };
+			      Hextap*      t = bank->taps + f * bank->taps_max;
+
+			for(unsigned int j = 0; j < bank->nb_n; j++) {
+				const fPoint2d dh = { .x = d.x - real[j].x, .y = d.y - real[j].y };
+
+				if(fabs(dh.x) <= bank->radius && fabs(dh.y) <= bank->radius) {
+					const float k = kernel(dh.x, dh.y, bank->technique);
+
+					if(k != 0.0f) {
+						t[bank->n[f]].p   = j;
+						t[bank->n[f]++].w = k;
+					}
+				}
+			}
+
+			bank->norm[f] = 1.0f;
+		}
+	}
+
+	Hexsamp_bank_compact(bank);
+}
+
+// Bank fuer (radius, technique), sonst anstelle der am laengsten nicht
+// verwendeten neu berechnet; je Resampler nur aus einem Thread
+static const Hexbank* Hexsamp_bank(Hexbank* banks, float radius, unsigned int technique,
+ void (*init)(Hexbank*)) {
+	Hexbank*     victim = banks;
+	unsigned int used   = 0;
+
+	for(unsigned int b = 0; b < HEXSAMP_BANKS; b++) {
+		if(banks[b].used > used)
+			used = banks[b].used;
+	}
+
+	for(unsigned int b = 0; b < HEXSAMP_BANKS; b++) {
+		if(banks[b].phases && banks[b].radius == radius && banks[b].technique == technique) {
+			if(banks[b].used != used)
+				banks[b].used = used + 1;
+
+			return &banks[b];
+		}
+
+		if(banks[b].used < victim->used)
+			victim = &banks[b];
+	}
+
+	Hexsamp_bank_free(victim);
+
+	victim->radius    = radius;
+	victim->technique = technique;
+	victim->used      = used + 1;
+
+	init(victim);
+
+	return victim;
+}
+
+
+// off: Quelloffset je Tap (Hextap.p) relativ zu (row, col)
+static inline void Hexsamp_sq2hex_pixel(pArray2d array, u8* hp, const Hexbank* bank,
+ const int* off, float row_hex, float col_hex, bool checked) {
+	// int: Zentren knapp ausserhalb (-1) behalten ihre Taps im Bild
+	const int           row    = (int)roundf(row_hex);
+	const int           col    = (int)roundf(col_hex);
+	const unsigned int  f      = Hexsamp_phase(col_hex - col, bank->phases) * bank->phases +
+	                             Hexsamp_phase(row_hex - row, bank->phases);
+	const Hextap*       t      = bank->taps + f * bank->taps_max;
+	const u8*           base   = array.p + row * (int)array.stride + 3 * col;
+	      float         out[3] = { 0.0f, 0.0f, 0.0f };
+	      float         out_n  =   0.0f;
+
+	for(unsigned int k = 0; k < bank->n[f]; k++) {
+		const int x = col + (int)t[k].p / 3 - 1;
+		const int y = row + (int)t[k].p % 3 - 1;
+
+		if(!checked || (x >= 0 && x < array.x && y >= 0 && y < array.y)) {
+			const u8* p = base + off[t[k].p];
+
+			out[0] += t[k].w * p[0];
+			out[1] += t[k].w * p[1];
+			out[2] += t[k].w * p[2];
+			out_n  += t[k].w;
+		}
+	}
+
+	// Patch Transformation: Normalisierung (im Bild: alle Taps, aus der Bank)
+	if(!checked) {
+		hp[0] = (int)roundf(out[0] * bank->norm[f]);
+		hp[1] = (int)roundf(out[1] * bank->norm[f]);
+		hp[2] = (int)roundf(out[2] * bank->norm[f]);
+	} else if(out_n > 0.0f) {
+		hp[0] = (int)roundf(out[0] / out_n);
+		hp[1] = (int)roundf(out[1] / out_n);
+		hp[2] = (int)roundf(out[2] / out_n);
+	} else {
+		hp[0] = (int)roundf(out[0]);
+		hp[1] = (int)roundf(out[1]);
+		hp[2] = (int)roundf(out[2]);
+	}
+}
+
+// Interior aus Hexsamp_sq2hex_split nur fuer dessen Aufloesung und scale
+static inline unsigned int Hexsamp_sq2hex_interior(pArray2d array, float scale) {
+	return pc_order && array.x == pc_order_dims.x && array.y == pc_order_dims.y &&
+		scale == pc_order_scale ? pc_order_interior : 0;
+}
+
+// Quelloffset je Tap (Hextap.p)
+static inline void Hexsamp_sq2hex_offsets(int* off, unsigned int stride) {
+	for(int p = 0; p < 9; p++)
+		off[p] = (p % 3 - 1) * (int)stride + 3 * (p / 3 - 1);
+}
+
 void Hexsamp_sq2hex(pArray2d array, Hexarray* hexarray,
  unsigned int order, float scale, unsigned int technique) {
-	const fPoint2d cart_a = { .x = array.x / 2.0f, .y = array.y / 2.0f };
+	const fPoint2d     cart_a   = { .x = array.x / 2.0f, .y = array.y / 2.0f };
+	const float        scale_q  = scale / (1 << PC_REALS_Q); // Q10.5 -> float
+	const unsigned int interior = Hexsamp_sq2hex_interior(array, scale);
+	const Hexbank*     bank     = Hexsamp_bank(pc_banks_sq2hex, 0.0f, technique, Hexsamp_bank_sq2hex);
+	      int          off[9];
 
 	// Hexarray_init(hexarray, order);
 
-	for(unsigned int i = 0; i < hexarray->size; i++) {
-		const unsigned int row      = (unsigned int)roundf(cart_a.y - scale * pc_reals[2 * i + 1]);
-		const unsigned int col      = (unsigned int)roundf(cart_a.x + scale * pc_reals[2 * i]);
-		const float        row_hex  =                      cart_a.y - scale * pc_reals[2 * i + 1];
-		const float        col_hex  =                      cart_a.x + scale * pc_reals[2 * i];
-		      float        out[3]   = { 0.0f, 0.0f, 0.0f };
-		      float        out_n    =   0.0f;
-
-		// Patch Transformation: Reichweite (77 -> 33 = 49 -> 9)
-		// for(int x = col - 3; x < col + 4; x++) {
-		for(int x = col - 1; x < col + 2; x++) {
-			// for(int y = row - 3; y < row + 4; y++) {
-			for(int y = row - 1; y < row + 2; y++) {
-				if(x >= 0 && x < array.x && y >= 0 && y < array.y) {
-					const float        xh = fabs(col_hex - x);
-					const float        yh = fabs(row_hex - y);
-					      float        k  = kernel(xh, yh, technique);
-					const unsigned int p  = 3 * (y * array.x + x);
+	Hexsamp_sq2hex_offsets(off, array.stride);
+
+	// pc_order: Quellbild zeilenweise, Ergebnis weiterhin an Spiraladresse i
+	for(unsigned int j = 0; j < interior; j++) {
+		const unsigned int i = pc_order[j];
+
+		Hexsamp_sq2hex_pixel(array, hexarray->p[i], bank, off,
+			cart_a.y - scale_q * pc_reals_q[2 * i + 1],
+			cart_a.x + scale_q * pc_reals_q[2 * i], false);
+	}
 
+	for(unsigned int j = interior; j < hexarray->size; j++) {
+		const unsigned int i = pc_order ? pc_order[j] : j;
 
-					// Patch Transformation: Flcheninhalt
-					if((xh > 0.5f && xh < 1.0f) || (yh > 0.5f && yh < 1.0f)) {
-						float factor = 1.0f;
+		Hexsamp_sq2hex_pixel(array, hexarray->p[i], bank, off,
+			cart_a.y - scale_q * pc_reals_q[2 * i + 1],
+			cart_a.x + scale_q * pc_reals_q[2 * i], true);
+	}
+}
 
-						if(xh > 0.5f)
-							factor *= (1.5f - xh);
+// Inkrementell
 
-						if(yh > 0.5f)
-							factor *= (1.5f - yh);
+// Hash einer Kachel (bytes je Zeile): zwei Spuren zu je 32 Bit, FNV-1a je
+// Wort; jede Aenderung eines einzelnen Worts aendert den Hash
+static uint64_t Hexsamp_tile_hash(const u8* p, unsigned int stride,
+ unsigned int bytes, unsigned int rows) {
+	uint32_t h0 = 2166136261u;
+	uint32_t h1 = 2166136261u;
 
-						k *= factor;
-					}
+	for(unsigned int r = 0; r < rows; r++, p += stride) {
+		unsigned int b = 0;
+
+		for(; b + 8 <= bytes; b += 8) {
+			uint32_t w[2];
+
+			memcpy(w, p + b, sizeof(w));
+
+			h0 = (h0 ^ w[0]) * 16777619u;
+			h1 = (h1 ^ w[1]) * 16777619u;
+		}
+
+		for(; b < bytes; b++)
+			h0 = (h0 ^ p[b]) * 16777619u;
+	}
+
+	return (uint64_t)h1 << 32 | h0;
+}
+
+// Kacheln tile_min .. tile_max neu hashen, dirty: Hash geaendert;
+// Rueckgabe: Anzahl geaenderter Kacheln
+static unsigned int Hexsamp_delta_hash(pArray2d array, Hexdelta* delta) {
+	unsigned int n = 0;
+
+	for(int ty = delta->tile_min.y; ty <= delta->tile_max.y; ty++) {
+		const unsigned int y    = ty * HEXSAMP_TILE;
+		const unsigned int rows = y + HEXSAMP_TILE < array.y ? HEXSAMP_TILE : array.y - y;
+
+		for(int tx = delta->tile_min.x; tx <= delta->tile_max.x; tx++) {
+			const unsigned int x    = tx * HEXSAMP_TILE;
+			const unsigned int cols = x + HEXSAMP_TILE < array.x ? HEXSAMP_TILE : array.x - x;
+			const unsigned int t    = ty * delta->dims.x + tx;
+			const uint64_t     h    = Hexsamp_tile_hash(array.p + y * array.stride + 3 * x,
+				array.stride, 3 * cols, rows);
+
+			delta->dirty[t] = h != delta->hash[t];
+			delta->hash[t]  = h;
+			n              += delta->dirty[t];
+		}
+	}
+
+	return n;
+}
+
+// Kacheln der 3x3 Stuetzstellen um (row, col); false: ganz ausserhalb
+static inline bool Hexsamp_delta_tiles(uPoint2d res, int row, int col,
+ int* x0, int* y0, int* x1, int* y1) {
+	if(col + 1 < 0 || row + 1 < 0 || col - 1 >= (int)res.x || row - 1 >= (int)res.y)
+		return false;
+
+	*x0 = (col > 0 ? col - 1 : 0) / HEXSAMP_TILE;
+	*y0 = (row > 0 ? row - 1 : 0) / HEXSAMP_TILE;
+	*x1 = (col + 1 < (int)res.x ? col + 1 : (int)res.x - 1) / HEXSAMP_TILE;
+	*y1 = (row + 1 < (int)res.y ? row + 1 : (int)res.y - 1) / HEXSAMP_TILE;
+
+	return true;
+}
+
+void Hexsamp_delta_free(Hexdelta* delta) {
+	free(delta->hash);
+	free(delta->dirty);
+	free(delta->tile_rows);
+	free(delta->tile_hex);
+	free(delta->changed);
+	free(delta->out_dirty);
+
+	memset(delta, 0, sizeof(Hexdelta));
+}
+
+// neuer Bezug: Hex-Pixel je Kachel, von Hex-Pixeln gelesene Kacheln und
+// deren Hashes
+static void Hexsamp_delta_setup(pArray2d array, Hexarray* hexarray, Hexdelta* delta,
+ float scale, unsigned int technique) {
+	const fPoint2d     cart_a  = { .x = array.x / 2.0f, .y = array.y / 2.0f };
+	const float        scale_q = scale / (1 << PC_REALS_Q);
+	const unsigned int tiles   = ((array.x + HEXSAMP_TILE - 1) / HEXSAMP_TILE) *
+	                             ((array.y + HEXSAMP_TILE - 1) / HEXSAMP_TILE);
+
+	Hexsamp_delta_free(delta);
+
+	delta->hex        = hexarray->p;
+	delta->res.x      = array.x;
+	delta->res.y      = array.y;
+	delta->scale      = scale;
+	delta->technique  = technique;
+	delta->size       = hexarray->size;
+	delta->dims.x     = (array.x + HEXSAMP_TILE - 1) / HEXSAMP_TILE;
+	delta->dims.y     = (array.y + HEXSAMP_TILE - 1) / HEXSAMP_TILE;
+	delta->hash       = (uint64_t*)malloc(tiles * sizeof(uint64_t));
+	delta->dirty      = (u8*)calloc(tiles, sizeof(u8));
+	delta->tile_rows  = (unsigned int*)calloc(tiles + 1, sizeof(unsigned int));
+	delta->changed    = (u8*)malloc(hexarray->size * sizeof(u8));
+	delta->tile_min.x = delta->dims.x;
+	delta->tile_min.y = delta->dims.y;
+	delta->tile_max.x = delta->tile_max.y = -1;
+
+	// 1. Durchlauf: Anzahl je Kachel, 2.: Eintraege (je Kachel aufsteigend in j)
+	for(unsigned int pass = 0; pass < 2; pass++) {
+		for(unsigned int j = 0; j < hexarray->size; j++) {
+			const unsigned int i   = pc_order ? pc_order[j] : j;
+			const int          row = (int)roundf(cart_a.y - scale_q * pc_reals_q[2 * i + 1]);
+			const int          col = (int)roundf(cart_a.x + scale_q * pc_reals_q[2 * i]);
+			      int          x0, y0, x1, y1;
+
+			if(!Hexsamp_delta_tiles(delta->res, row, col, &x0, &y0, &x1, &y1))
+				continue;
 
+			for(int ty = y0; ty <= y1; ty++) {
+				for(int tx = x0; tx <= x1; tx++) {
+					const unsigned int t = ty * delta->dims.x + tx;
 
-					out[0] += k * array.p[p];
-					out[1] += k * array.p[p + 1];
-					out[2] += k * array.p[p + 2];
-					out_n  += k;
+					if(!pass)
+						delta->tile_rows[t + 1]++;
+					else
+						delta->tile_hex[delta->tile_rows[t]++] = j;
 				}
 			}
+
+			if(!pass) {
+				if(x0 < delta->tile_min.x) delta->tile_min.x = x0;
+				if(y0 < delta->tile_min.y) delta->tile_min.y = y0;
+				if(x1 > delta->tile_max.x) delta->tile_max.x = x1;
+				if(y1 > delta->tile_max.y) delta->tile_max.y = y1;
+			}
 		}
 
-		// Patch Transformation: Normalisierung
-		if(out_n > 0.0f) {
-			hexarray->p[i][0] = (int)roundf(out[0] / out_n);
-			hexarray->p[i][1] = (int)roundf(out[1] / out_n);
-			hexarray->p[i][2] = (int)roundf(out[2] / out_n);
+		// 1.: Beginn je Kachel, 2.: zurueck (tile_rows[t] zeigt auf Kachel t + 1)
+		if(!pass) {
+			for(unsigned int t = 0; t < tiles; t++)
+				delta->tile_rows[t + 1] += delta->tile_rows[t];
+
+			delta->tile_hex = (unsigned int*)malloc(delta->tile_rows[tiles] * sizeof(unsigned int));
 		} else {
-			hexarray->p[i][0] = (int)roundf(out[0]);
-			hexarray->p[i][1] = (int)roundf(out[1]);
-			hexarray->p[i][2] = (int)roundf(out[2]);
+			for(unsigned int t = tiles; t > 0; t--)
+				delta->tile_rows[t] = delta->tile_rows[t - 1];
+
+			delta->tile_rows[0] = 0;
 		}
 	}
+
+	Hexsamp_delta_hash(array, delta);
+
+	memset(delta->dirty, 0, tiles);
 }
 
-void Hexsamp_hex2sq(Hexarray hexarray, pArray2d* array,
- float radius, float scale, unsigned int technique) {
-	// array->x = (unsigned int)roundf((pc_reals_max.x - pc_reals_min.x) / scale) + 1;
-	// array->y = (unsigned int)roundf((pc_reals_max.y - pc_reals_min.y) / scale) + 1;
-	// pArray2d_init(array, array->x, array->y);
+void Hexsamp_sq2hex_delta(pArray2d array, Hexarray* hexarray, Hexdelta* delta,
+ float scale, unsigned int technique) {
+	if(delta->hex != hexarray->p || delta->size != hexarray->size || delta->res.x != array.x ||
+	   delta->res.y != array.y || delta->scale != scale || delta->technique != technique) {
+		Hexsamp_delta_setup(array, hexarray, delta, scale, technique);
+		Hexsamp_sq2hex(array, hexarray, 0, scale, technique);
 
+		memset(delta->changed, 1, hexarray->size);
 
-	fPoint2d cart_a = { .x = pc_reals_min.x, .y = pc_reals_min.y };
-	const unsigned int i_max = radius > 1.0f ? 49 : 7; // TODO?
+		delta->full    = true;
+		delta->sampled = delta->changes = hexarray->size;
 
-	for(unsigned int y = 0; y < array->y; y++) {
-		for(unsigned int x = 0; x < array->x; x++) {
-			float out[3] = { 0.0f, 0.0f, 0.0f };
-			float out_n  =   0.0f;
+		return;
+	}
 
+	delta->full    = false;
+	delta->sampled = delta->changes = 0;
 
-			for(unsigned int i = 0; i < i_max; i++) {
-				// const unsigned int hi = getInt(add(getNearest(cart_a.x, cart_a.y), Hexint_init(i, 0)));
-				const unsigned int hi = pc_adds[pc_nearest[x][y]][i];
-				// const unsigned int hi = pc_adds[x][y][i]; // schlechtere Lokalitt
+	memset(delta->changed, 0, hexarray->size);
 
-				if(hi < hexarray.size) {
-					const fPoint2d cart_ha = { .x = pc_reals[2 * hi],     \
-					                           .y = pc_reals[2 * hi + 1] };
+	if(!Hexsamp_delta_hash(array, delta))
+		return;
 
-					if(fabs(cart_a.x - cart_ha.x) <= radius &&
-					   fabs(cart_a.y - cart_ha.y) <= radius) {
-						const float k = kernel(cart_a.x - cart_ha.x, cart_a.y - cart_ha.y, technique);
+	const fPoint2d     cart_a   = { .x = array.x / 2.0f, .y = array.y / 2.0f };
+	const float        scale_q  = scale / (1 << PC_REALS_Q);
+	const unsigned int interior = Hexsamp_sq2hex_interior(array, scale);
+	const Hexbank*     bank     = Hexsamp_bank(pc_banks_sq2hex, 0.0f, technique, Hexsamp_bank_sq2hex);
+	      int          off[9];
 
-						out[0] += k * hexarray.p[hi][0];
-						out[1] += k * hexarray.p[hi][1];
-						out[2] += k * hexarray.p[hi][2];
-						out_n  += k;
-					}
+	Hexsamp_sq2hex_offsets(off, array.stride);
+
+	// nur Hex-Pixel geaenderter Kacheln, je Hex-Pixel einmal
+	for(int ty = delta->tile_min.y; ty <= delta->tile_max.y; ty++) {
+		for(int tx = delta->tile_min.x; tx <= delta->tile_max.x; tx++) {
+			const unsigned int t = ty * delta->dims.x + tx;
+
+			if(!delta->dirty[t])
+				continue;
+
+			for(unsigned int k = delta->tile_rows[t]; k < delta->tile_rows[t + 1]; k++) {
+				const unsigned int j  = delta->tile_hex[k];
+				const unsigned int i  = pc_order ? pc_order[j] : j;
+				      u8*          hp = hexarray->p[i];
+				      u8           out[3];
+
+				if(delta->changed[i])
+					continue;
+
+				Hexsamp_sq2hex_pixel(array, out, bank, off,
+					cart_a.y - scale_q * pc_reals_q[2 * i + 1],
+					cart_a.x + scale_q * pc_reals_q[2 * i], j >= interior);
+
+				delta->sampled++;
+
+				if(out[0] != hp[0] || out[1] != hp[1] || out[2] != hp[2]) {
+					hp[0] = out[0];
+					hp[1] = out[1];
+					hp[2] = out[2];
+
+					delta->changed[i] = 1;
+					delta->changes++;
+				} else {
+					delta->changed[i] = 2;
 				}
 			}
+		}
+	}
+}
 
+// Ausschnitt
 
-			const unsigned int p = 3 * ((array->y - y - 1) * array->x + x);
+// ext_*: Ausdehnung eines Aggregats der Stufe k <= 7 relativ zu seiner
+// Mitte (Reals)
+typedef struct {
+	fPoint2d cart_a;
+	float    scale_q;
+	fPoint2d ext_min[8];
+	fPoint2d ext_max[8];
+} Hexroi_walk;
 
-			// Patch Transformation: Normalisierung
-			if(out_n > 0.0f) {
-				out[0] = roundf(out[0] / out_n);
-				out[1] = roundf(out[1] / out_n);
-				out[2] = roundf(out[2] / out_n);
-			} else {
-				out[0] = roundf(out[0]);
-				out[1] = roundf(out[1]);
-				out[2] = roundf(out[2]);
-			}
+static void Hexroi_add(Hexroi* roi, unsigned int begin, unsigned int end, bool interior) {
+	Hexrange* last = roi->n ? &roi->ranges[roi->n - 1] : NULL;
 
-			if(out[0] < 255) {
-				array->p[p]     = (int)out[0];
-			} else {
-				array->p[p]     = 255;
-			}
-			if(out[1] < 255) {
-				array->p[p + 1] = (int)out[1];
-			} else {
-				array->p[p + 1] = 255;
-			}
-			if(out[2] < 255) {
-				array->p[p + 2] = (int)out[2];
-			} else {
-				array->p[p + 2] = 255;
-			}
+	roi->pixels += end - begin;
 
+	if(last && last->end == begin && last->interior == interior) {
+		last->end = end;
+		return;
+	}
 
-			cart_a.x += scale;
+	if(roi->n == roi->capacity) {
+		roi->capacity = roi->capacity ? 2 * roi->capacity : 64;
+		roi->ranges   = (Hexrange*)realloc(roi->ranges, roi->capacity * sizeof(Hexrange));
+	}
+
+	roi->ranges[roi->n].begin    = begin;
+	roi->ranges[roi->n].end      = end;
+	roi->ranges[roi->n].interior = interior;
+	roi->n++;
+}
+
+// Aggregat der Stufe k ab base; Grenzen der Abtastorte mit 1 Pixel Rand
+// (Rundung, pc_reals_q)
+static void Hexroi_aggregate(Hexroi* roi, const Hexroi_walk* w, unsigned int base, unsigned int k) {
+	const float scale = roi->scale;
+
+	roi->visited++;
+
+	if(!k) {
+		const int row = (int)roundf(w->cart_a.y - w->scale_q * pc_reals_q[2 * base + 1]);
+		const int col = (int)roundf(w->cart_a.x + w->scale_q * pc_reals_q[2 * base]);
+
+		if(col >= roi->min.x && col < roi->max.x && row >= roi->min.y && row < roi->max.y)
+			Hexroi_add(roi, base, base + 1,
+				col >= 1 && col + 1 < (int)roi->res.x && row >= 1 && row + 1 < (int)roi->res.y);
+
+		return;
+	}
+
+	const float col_lo = w->cart_a.x + scale * (pc_reals[2 * base]     + w->ext_min[k].x) - 1;
+	const float col_hi = w->cart_a.x + scale * (pc_reals[2 * base]     + w->ext_max[k].x) + 1;
+	const float row_lo = w->cart_a.y - scale * (pc_reals[2 * base + 1] + w->ext_max[k].y) - 1;
+	const float row_hi = w->cart_a.y - scale * (pc_reals[2 * base + 1] + w->ext_min[k].y) + 1;
+
+	if(col_hi < roi->min.x || col_lo >= roi->max.x || row_hi < roi->min.y || row_lo >= roi->max.y)
+		return;
+
+	if(col_lo >= roi->min.x && col_hi < roi->max.x && row_lo >= roi->min.y && row_hi < roi->max.y) {
+		Hexroi_add(roi, base, base + (unsigned int)pow(7, k),
+			col_lo >= 1 && col_hi + 1 < roi->res.x && row_lo >= 1 && row_hi + 1 < roi->res.y);
+
+		return;
+	}
+
+	const unsigned int child = (unsigned int)pow(7, k - 1);
+
+	for(unsigned int d = 0; d < 7; d++)
+		Hexroi_aggregate(roi, w, base + d * child, k - 1);
+}
+
+void Hexroi_init(Hexroi* roi, unsigned int order, uPoint2d res, float scale,
+ iPoint2d min, iPoint2d max) {
+	Hexroi_walk w = { .cart_a = { .x = res.x / 2.0f, .y = res.y / 2.0f },
+	                  .scale_q = scale / (1 << PC_REALS_Q) };
+
+	roi->size    = (unsigned int)pow(7, order);
+	roi->res     = res;
+	roi->scale   = scale;
+	roi->min     = min;
+	roi->max     = max;
+	roi->n       = 0;
+	roi->pixels  = 0;
+	roi->visited = 0;
+
+	// Stufe k: Teilaggregate d * 7^(k - 1) + Stufe k - 1
+	w.ext_min[0].x = w.ext_min[0].y = w.ext_max[0].x = w.ext_max[0].y = 0.0f;
+
+	for(unsigned int k = 1; k <= order; k++) {
+		const unsigned int child = (unsigned int)pow(7, k - 1);
+
+		w.ext_min[k] = w.ext_min[k - 1];
+		w.ext_max[k] = w.ext_max[k - 1];
+
+		for(unsigned int d = 1; d < 7; d++) {
+			const fPoint2d c = { .x = pc_reals[2 * d * child], .y = pc_reals[2 * d * child + 1] };
+
+			if(c.x + w.ext_min[k - 1].x < w.ext_min[k].x) w.ext_min[k].x = c.x + w.ext_min[k - 1].x;
+			if(c.y + w.ext_min[k - 1].y < w.ext_min[k].y) w.ext_min[k].y = c.y + w.ext_min[k - 1].y;
+			if(c.x + w.ext_max[k - 1].x > w.ext_max[k].x) w.ext_max[k].x = c.x + w.ext_max[k - 1].x;
+			if(c.y + w.ext_max[k - 1].y > w.ext_max[k].y) w.ext_max[k].y = c.y + w.ext_max[k - 1].y;
+		}
+	}
+
+	Hexroi_aggregate(roi, &w, 0, order);
+}
+
+void Hexroi_free(Hexroi* roi) {
+	free(roi->ranges);
+
+	roi->ranges   = NULL;
+	roi->n        = 0;
+	roi->capacity = 0;
+	roi->size     = 0;
+}
+
+void Hexsamp_sq2hex_roi(pArray2d array, Hexarray* hexarray, const Hexroi* roi,
+ unsigned int technique) {
+	const fPoint2d cart_a  = { .x = array.x / 2.0f, .y = array.y / 2.0f };
+	const float    scale_q = roi->scale / (1 << PC_REALS_Q);
+	const Hexbank* bank    = Hexsamp_bank(pc_banks_sq2hex, 0.0f, technique, Hexsamp_bank_sq2hex);
+	      int      off[9];
+
+	Hexsamp_sq2hex_offsets(off, array.stride);
+
+	for(unsigned int r = 0; r < roi->n; r++) {
+		const Hexrange range = roi->ranges[r];
+
+		for(unsigned int i = range.begin; i < range.end; i++) {
+			Hexsamp_sq2hex_pixel(array, hexarray->p[i], bank, off,
+				cart_a.y - scale_q * pc_reals_q[2 * i + 1],
+				cart_a.x + scale_q * pc_reals_q[2 * i], !range.interior);
 		}
+	}
+}
 
-		cart_a.x  = pc_reals_min.x;
-		cart_a.y += scale;
+// Pyramide
+
+void Hexpyramid_init(Hexpyramid* pyramid, unsigned int order) {
+	unsigned int n = (unsigned int)pow(7, order);
+
+	pyramid->order = order < HEXPYRAMID_LEVELS ? order : HEXPYRAMID_LEVELS;
+	pyramid->size  = 0;
+
+	for(unsigned int k = 1; k <= pyramid->order; k++) {
+		n /= 7;
+
+		pyramid->offset[k] = pyramid->size;
+		pyramid->size     += n;
+	}
+
+	pyramid->p = (u8*)calloc(3 * (pyramid->size ? pyramid->size : 1), sizeof(u8));
+}
+
+void Hexpyramid_free(Hexpyramid* pyramid) {
+	free(pyramid->p);
+
+	pyramid->p     = NULL;
+	pyramid->order = 0;
+	pyramid->size  = 0;
+}
+
+u8* Hexpyramid_level(const Hexpyramid* pyramid, unsigned int k) {
+	return pyramid->p + 3 * pyramid->offset[k];
+}
+
+// Stufe 1 aus den Zeigern von hexarray, darueber aus der zusammenhaengenden
+// Stufe k - 1 (21 Bytes je Elternpixel); Elternbereich je Stufe lo / 7 ..
+// (hi - 1) / 7
+void Hexpyramid_update(Hexpyramid* pyramid, Hexarray hexarray, unsigned int begin,
+ unsigned int end) {
+	unsigned int lo = begin;
+	unsigned int hi = end;
+
+	if(!pyramid->order || begin >= end)
+		return;
+
+	lo = lo / 7;
+	hi = (hi - 1) / 7 + 1;
+
+	u8* dst = Hexpyramid_level(pyramid, 1);
+
+	for(unsigned int j = lo; j < hi; j++) {
+		u8** const   c = &hexarray.p[7 * j];
+		unsigned int s[3];
+
+		for(unsigned int ch = 0; ch < 3; ch++)
+			s[ch] = c[0][ch] + c[1][ch] + c[2][ch] + c[3][ch] + c[4][ch] + c[5][ch] + c[6][ch];
+
+		dst[3 * j]     = (u8)((s[0] + 3) / 7);
+		dst[3 * j + 1] = (u8)((s[1] + 3) / 7);
+		dst[3 * j + 2] = (u8)((s[2] + 3) / 7);
+	}
+
+	for(unsigned int k = 2; k <= pyramid->order; k++) {
+		const u8* src = dst;
+
+		dst = Hexpyramid_level(pyramid, k);
+		lo  = lo / 7;
+		hi  = (hi - 1) / 7 + 1;
+
+		for(unsigned int j = lo; j < hi; j++) {
+			const u8* c = &src[21 * j];
+
+			for(unsigned int ch = 0; ch < 3; ch++)
+				dst[3 * j + ch] = (u8)((c[ch] + c[3 + ch] + c[6 + ch] + c[9 + ch] +
+					c[12 + ch] + c[15 + ch] + c[18 + ch] + 3) / 7);
+		}
+	}
+}
+
+void Hexpyramid_build(Hexpyramid* pyramid, Hexarray hexarray) {
+	Hexpyramid_update(pyramid, hexarray, 0, hexarray.size);
+}
+
+void Hexpyramid_update_roi(Hexpyramid* pyramid, Hexarray hexarray, const Hexroi* roi) {
+	for(unsigned int r = 0; r < roi->n; r++)
+		Hexpyramid_update(pyramid, hexarray, roi->ranges[r].begin, roi->ranges[r].end);
+}
+
+// Faltung
+
+void Hexkernel_init(Hexkernel* kernel, unsigned int taps, const float* w, float bias,
+ bool absolute) {
+	kernel->taps     = taps > 7 ? 49 : 7;
+	kernel->bias     = (int)lroundf(bias);
+	kernel->absolute = absolute;
+
+	// |w| < 2^(15 - HEXCONV_Q)
+	for(unsigned int j = 0; j < 49; j++) {
+		const long q = j < kernel->taps ? lroundf(w[j] * (1 << HEXCONV_Q)) : 0;
+
+		kernel->w[j] = (int16_t)(q < INT16_MIN ? INT16_MIN : q > INT16_MAX ? INT16_MAX : q);
+	}
+}
+
+void Hexkernel_gauss(Hexkernel* kernel, unsigned int taps, float sigma) {
+	float w[49];
+	float sum = 0.0f;
+	int   q   = 0;
+
+	taps = taps > 7 ? 49 : 7;
+
+	for(unsigned int j = 0; j < taps; j++) {
+		const fPoint2d r = getReal(Hexint_init(j, 0));
+
+		w[j] = expf(-(r.x * r.x + r.y * r.y) / (2 * sigma * sigma));
+		sum += w[j];
+	}
+
+	for(unsigned int j = 0; j < taps; j++)
+		w[j] /= sum;
+
+	Hexkernel_init(kernel, taps, w, 0.0f, false);
+
+	// Rundungsfehler in die Mitte
+	for(unsigned int j = 0; j < taps; j++)
+		q += kernel->w[j];
+
+	kernel->w[0] += (1 << HEXCONV_Q) - q;
+}
+
+void Hexkernel_laplace(Hexkernel* kernel, unsigned int taps, float gain) {
+	float w[49];
+	float sum = 0.0f;
+
+	taps = taps > 7 ? 49 : 7;
+
+	for(unsigned int j = 1; j < taps; j++) {
+		const fPoint2d r = getReal(Hexint_init(j, 0));
+
+		w[j] = expf(-(r.x * r.x + r.y * r.y) / 2);
+		sum += w[j];
+	}
+
+	w[0] = -gain;
+
+	for(unsigned int j = 1; j < taps; j++)
+		w[j] *= gain / sum;
+
+	Hexkernel_init(kernel, taps, w, 128.0f, false);
+
+	// Summe genau 0: flache Flaechen -> bias
+	kernel->w[0] = 0;
+
+	for(unsigned int j = 1; j < taps; j++)
+		kernel->w[0] -= kernel->w[j];
+}
+
+void Hexkernel_gradient(Hexkernel* kernel, unsigned int taps, float angle, float gain) {
+	const fPoint2d dir = { .x = cosf(angle), .y = sinf(angle) };
+	float          w[49];
+	float          norm = 0.0f;
+
+	taps = taps > 7 ? 49 : 7;
+
+	// Summe w_j * <r_j, dir> = gain
+	for(unsigned int j = 0; j < taps; j++) {
+		const fPoint2d r = getReal(Hexint_init(j, 0));
+		const float    d = r.x * dir.x + r.y * dir.y;
+
+		w[j]  = d * expf(-(r.x * r.x + r.y * r.y) / 2);
+		norm += w[j] * d;
+	}
+
+	for(unsigned int j = 0; j < taps; j++)
+		w[j] *= gain / norm;
+
+	Hexkernel_init(kernel, taps, w, 0.0f, true);
+}
+
+// Taps liegen hoechstens 4 Gitterschritte von der Mitte, pc_lattice hat
+// 2 * PC_LATTICE_PAD Rand: c + off[j] bleibt im Gitter
+void Hexconv_init(Hexconv* conv, unsigned int size, unsigned int taps) {
+	unsigned int n_runs = 0, n_edge = 0;
+
+	conv->size     = size;
+	conv->taps     = taps > 7 ? 49 : 7;
+	conv->dims     = pc_lattice_dims;
+	conv->cells    = pc_lattice_dims.x * pc_lattice_dims.y;
+	conv->row_runs = (unsigned int*)malloc((conv->dims.x + 1) * sizeof(unsigned int));
+	conv->row_edge = (unsigned int*)malloc((conv->dims.x + 1) * sizeof(unsigned int));
+	conv->grid     = (u8*)calloc(3 * conv->cells + HEXCONV_RUN, sizeof(u8));
+
+	for(unsigned int j = 0; j < conv->taps; j++) {
+		const fPoint2d r = getReal(Hexint_init(j, 0));
+		const iPoint2d l = Hexsamp_lattice(r.x, r.y);
+
+		conv->off[j] = l.x * (int)conv->dims.y + l.y;
+	}
+
+	// zwei Durchlaeufe: zaehlen, dann eintragen
+	conv->runs = NULL;
+	conv->edge = NULL;
+
+	for(unsigned int pass = 0; pass < 2; pass++) {
+		n_runs = n_edge = 0;
+
+		for(unsigned int a = 0; a < conv->dims.x; a++) {
+			bool open = false;
+
+			conv->row_runs[a] = n_runs;
+			conv->row_edge[a] = n_edge;
+
+			for(unsigned int b = 0; b < conv->dims.y; b++) {
+				const unsigned int c        = a * conv->dims.y + b;
+				      bool         interior = pc_lattice[c] < size;
+
+				if(!interior) {
+					open = false;
+					continue;
+				}
+
+				for(unsigned int j = 1; j < conv->taps && interior; j++)
+					interior = pc_lattice[c + conv->off[j]] < size;
+
+				if(!interior) {
+					if(pass)
+						conv->edge[n_edge] = c;
+
+					n_edge++;
+					open = false;
+				} else if(open) {
+					if(pass)
+						conv->runs[n_runs - 1].n++;
+				} else {
+					if(pass) {
+						conv->runs[n_runs].cell = c;
+						conv->runs[n_runs].n    = 1;
+					}
+
+					n_runs++;
+					open = true;
+				}
+			}
+		}
+
+		conv->row_runs[conv->dims.x] = n_runs;
+		conv->row_edge[conv->dims.x] = n_edge;
+
+		if(!pass) {
+			conv->runs = (Hexrun*)malloc((n_runs ? n_runs : 1) * sizeof(Hexrun));
+			conv->edge = (unsigned int*)malloc((n_edge ? n_edge : 1) * sizeof(unsigned int));
+		}
+	}
+}
+
+void Hexconv_free(Hexconv* conv) {
+	free(conv->runs);
+	free(conv->row_runs);
+	free(conv->edge);
+	free(conv->row_edge);
+	free(conv->grid);
+
+	conv->runs     = NULL;
+	conv->row_runs = NULL;
+	conv->edge     = NULL;
+	conv->row_edge = NULL;
+	conv->grid     = NULL;
+	conv->size     = 0;
+}
+
+void Hexconv_pack(const Hexconv* conv, Hexarray src, unsigned int begin, unsigned int end) {
+	u8* const plane[3] = { conv->grid, conv->grid + conv->cells, conv->grid + 2 * conv->cells };
+
+	for(unsigned int c = begin * conv->dims.y; c < end * conv->dims.y; c++) {
+		const unsigned int h = pc_lattice[c];
+
+		if(h < conv->size) {
+			plane[0][c] = src.p[h][0];
+			plane[1][c] = src.p[h][1];
+			plane[2][c] = src.p[h][2];
+		}
+	}
+}
+
+static inline u8 Hexconv_out(const Hexkernel* kernel, int acc) {
+	int v = acc >> HEXCONV_Q;
+
+	if(kernel->absolute && v < 0)
+		v = -v;
+
+	v += kernel->bias;
+
+	return (u8)(v < 0 ? 0 : v > 255 ? 255 : v);
+}
+
+// innere Laeufe: je Ebene und Tap eine Schleife ueber HEXCONV_RUN Zellen
+// mit festem Versatz (feste Laenge, vektorisierbar; Zellen nach dem Lauf
+// werden mitgerechnet, grid hat dafuer Reserve), Randzellen einzeln
+void Hexconv_rows(const Hexconv* conv, const Hexkernel* kernel, Hexarray* dest,
+ unsigned int begin, unsigned int end) {
+	const int half = 1 << (HEXCONV_Q - 1);
+	int       acc[3][HEXCONV_RUN];
+
+	for(unsigned int r = conv->row_runs[begin]; r < conv->row_runs[end]; r++) {
+		const Hexrun run = conv->runs[r];
+
+		for(unsigned int c0 = run.cell; c0 < run.cell + run.n; c0 += HEXCONV_RUN) {
+			const unsigned int n = run.cell + run.n - c0 < HEXCONV_RUN ? run.cell + run.n - c0 : HEXCONV_RUN;
+
+			for(unsigned int ch = 0; ch < 3; ch++) {
+				const u8* plane = conv->grid + ch * conv->cells + c0;
+				      int* a    = acc[ch];
+
+				for(unsigned int x = 0; x < HEXCONV_RUN; x++)
+					a[x] = half;
+
+				// je 7 Taps (ein Teilaggregat) pro Durchlauf ueber acc,
+				// 16 x 16 -> 32 Bit
+				for(unsigned int j = 0; j < conv->taps; j += 7) {
+					const u8*     s0 = plane + conv->off[j],     * s1 = plane + conv->off[j + 1];
+					const u8*     s2 = plane + conv->off[j + 2], * s3 = plane + conv->off[j + 3];
+					const u8*     s4 = plane + conv->off[j + 4], * s5 = plane + conv->off[j + 5];
+					const u8*     s6 = plane + conv->off[j + 6];
+					const int16_t* w = &kernel->w[j];
+
+					for(unsigned int x = 0; x < HEXCONV_RUN; x++)
+						a[x] += (int16_t)s0[x] * w[0] + (int16_t)s1[x] * w[1] + (int16_t)s2[x] * w[2] +
+						        (int16_t)s3[x] * w[3] + (int16_t)s4[x] * w[4] + (int16_t)s5[x] * w[5] +
+						        (int16_t)s6[x] * w[6];
+				}
+			}
+
+			for(unsigned int x = 0; x < n; x++) {
+				u8* const p = dest->p[pc_lattice[c0 + x]];
+
+				p[0] = Hexconv_out(kernel, acc[0][x]);
+				p[1] = Hexconv_out(kernel, acc[1][x]);
+				p[2] = Hexconv_out(kernel, acc[2][x]);
+			}
+		}
+	}
+
+	for(unsigned int e = conv->row_edge[begin]; e < conv->row_edge[end]; e++) {
+		const unsigned int c = conv->edge[e];
+		u8* const          p = dest->p[pc_lattice[c]];
+
+		for(unsigned int ch = 0; ch < 3; ch++) {
+			const u8* plane = conv->grid + ch * conv->cells;
+			      int a     = half;
+
+			for(unsigned int j = 0; j < conv->taps; j++) {
+				const unsigned int cj = c + conv->off[j];
+
+				a += kernel->w[j] * plane[pc_lattice[cj] < conv->size ? cj : c];
+			}
+
+			p[ch] = Hexconv_out(kernel, a);
+		}
+	}
+}
+
+void Hexconv_apply(const Hexconv* conv, const Hexkernel* kernel, Hexarray src, Hexarray* dest) {
+	Hexconv_pack(conv, src, 0, conv->dims.x);
+	Hexconv_rows(conv, kernel, dest, 0, conv->dims.x);
+}
+
+// FFT
+
+// a + b * zeta, zeta^2 = zeta - 1, conj(zeta) = 1 - zeta
+typedef struct { int64_t a; int64_t b; } Hexfft_point;
+
+static Hexfft_point Hexfft_mul(Hexfft_point p, Hexfft_point q) {
+	const Hexfft_point r = { .a = p.a * q.a - p.b * q.b, .b = p.a * q.b + p.b * q.a + p.b * q.b };
+
+	return r;
+}
+
+static Hexfft_point Hexfft_conj(Hexfft_point p) {
+	const Hexfft_point r = { .a = p.a + p.b, .b = -p.b };
+
+	return r;
+}
+
+static Hexfft_point Hexfft_digit(unsigned int d) {
+	const fPoint2d     r = getReal(Hexint_init(d, 0));
+	const iPoint2d     l = Hexsamp_lattice(r.x, r.y);
+	const Hexfft_point p = { .a = l.x, .b = l.y };
+
+	return p;
+}
+
+// p(0 .. n - 1) ganzzahlig
+static void Hexfft_positions(Hexfft_point* p, unsigned int n) {
+	const Hexfft_point b = Hexfft_digit(7);
+	      Hexfft_point r[7];
+
+	for(unsigned int d = 0; d < 7; d++)
+		r[d] = Hexfft_digit(d);
+
+	p[0] = r[0];
+
+	for(unsigned int i = 1; i < n; i++) {
+		const Hexfft_point q = Hexfft_mul(b, p[i / 7]);
+
+		p[i].a = r[i % 7].a + q.a;
+		p[i].b = r[i % 7].b + q.b;
+	}
+}
+
+// e^(-2 pi i k / m), k = zeta-Anteil von p * q * c
+static fComplex Hexfft_root(Hexfft_point p, Hexfft_point q, Hexfft_point c, int64_t m) {
+	const int64_t k = ((Hexfft_mul(Hexfft_mul(p, q), c).b % m) + m) % m;
+	const double  t = -2 * M_PI * (double)k / (double)m;
+	fComplex      w = { .re = (float)cos(t), .im = (float)sin(t) };
+
+	return w;
+}
+
+void Hexfft_init(Hexfft* fft, unsigned int order) {
+	Hexfft_point c = Hexfft_conj(Hexfft_digit(7));
+	Hexfft_point p[7];
+	Hexfft_point cs;
+	unsigned int n = 0;
+
+	fft->order   = order < HEXFFT_LEVELS ? order : HEXFFT_LEVELS;
+	fft->size    = (unsigned int)pow(7, fft->order);
+	fft->reverse = (unsigned int*)malloc(fft->size * sizeof(unsigned int));
+
+	for(unsigned int i = 0; i < fft->size; i++) {
+		unsigned int r = 0;
+
+		for(unsigned int k = 0, v = i; k < fft->order; k++, v /= 7)
+			r = 7 * r + v % 7;
+
+		fft->reverse[i] = r;
+	}
+
+	for(unsigned int s = 1; s <= fft->order; s++) {
+		fft->offset[s] = n;
+		n             += 7 * (unsigned int)pow(7, s - 1);
+	}
+
+	fft->twiddle = (fComplex*)malloc((n ? n : 1) * sizeof(fComplex));
+
+	Hexfft_positions(p, 7);
+
+	// Stufe s: Teilfrequenz u < 7^(s - 1) mit Ziffer d, c^s / 7^s
+	Hexfft_point* pu = (Hexfft_point*)malloc(fft->size * sizeof(Hexfft_point));
+
+	Hexfft_positions(pu, fft->size);
+
+	cs = c;
+
+	for(unsigned int s = 1, m = 1; s <= fft->order; s++, m *= 7) {
+		for(unsigned int u = 0; u < m; u++)
+			for(unsigned int d = 0; d < 7; d++)
+				fft->twiddle[fft->offset[s] + 7 * u + d] = Hexfft_root(pu[u], p[d], cs, 7 * (int64_t)m);
+
+		cs = Hexfft_mul(cs, c);
+	}
+
+	free(pu);
+
+	for(unsigned int u = 0; u < 7; u++)
+		for(unsigned int d = 0; d < 7; d++)
+			fft->kernel[7 * u + d] = Hexfft_root(p[u], p[d], c, 7);
+}
+
+void Hexfft_free(Hexfft* fft) {
+	free(fft->reverse);
+	free(fft->twiddle);
+
+	fft->reverse = NULL;
+	fft->twiddle = NULL;
+	fft->size    = 0;
+}
+
+void Hexfft_forward(const Hexfft* fft, fComplex* data) {
+	for(unsigned int i = 0; i < fft->size; i++) {
+		const unsigned int r = fft->reverse[i];
+
+		if(i < r) {
+			const fComplex t = data[i];
+
+			data[i] = data[r];
+			data[r] = t;
+		}
+	}
+
+	// Block zu 7m: Teil-FFT d an base + d * m, Frequenz u von Teil d wird
+	// mit twiddle[u][d] gewichtet, Ergebnis fuer Ziffer v an base + v * m + u
+	for(unsigned int s = 1, m = 1; s <= fft->order; s++, m *= 7) {
+		const fComplex* tw = fft->twiddle + fft->offset[s];
+
+		for(unsigned int base = 0; base < fft->size; base += 7 * m) {
+			for(unsigned int u = 0; u < m; u++) {
+				fComplex* x = data + base + u;
+				fComplex  a[7];
+
+				for(unsigned int d = 0; d < 7; d++) {
+					const fComplex v = x[d * m];
+					const fComplex w = tw[7 * u + d];
+
+					a[d].re = v.re * w.re - v.im * w.im;
+					a[d].im = v.re * w.im + v.im * w.re;
+				}
+
+				for(unsigned int v = 0; v < 7; v++) {
+					const fComplex* k  = &fft->kernel[7 * v];
+					      float     re = a[0].re, im = a[0].im;
+
+					// kernel[v][0] = 1
+					for(unsigned int d = 1; d < 7; d++) {
+						re += a[d].re * k[d].re - a[d].im * k[d].im;
+						im += a[d].re * k[d].im + a[d].im * k[d].re;
+					}
+
+					x[v * m].re = re;
+					x[v * m].im = im;
+				}
+			}
+		}
+	}
+}
+
+// conj(FFT(conj(X))) / 7^order
+void Hexfft_inverse(const Hexfft* fft, fComplex* data) {
+	const float n = 1.0f / fft->size;
+
+	for(unsigned int i = 0; i < fft->size; i++)
+		data[i].im = -data[i].im;
+
+	Hexfft_forward(fft, data);
+
+	for(unsigned int i = 0; i < fft->size; i++) {
+		data[i].re *=  n;
+		data[i].im *= -n;
+	}
+}
+
+void Hexfft_dft(unsigned int order, const fComplex* in, fComplex* out, bool inverse) {
+	const unsigned int  size = (unsigned int)pow(7, order);
+	const Hexfft_point  b    = Hexfft_digit(7);
+	      Hexfft_point  c    = { .a = 1, .b = 0 };
+	      Hexfft_point* p    = (Hexfft_point*)malloc(size * sizeof(Hexfft_point));
+
+	for(unsigned int k = 0; k < order; k++)
+		c = Hexfft_mul(c, Hexfft_conj(b));
+
+	Hexfft_positions(p, size);
+
+	for(unsigned int u = 0; u < size; u++) {
+		double re = 0, im = 0;
+
+		for(unsigned int x = 0; x < size; x++) {
+			const int64_t k = ((Hexfft_mul(Hexfft_mul(p[u], p[x]), c).b % size) + size) % size;
+			const double  t = (inverse ? 2 : -2) * M_PI * (double)k / size;
+
+			re += in[x].re * cos(t) - in[x].im * sin(t);
+			im += in[x].re * sin(t) + in[x].im * cos(t);
+		}
+
+		out[u].re = (float)(inverse ? re / size : re);
+		out[u].im = (float)(inverse ? im / size : im);
+	}
+
+	free(p);
+}
+
+void Hexfft_load(Hexarray hexarray, unsigned int ch, fComplex* data) {
+	for(unsigned int i = 0; i < hexarray.size; i++) {
+		data[i].re = hexarray.p[i][ch];
+		data[i].im = 0.0f;
+	}
+}
+
+void Hexfft_store(const fComplex* data, Hexarray* hexarray, unsigned int ch) {
+	for(unsigned int i = 0; i < hexarray->size; i++) {
+		const float v = roundf(data[i].re);
+
+		hexarray->p[i][ch] = (u8)(v < 0 ? 0 : v > 255 ? 255 : v);
+	}
+}
+
+
+void Hexsamp_hex2sq(Hexarray hexarray, pArray2d* array,
+ float radius, float scale, unsigned int technique) {
+	const uPoint2d size   = { .x = array->x, .y = array->y };
+	const iPoint2d offset = { .x = 0,        .y = 0        };
+
+	Hexsamp_hex2sq_clip(hexarray, array, size, offset, radius, scale, technique);
+}
+
+// Ausgabe (size) an offset in array, nur sichtbare Pixel werden berechnet
+void Hexsamp_hex2sq_clip(Hexarray hexarray, pArray2d* array, uPoint2d size,
+ iPoint2d offset, float radius, float scale, unsigned int technique) {
+	// array->x = (unsigned int)roundf((pc_reals_max.x - pc_reals_min.x) / scale) + 1;
+	// array->y = (unsigned int)roundf((pc_reals_max.y - pc_reals_min.y) / scale) + 1;
+	// pArray2d_init(array, array->x, array->y);
+
+
+	// Zeile y -> Zielzeile offset.y + size.y - y - 1
+	const int x_begin = offset.x < 0 ? -offset.x : 0;
+	const int x_end   = (int)size.x < (int)array->x - offset.x ? (int)size.x : (int)array->x - offset.x;
+	const int y_begin = offset.y + (int)size.y > (int)array->y ? offset.y + (int)size.y - (int)array->y : 0;
+	const int y_end   = offset.y < 0 ? (int)size.y + offset.y : (int)size.y;
+
+	fPoint2d cart_a = { .x = pc_reals_min.x, .y = pc_reals_min.y };
+	fPoint2d cart_0 = { .x = pc_reals_min.x, .y = pc_reals_min.y };
+
+	// Gewichte je Phase, Nachbarn als Offset in pc_lattice
+	const Hexbank*     bank    = Hexsamp_bank(pc_banks_hex2sq, radius, technique, Hexsamp_bank_hex2sq);
+	const float        sqrt3_2 = sqrtf(3.0f) / 2;
+	const unsigned int pad     = PC_LATTICE_PAD;
+	      int          off[49];
+
+	for(unsigned int j = 0; j < bank->nb_n; j++)
+		off[j] = bank->nb[j].x * (int)pc_lattice_dims.y + bank->nb[j].y;
+
+	// wie zeilen-/spaltenweises Aufaddieren ab (0, 0)
+	for(int x = 0; x < x_begin; x++) cart_0.x += scale;
+	for(int y = 0; y < y_begin; y++) cart_0.y += scale;
+
+	cart_a = cart_0;
+
+	for(int y = y_begin; y < y_end; y++) {
+		u8* row = array->p + (offset.y + size.y - y - 1) * array->stride + 3 * offset.x;
+
+		for(int x = x_begin; x < x_end; x++) {
+			float out[3] = { 0.0f, 0.0f, 0.0f };
+			float out_n  =   0.0f;
+
+
+			// naechstes Hex-Pixel, Phase relativ zu dessen Mitte
+			const iPoint2d     l  = Hexsamp_lattice(cart_a.x, cart_a.y);
+			const unsigned int la = l.x - pc_lattice_min.x;
+			const unsigned int lb = l.y - pc_lattice_min.y;
+
+			// ausserhalb des Gitters: keine Hex-Pixel in Reichweite
+			if(la - pad < pc_lattice_dims.x - 2 * pad && lb - pad < pc_lattice_dims.y - 2 * pad) {
+				const unsigned int  f = Hexsamp_phase(cart_a.x - l.x - l.y / 2.0f, bank->phases) * bank->phases +
+				                        Hexsamp_phase(cart_a.y - l.y * sqrt3_2,    bank->phases);
+				const unsigned int* c = pc_lattice + la * pc_lattice_dims.y + lb;
+				const Hextap*       t = bank->taps + f * bank->taps_max;
+
+				for(unsigned int k = 0; k < bank->n[f]; k++) {
+					// const unsigned int hi = getInt(add(getNearest(cart_a.x, cart_a.y), Hexint_init(t[k].p, 0)));
+					const unsigned int hi = c[off[t[k].p]];
+
+					if(hi < hexarray.size) {
+						out[0] += t[k].w * hexarray.p[hi][0];
+						out[1] += t[k].w * hexarray.p[hi][1];
+						out[2] += t[k].w * hexarray.p[hi][2];
+						out_n  += t[k].w;
+					}
+				}
+			}
+
+
+			u8* const p = row + 3 * x;
+
+			// Patch Transformation: Normalisierung
+			if(out_n > 0.0f) {
+				out[0] = roundf(out[0] / out_n);
+				out[1] = roundf(out[1] / out_n);
+				out[2] = roundf(out[2] / out_n);
+			} else {
+				out[0] = roundf(out[0]);
+				out[1] = roundf(out[1]);
+				out[2] = roundf(out[2]);
+			}
+
+			if(out[0] < 255) {
+				p[0] = (int)out[0];
+			} else {
+				p[0] = 255;
+			}
+			if(out[1] < 255) {
+				p[1] = (int)out[1];
+			} else {
+				p[1] = 255;
+			}
+			if(out[2] < 255) {
+				p[2] = (int)out[2];
+			} else {
+				p[2] = 255;
+			}
+
+
+			cart_a.x += scale;
+		}
+
+		cart_a.x  = cart_0.x;
+		cart_a.y += scale;
+	}
+}
+
+unsigned int Hexsamp_hex2sq_delta(Hexarray hexarray, pArray2d* array, uPoint2d size,
+ iPoint2d offset, Hexdelta* delta, float radius, float scale, unsigned int technique,
+ iPoint2d* min, iPoint2d* max) {
+	const Hexbank*     bank    = Hexsamp_bank(pc_banks_hex2sq, radius, technique, Hexsamp_bank_hex2sq);
+	const float        sqrt3_2 = sqrtf(3.0f) / 2;
+	const uPoint2d     dims    = { .x = (array->x + HEXSAMP_TILE - 1) / HEXSAMP_TILE,
+	                               .y = (array->y + HEXSAMP_TILE - 1) / HEXSAMP_TILE };
+	      float        reach   = 0.0f;
+	      unsigned int n       = 0;
+
+	min->x = array->x;
+	min->y = array->y;
+	max->x = max->y = 0;
+
+	if(dims.x != delta->out_dims.x || dims.y != delta->out_dims.y) {
+		free(delta->out_dirty);
+
+		delta->out_dirty = (u8*)calloc(dims.x * dims.y, sizeof(u8));
+		delta->out_dims  = dims;
+	}
+
+	// Reichweite eines Hex-Pixels: Ausgabepixel, deren naechstes Hex-Pixel
+	// (Abstand <= 1/sqrt(3)) es als Nachbarn hat
+	for(unsigned int j = 0; j < bank->nb_n; j++) {
+		const float x = bank->nb[j].x + bank->nb[j].y / 2.0f;
+		const float y = bank->nb[j].y * sqrt3_2;
+
+		if(sqrtf(x * x + y * y) > reach)
+			reach = sqrtf(x * x + y * y);
+	}
+
+	const float r = (reach + 1 / sqrtf(3.0f)) / scale + 1;
+
+	// Zeile y von Hexsamp_hex2sq_clip -> offset.y + size.y - y - 1
+	for(unsigned int i = 0; i < hexarray.size; i++) {
+		if(delta->changed[i] != 1)
+			continue;
+
+		const float x = offset.x + (pc_reals[2 * i] - pc_reals_min.x) / scale;
+		const float y = offset.y + (int)size.y - 1 - (pc_reals[2 * i + 1] - pc_reals_min.y) / scale;
+
+		if(x + r < 0 || y + r < 0 || x - r >= array->x || y - r >= array->y)
+			continue;
+
+		const int tx0 = x - r > 0 ? (int)(x - r) / HEXSAMP_TILE : 0;
+		const int ty0 = y - r > 0 ? (int)(y - r) / HEXSAMP_TILE : 0;
+		const int tx1 = (int)(x + r) / HEXSAMP_TILE < (int)dims.x ? (int)(x + r) / HEXSAMP_TILE : (int)dims.x - 1;
+		const int ty1 = (int)(y + r) / HEXSAMP_TILE < (int)dims.y ? (int)(y + r) / HEXSAMP_TILE : (int)dims.y - 1;
+
+		for(int ty = ty0; ty <= ty1; ty++) {
+			for(int tx = tx0; tx <= tx1; tx++)
+				delta->out_dirty[ty * dims.x + tx] = 1;
+		}
+	}
+
+	// zusammenhaengende Kacheln einer Kachelzeile als Sicht auf array; die
+	// Abtastorte entsprechen denen des vollstaendigen Aufrufs
+	for(unsigned int ty = 0; ty < dims.y; ty++) {
+		for(unsigned int tx = 0; tx < dims.x; tx++) {
+			if(!delta->out_dirty[ty * dims.x + tx])
+				continue;
+
+			unsigned int tx_end = tx;
+
+			while(tx_end < dims.x && delta->out_dirty[ty * dims.x + tx_end])
+				delta->out_dirty[ty * dims.x + tx_end++] = 0;
+
+			const int x0 = tx * HEXSAMP_TILE;
+			const int y0 = ty * HEXSAMP_TILE;
+			const int x1 = tx_end * HEXSAMP_TILE < array->x ? tx_end * HEXSAMP_TILE : array->x;
+			const int y1 = (ty + 1) * HEXSAMP_TILE < array->y ? (ty + 1) * HEXSAMP_TILE : array->y;
+
+			pArray2d view = { .p = array->p + y0 * array->stride + 3 * x0,
+			                  .x = x1 - x0, .y = y1 - y0, .stride = array->stride };
+
+			const iPoint2d view_offset = { .x = offset.x - x0, .y = offset.y - y0 };
+
+			Hexsamp_hex2sq_clip(hexarray, &view, size, view_offset, radius, scale, technique);
+
+			// davon im Hex-Bild
+			const int bx0 = x0 > offset.x ? x0 : offset.x;
+			const int by0 = y0 > offset.y ? y0 : offset.y;
+			const int bx1 = x1 < offset.x + (int)size.x ? x1 : offset.x + (int)size.x;
+			const int by1 = y1 < offset.y + (int)size.y ? y1 : offset.y + (int)size.y;
+
+			if(bx1 > bx0 && by1 > by0) {
+				n += (bx1 - bx0) * (by1 - by0);
+
+				if(bx0 < min->x) min->x = bx0;
+				if(by0 < min->y) min->y = by0;
+				if(bx1 > max->x) max->x = bx1;
+				if(by1 > max->y) max->y = by1;
+			}
+
+			tx = tx_end;
+		}
+	}
+
+	return n;
+}
+
+// Zusammengesetzte Abbildung sq2hex + hex2sq (mode_d = 2): Gewichte beider
+// Schritte werden je Ausgabepixel zu einer Zeile von Quell-Taps verrechnet
+void Hexsamp_sq2sq_init(Hexsq2sq* sq2sq, pArray2d array, pArray2d dest,
+ unsigned int hexsize, uPoint2d size, iPoint2d offset,
+ float radius, float scale_in, float scale_out, unsigned int technique) {
+	const fPoint2d     cart_s  = { .x = array.x / 2.0f, .y = array.y / 2.0f };
+	const float        scale_q = scale_in / (1 << PC_REALS_Q);
+	const unsigned int pad     = PC_LATTICE_PAD;
+	      fPoint2d     real[49];
+	      iPoint2d     nb[49];
+	const unsigned int nb_n    = Hexsamp_neighbours(real, nb, radius);
+
+	// sq2hex: <= 9 normierte Taps je Hex-Pixel
+	Hextap*      hex_taps = (Hextap*)malloc(9 * hexsize * sizeof(Hextap));
+	u8*          hex_n    = (u8*)calloc(hexsize, sizeof(u8));
+	Hextap       merged[49 * 9];
+	unsigned int taps_max = 0;
+
+	for(unsigned int i = 0; i < hexsize; i++) {
+		const float   row_hex = cart_s.y - scale_q * pc_reals_q[2 * i + 1];
+		const float   col_hex = cart_s.x + scale_q * pc_reals_q[2 * i];
+		const int     row     = (int)roundf(row_hex);
+		const int     col     = (int)roundf(col_hex);
+		      Hextap* t       = hex_taps + 9 * i;
+		      float   out_n   = 0.0f;
+
+		for(int x = col - 1; x < col + 2; x++) {
+			for(int y = row - 1; y < row + 2; y++) {
+				if(x >= 0 && x < array.x && y >= 0 && y < array.y) {
+					t[hex_n[i]].p = y * array.stride + 3 * x;
+					t[hex_n[i]].w = Hexsamp_sq2hex_weight(fabs(col_hex - x), fabs(row_hex - y), technique);
+					out_n        += t[hex_n[i]++].w;
+				}
+			}
+		}
+
+		if(out_n > 0.0f) {
+			for(unsigned int n = 0; n < hex_n[i]; n++)
+				t[n].w /= out_n;
+		}
+	}
+
+
+	// hex2sq: sichtbare Ausgabepixel wie Hexsamp_hex2sq_clip
+	const int x_begin = offset.x < 0 ? -offset.x : 0;
+	const int x_end   = (int)size.x < (int)dest.x - offset.x ? (int)size.x : (int)dest.x - offset.x;
+	const int y_begin = offset.y + (int)size.y > (int)dest.y ? offset.y + (int)size.y - (int)dest.y : 0;
+	const int y_end   = offset.y < 0 ? (int)size.y + offset.y : (int)size.y;
+
+	fPoint2d cart_a = { .x = pc_reals_min.x, .y = pc_reals_min.y };
+	fPoint2d cart_0 = { .x = pc_reals_min.x, .y = pc_reals_min.y };
+
+	for(int x = 0; x < x_begin; x++) cart_0.x += scale_out;
+	for(int y = 0; y < y_begin; y++) cart_0.y += scale_out;
+
+	sq2sq->size = x_end > x_begin && y_end > y_begin ? (x_end - x_begin) * (y_end - y_begin) : 0;
+	sq2sq->rows = (unsigned int*)malloc((sq2sq->size + 1) * sizeof(unsigned int));
+	sq2sq->dest = (unsigned int*)malloc(sq2sq->size * sizeof(unsigned int));
+	sq2sq->taps = NULL;
+
+	unsigned int k = 0;
+
+	sq2sq->rows[0] = 0;
+
+	cart_a = cart_0;
+
+	for(int y = y_begin; y < y_end; y++) {
+		for(int x = x_begin; x < x_end; x++, k++) {
+			unsigned int merged_n = 0;
+			float        out_n    = 0.0f;
+
+
+			const iPoint2d     l  = Hexsamp_lattice(cart_a.x, cart_a.y);
+			const unsigned int la = l.x - pc_lattice_min.x;
+			const unsigned int lb = l.y - pc_lattice_min.y;
+
+			for(unsigned int i = 0; i < nb_n && la - pad < pc_lattice_dims.x - 2 * pad &&
+			                                    lb - pad < pc_lattice_dims.y - 2 * pad; i++) {
+				const unsigned int hi = pc_lattice[(la + nb[i].x) * pc_lattice_dims.y + lb + nb[i].y];
+
+				if(hi < hexsize) {
+					const fPoint2d cart_ha = { .x = pc_reals[2 * hi],     \
+					                           .y = pc_reals[2 * hi + 1] };
+
+					if(fabs(cart_a.x - cart_ha.x) <= radius &&
+					   fabs(cart_a.y - cart_ha.y) <= radius) {
+						const float kh = kernel(cart_a.x - cart_ha.x, cart_a.y - cart_ha.y, technique);
+
+						// Taps des Hex-Pixels hi zusammenfassen
+						for(unsigned int n = 0; n < hex_n[hi]; n++) {
+							const Hextap       t = hex_taps[9 * hi + n];
+							      unsigned int m;
+
+							for(m = 0; m < merged_n && merged[m].p != t.p; m++);
+
+							if(m == merged_n) {
+								merged[m].p = t.p;
+								merged[m].w = 0.0f;
+								merged_n++;
+							}
+
+							merged[m].w += kh * t.w;
+						}
+
+						out_n += kh;
+					}
+				}
+			}
+
+
+			// Patch Transformation: Normalisierung
+			if(out_n > 0.0f) {
+				for(unsigned int m = 0; m < merged_n; m++)
+					merged[m].w /= out_n;
+			}
+
+			if(sq2sq->rows[k] + merged_n > taps_max) {
+				taps_max    = 2 * (sq2sq->rows[k] + merged_n);
+				sq2sq->taps = (Hextap*)realloc(sq2sq->taps, taps_max * sizeof(Hextap));
+			}
+
+			for(unsigned int m = 0; m < merged_n; m++)
+				sq2sq->taps[sq2sq->rows[k] + m] = merged[m];
+
+			sq2sq->rows[k + 1] = sq2sq->rows[k] + merged_n;
+			sq2sq->dest[k]     = (offset.y + size.y - y - 1) * dest.stride + 3 * (offset.x + x);
+
+
+			cart_a.x += scale_out;
+		}
+
+		cart_a.x  = cart_0.x;
+		cart_a.y += scale_out;
+	}
+
+
+	free(hex_taps);
+	free(hex_n);
+}
+
+void Hexsamp_sq2sq_free(Hexsq2sq* sq2sq) {
+	free(sq2sq->rows);
+	free(sq2sq->dest);
+	free(sq2sq->taps);
+
+	sq2sq->rows = sq2sq->dest = NULL;
+	sq2sq->taps = NULL;
+	sq2sq->size = 0;
+}
+
+void Hexsamp_sq2sq(Hexsq2sq sq2sq, pArray2d array, pArray2d* dest) {
+	for(unsigned int k = 0; k < sq2sq.size; k++) {
+		float out[3] = { 0.0f, 0.0f, 0.0f };
+		u8*   p      = dest->p + sq2sq.dest[k];
+
+		for(unsigned int t = sq2sq.rows[k]; t < sq2sq.rows[k + 1]; t++) {
+			const u8*   s = array.p + sq2sq.taps[t].p;
+			const float w = sq2sq.taps[t].w;
+
+			out[0] += w * s[0];
+			out[1] += w * s[1];
+			out[2] += w * s[2];
+		}
+
+		for(unsigned int c = 0; c < 3; c++) {
+			out[c] = roundf(out[c]);
+
+			p[c] = out[c] < 255 ? (int)out[c] : 255;
+		}
 	}
 }
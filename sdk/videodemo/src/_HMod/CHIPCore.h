@@ -58,6 +58,22 @@
 
 #define SIZEOF_ARRAY(array) (sizeof(array) / sizeof(array[0]))
 
+// Q10.5 (pc_reals_q): |x|, |y| < 2^10 bis order = 7
+#define PC_REALS_Q 5
+
+// pc_lattice: Rand in Gitterschritten fuer Abtastpunkte knapp ausserhalb
+// pc_reals_min .. pc_reals_max und die Nachbarn ihrer Hexsamp_hex2sq-Taps
+#define PC_LATTICE_PAD 4
+
+// Polyphasen-Gewichte (Hexbank): Phase je Achse auf 1/2^HEXSAMP_PHASE_BITS
+// quantisiert; HEXSAMP_BANKS Baenke je Resampler (radius, technique)
+#define HEXSAMP_PHASE_BITS 4
+#define HEXSAMP_BANKS      4
+
+// Hexsamp_sq2hex_delta: Quellbild in Kacheln zu HEXSAMP_TILE x HEXSAMP_TILE
+// Pixeln, je Kachel ein Hash; ebenso die Ausgabe von Hexsamp_hex2sq_delta
+#define HEXSAMP_TILE 16
+
 
 typedef struct { float        x; float        y; } fPoint2d;
 typedef struct { int          x; int          y; } iPoint2d;
@@ -65,24 +81,177 @@ typedef struct { unsigned int x; unsigned int y; } uPoint2d;
 
 typedef struct { float x; float y; float z; } fPoint3d;
 
+typedef struct { float re; float im; } fComplex;
+
 typedef struct { unsigned int value; unsigned int digits; } Hexint;
 
-typedef struct { u8* p; unsigned int x; unsigned int y; } pArray2d;
+// stride: Bytes je Zeile (pArray2d_init: 3 * x); Sichten auf fremde Puffer,
+// z. B. Framebuffer, ohne Kopie: { .p = fb, .x = w, .y = h, .stride = s }
+typedef struct { u8* p; unsigned int x; unsigned int y; unsigned int stride; } pArray2d;
 
 typedef struct { u8** p; unsigned int size; } Hexarray;
 
+// Hexsamp_sq2sq: Taps von Ausgabepixel k sind taps[rows[k]] bis
+// taps[rows[k + 1] - 1], p: Quelloffset (Bytes), dest[k]: Zieloffset (Bytes)
+typedef struct { unsigned int p; float w; } Hextap;
+
+typedef struct {
+	unsigned int  size;
+	unsigned int* rows;
+	unsigned int* dest;
+	Hextap*       taps;
+} Hexsq2sq;
+
+// Gewichte je Phase (Lage des Abtastpunkts relativ zum naechsten Hex-Pixel
+// bzw. Quellpixel), unabhaengig von scale: Taps von Phase
+// f = px * phases + py sind taps[f * taps_max] bis
+// taps[f * taps_max + n[f] - 1], nur Gewichte != 0; Hextap.p: Nachbar
+// (Hexsamp_hex2sq: Index in nb, Hexsamp_sq2hex: 3 * (x - col + 1) + y - row + 1)
+typedef struct {
+	unsigned int phases;   // je Achse, 0: leer
+	unsigned int taps_max;
+	u8*          n;
+	Hextap*      taps;
+	float*       norm;     // Hexsamp_sq2hex: 1 / Summe der Gewichte
+	unsigned int nb_n;     // Hexsamp_hex2sq: Nachbarn (7 bzw. 49) als
+	iPoint2d     nb[49];   // Gitterversatz (pc_lattice)
+	float        radius;
+	unsigned int technique;
+	unsigned int used;     // letzte Verwendung (Ersatz)
+} Hexbank;
+
+// Aenderungen gegenueber dem vorherigen Bild: neu berechnet werden nur
+// Hex-Pixel, deren 3x3 Stuetzstellen eine geaenderte Kachel beruehren
+typedef struct {
+	u8**          hex;       // Hexarray.p des vorherigen Bilds, NULL: keins
+	uPoint2d      res;       // Quellaufloesung
+	float         scale;
+	unsigned int  technique;
+	unsigned int  size;      // Hex-Pixel
+	uPoint2d      dims;      // Kacheln
+	iPoint2d      tile_min;  // von Hex-Pixeln gelesene Kacheln
+	iPoint2d      tile_max;
+	uint64_t*     hash;      // je Kachel
+	u8*           dirty;     // je Kachel
+	unsigned int* tile_rows; // Hex-Pixel (Index j in pc_order) mit
+	unsigned int* tile_hex;  // Stuetzstellen in Kachel t: tile_hex[tile_rows[t]]
+	                         // bis tile_hex[tile_rows[t + 1] - 1]
+	u8*           changed;   // je Hex-Pixel: 1 neu berechnet und verschieden,
+	                         // 2 neu berechnet und gleich, sonst 0
+	bool          full;      // letztes Bild vollstaendig berechnet
+	unsigned int  sampled;   // neu berechnete Hex-Pixel des letzten Bilds
+	unsigned int  changes;   // davon verschieden
+	uPoint2d      out_dims;  // Kacheln der Ausgabe (Hexsamp_hex2sq_delta)
+	u8*           out_dirty;
+} Hexdelta;
+
+// Ausschnitt (Hexroi_init): Spiraladressen begin .. end - 1; interior: alle
+// 9 Stuetzstellen (Hexsamp_sq2hex) im Bild
+typedef struct { unsigned int begin; unsigned int end; bool interior; } Hexrange;
+
+// Hex-Pixel, deren Abtastort (Hexsamp_sq2hex mit scale in einem Quellbild
+// der Groesse res) im Rechteck [min, max) liegt, als aufsteigende Bereiche
+typedef struct {
+	unsigned int size;     // 7^order
+	uPoint2d     res;
+	float        scale;
+	iPoint2d     min;
+	iPoint2d     max;
+	unsigned int n;
+	unsigned int capacity;
+	Hexrange*    ranges;
+	unsigned int pixels;   // Hex-Pixel in allen Bereichen
+	unsigned int visited;  // besuchte Aggregate
+} Hexroi;
+
+// Stufe k (1 .. order): Aggregate der Stufe k, Pixel j = gerundeter
+// Mittelwert der Pixel 7j .. 7j + 6 der Stufe k - 1 (Stufe 0: Hexarray),
+// 7^(order - k) Pixel zu je 3 Bytes ab p + 3 * offset[k]; alle Stufen
+// zusammen (7^order - 1) / 6 Pixel
+#define HEXPYRAMID_LEVELS 10
+
+typedef struct {
+	unsigned int order;
+	unsigned int size;                           // Pixel aller Stufen
+	unsigned int offset[HEXPYRAMID_LEVELS + 1];
+	u8*          p;
+} Hexpyramid;
+
+// Faltung (Hexconv): Tap j = Nachbar add(Mitte, Hexint_init(j, 0)), 7 bzw.
+// 49 Taps; Gewichte mit HEXCONV_Q Bits Nachkomma, Ergebnis
+// bias + (absolute ? |Summe| : Summe), auf 0 .. 255 begrenzt
+#define HEXCONV_Q   12
+#define HEXCONV_RUN 64  // Zellen je Teilstueck eines Laufs
+
+typedef struct {
+	unsigned int taps;
+	int16_t      w[49];
+	int          bias;
+	bool         absolute;
+} Hexkernel;
+
+// Zellen cell .. cell + n - 1 einer Gitterzeile: Hex-Pixel mit allen Taps
+// im Bild
+typedef struct { unsigned int cell; unsigned int n; } Hexrun;
+
+// Plan fuer die Tabellen (pc_lattice) einer order: Hex-Bild als 3 Ebenen
+// ueber dem Gitter (grid), darin jeder Tap ein fester Versatz (off); innere
+// Zellen in Laeufen, Randzellen (fehlende Taps: Mitte) einzeln, beide je
+// Gitterzeile (row_*, dims.x + 1 Eintraege)
+typedef struct {
+	unsigned int  size;
+	unsigned int  taps;
+	int           off[49];
+	uPoint2d      dims;
+	unsigned int  cells;
+	Hexrun*       runs;
+	unsigned int* row_runs;
+	unsigned int* edge;
+	unsigned int* row_edge;
+	u8*           grid;
+} Hexconv;
+
+// FFT (Hexfft): Ort p(x) eines Hex-Pixels als a + b * zeta (zeta =
+// e^(i pi / 3)), p(7y + d) = p(d) + B p(y) mit B = p(7); Frequenz u zum
+// Hex-Pixel x: e^(-2 pi i phi), phi = 2 / sqrt(3) * Im(p(u) p(x) / B^order)
+// = (zeta-Anteil von p(u) p(x) conj(B)^order) / 7^order; radix 7 mit
+// Zeitdezimierung: Eingang in Ziffernumkehr, Stufe s fasst je 7 Teil-FFTs
+// der Groesse 7^(s - 1) zusammen
+#define HEXFFT_LEVELS 10
+
+typedef struct {
+	unsigned int  order;
+	unsigned int  size;
+	unsigned int* reverse;                       // Ziffernumkehr zur Basis 7
+	fComplex*     twiddle;                       // Stufe s: 7^(s - 1) x 7 ab offset[s]
+	unsigned int  offset[HEXFFT_LEVELS + 1];
+	fComplex      kernel[49];                    // 7-Punkte-DFT [Frequenz][Ziffer]
+} Hexfft;
+
 
 float*   pc_reals;
+int16_t* pc_reals_q;
 iPoint2d pc_reals_min;
 iPoint2d pc_reals_max;
 
-float*   pc_spatials;
+int16_t* pc_spatials;
 iPoint2d pc_spatials_min;
 iPoint2d pc_spatials_max;
 
-unsigned int** pc_nearest;
+// Gitterpunkt (a, b) am Ort a * (1, 0) + b * (1/2, sqrt(3)/2) -> Hex-Index
+// (>= Anzahl: keiner) an (a - pc_lattice_min.x) * pc_lattice_dims.y +
+// b - pc_lattice_min.y
+unsigned int* pc_lattice;
+iPoint2d      pc_lattice_min;
+uPoint2d      pc_lattice_dims;
 
-unsigned int** pc_adds;
+unsigned int*  pc_order;
+unsigned int   pc_order_interior;
+uPoint2d       pc_order_dims;
+float          pc_order_scale;
+
+Hexbank pc_banks_sq2hex[HEXSAMP_BANKS];
+Hexbank pc_banks_hex2sq[HEXSAMP_BANKS];
 
 
 void pArray2d_init(pArray2d* array, unsigned int x, unsigned int y);
@@ -108,11 +277,107 @@ void Hexarray_free(Hexarray* hexarray);
 float sinc(float x);
 float kernel(float x, float y, unsigned int technique);
 
+// naechster Gitterpunkt (pc_lattice) zu (x, y)
+iPoint2d Hexsamp_lattice(float x, float y);
+
+// Gitter ueber reals_min .. reals_max (pc_reals_*), je Seite
+// 2 * PC_LATTICE_PAD Gitterschritte Rand: Groesse (-> pc_lattice_min,
+// pc_lattice_dims) bzw. Eintrag fuer den Ort p eines Hex-Pixels
+void         Hexsamp_lattice_dims(iPoint2d reals_min, iPoint2d reals_max,
+ iPoint2d* min, uPoint2d* dims);
+unsigned int Hexsamp_lattice_index(fPoint2d p, iPoint2d min, uPoint2d dims);
+
+void Hexsamp_banks_free();
+
+void Hexsamp_sq2hex_order(unsigned int size, float scale, unsigned int band);
+void Hexsamp_sq2hex_split(unsigned int size, unsigned int x, unsigned int y,
+ float scale);
+
 void Hexsamp_sq2hex(pArray2d array, Hexarray* hexarray,
  unsigned int order, float scale, unsigned int technique);
 
 void Hexsamp_hex2sq(Hexarray hexarray, pArray2d* array,
  float radius, float scale, unsigned int technique);
+void Hexsamp_hex2sq_clip(Hexarray hexarray, pArray2d* array, uPoint2d size,
+ iPoint2d offset, float radius, float scale, unsigned int technique);
+
+// wie Hexsamp_sq2hex, aber nur geaenderte Hex-Pixel (delta->changed);
+// vollstaendig beim ersten Bild bzw. nach Wechsel von hexarray, Aufloesung,
+// scale oder technique
+void Hexsamp_sq2hex_delta(pArray2d array, Hexarray* hexarray, Hexdelta* delta,
+ float scale, unsigned int technique);
+
+// wie Hexsamp_hex2sq_clip, aber nur Kacheln von array in Reichweite von
+// delta->changed (array enthaelt das vorherige Ergebnis); Rueckgabe: Anzahl
+// berechneter Pixel, deren Rechteck [min, max) in array
+unsigned int Hexsamp_hex2sq_delta(Hexarray hexarray, pArray2d* array, uPoint2d size,
+ iPoint2d offset, Hexdelta* delta, float radius, float scale, unsigned int technique,
+ iPoint2d* min, iPoint2d* max);
+
+void Hexsamp_delta_free(Hexdelta* delta);
+
+// Aggregat der Stufe k: 7^k aufeinanderfolgende Spiraladressen ab einem
+// Vielfachen von 7^k; ab order Aggregate ganz ausserhalb verwerfen, ganz
+// innerhalb uebernehmen, uebrige in ihre 7 Teilaggregate zerlegen, Aufwand
+// ~ Flaeche bzw. Umfang des Rechtecks; roi: leer ({ 0 }) oder aus einem
+// vorherigen Hexroi_init (Speicher wird weiterverwendet)
+void Hexroi_init(Hexroi* roi, unsigned int order, uPoint2d res, float scale,
+ iPoint2d min, iPoint2d max);
+void Hexroi_free(Hexroi* roi);
+
+// wie Hexsamp_sq2hex, nur die Hex-Pixel von roi (mit dessen scale)
+void Hexsamp_sq2hex_roi(pArray2d array, Hexarray* hexarray, const Hexroi* roi,
+ unsigned int technique);
+
+// Hexpyramid_build: alle Stufen in einem Durchlauf ueber hexarray.p (jede
+// Stufe liest nur die vorherige); Hexpyramid_update: nur die Vorfahren der
+// Spiraladressen begin .. end - 1, Hexpyramid_update_roi: die aller Bereiche
+void Hexpyramid_init(Hexpyramid* pyramid, unsigned int order);
+void Hexpyramid_free(Hexpyramid* pyramid);
+void Hexpyramid_build(Hexpyramid* pyramid, Hexarray hexarray);
+void Hexpyramid_update(Hexpyramid* pyramid, Hexarray hexarray, unsigned int begin,
+ unsigned int end);
+void Hexpyramid_update_roi(Hexpyramid* pyramid, Hexarray hexarray, const Hexroi* roi);
+u8*  Hexpyramid_level(const Hexpyramid* pyramid, unsigned int k);
+
+// w: taps Gewichte (Summe 1: Helligkeit bleibt); gauss: Summe genau
+// 1 << HEXCONV_Q; laplace: Taps j > 0 gaussgewichtet (sigma 1) minus Mitte,
+// bias 128; gradient: Ableitung in Richtung angle (rad) mit gaussgewichteten
+// Taps, Rampe mit Steigung 1 -> gain, Betrag
+void Hexkernel_init(Hexkernel* kernel, unsigned int taps, const float* w, float bias,
+ bool absolute);
+void Hexkernel_gauss(Hexkernel* kernel, unsigned int taps, float sigma);
+void Hexkernel_laplace(Hexkernel* kernel, unsigned int taps, float gain);
+void Hexkernel_gradient(Hexkernel* kernel, unsigned int taps, float angle, float gain);
+
+// Hexconv_pack: Gitterzeilen begin .. end - 1 von src in grid;
+// Hexconv_rows: deren Hex-Pixel aus grid nach dest (darf src sein), erst
+// nach Hexconv_pack aller Zeilen in Reichweite; Zeilenbereiche sind
+// unabhaengig (Threads); Hexconv_apply: beides fuer alle Zeilen
+void Hexconv_init(Hexconv* conv, unsigned int size, unsigned int taps);
+void Hexconv_free(Hexconv* conv);
+void Hexconv_pack(const Hexconv* conv, Hexarray src, unsigned int begin, unsigned int end);
+void Hexconv_rows(const Hexconv* conv, const Hexkernel* kernel, Hexarray* dest,
+ unsigned int begin, unsigned int end);
+void Hexconv_apply(const Hexconv* conv, const Hexkernel* kernel, Hexarray src, Hexarray* dest);
+
+// data: 7^order Werte an ihren Spiraladressen bzw. Frequenzen, in place;
+// inverse mit Faktor 1 / 7^order; Hexfft_dft: direkt (O(7^(2 order)),
+// Vergleich), in != out; load/store: Kanal ch eines Hexarray (Realteil,
+// auf 0 .. 255 begrenzt)
+void Hexfft_init(Hexfft* fft, unsigned int order);
+void Hexfft_free(Hexfft* fft);
+void Hexfft_forward(const Hexfft* fft, fComplex* data);
+void Hexfft_inverse(const Hexfft* fft, fComplex* data);
+void Hexfft_dft(unsigned int order, const fComplex* in, fComplex* out, bool inverse);
+void Hexfft_load(Hexarray hexarray, unsigned int ch, fComplex* data);
+void Hexfft_store(const fComplex* data, Hexarray* hexarray, unsigned int ch);
+
+void Hexsamp_sq2sq_init(Hexsq2sq* sq2sq, pArray2d array, pArray2d dest,
+ unsigned int hexsize, uPoint2d size, iPoint2d offset,
+ float radius, float scale_in, float scale_out, unsigned int technique);
+void Hexsamp_sq2sq_free(Hexsq2sq* sq2sq);
+void Hexsamp_sq2sq(Hexsq2sq sq2sq, pArray2d array, pArray2d* dest);
 
 
 #endif
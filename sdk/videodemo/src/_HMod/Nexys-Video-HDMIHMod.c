@@ -34,239 +34,1292 @@
 #include "CHIPCore.h"
 
 #include "sleep.h"
+#include "xil_cache.h"
 #include "xil_printf.h"
 #include "xil_types.h"
 
 #include "Nexys-Video-HDMIHMod.h"
 
 
-pArray2d array;
 Hexarray hexarray;
-pArray2d array_hex;
+
+u32*      pc_scatter        = NULL;
+u32       pc_scatter_size   = 0;
+uPoint2d  pc_scatter_res    = { .x = 0, .y = 0 };
+u32       pc_scatter_stride = 0;
+HModRange pc_scatter_range  = { .begin = 0, .width = 0, .rows = 0, .stride = 0 };
+
+Hexsq2sq sq2sq        = { .size = 0, .rows = NULL, .dest = NULL, .taps = NULL };
+u32      sq2sq_mode_i = 0;
+float    sq2sq_scale  = 0.0f;
+float    sq2sq_radius = 0.0f;
+uPoint2d sq2sq_res    = { .x = 0, .y = 0 };
+u32      sq2sq_stride = 0;
+
+HModProf hmod_prof = { .freq = 0, .active = false, .frames = 0 };
+
+HModDelta hmod_delta = { .enabled = false, .dest = NULL };
+
+Hexroi hmod_roi = { .size = 0, .n = 0, .capacity = 0, .ranges = NULL };
+
+HModConv hmod_conv = { .filter = HMOD_CONV_NONE, .conv = { .size = 0 }, .lattice = NULL };
+
+const char* const NexysVideoHDMIHMod_stages[HMOD_STAGES] = {
+	"invalidate", "sq2hex", "conv", "hex2sq", "flush", "total" };
+
+const char* const NexysVideoHDMIHMod_filters[HMOD_CONV_FILTERS] = {
+	"none", "gauss", "gauss49", "laplace", "sobel" };
 
 
 // Vorberechnungen
 
-void NexysVideoHDMIHMod_init(u32 width_d, u32 height_d,
+const char* const NexysVideoHDMIHMod_build_phases[HMOD_BUILD_PHASES] = {
+	"idle", "coordinates", "spatials", "relationships", "hex. FBs", "ready", "retire" };
+
+static void NexysVideoHDMIHMod_build_setup(HModBuild* b, u32 width_d, u32 height_d,
  u32 order, float scale, float radius) {
-	const unsigned int size  = pow(7, order);
-	const unsigned int size7 = size * 7;
+	memset(&b->tables, 0, sizeof(b->tables));
+
+	b->width_d  = width_d;
+	b->height_d = height_d;
+	b->order    = order;
+	b->scale    = scale;
+	b->radius   = radius;
+	b->verbose  = false;
+	b->size     = pow(7, order);
+	b->next     = 0;
+	b->phase    = HMOD_BUILD_COORDS;
+}
+
+static void NexysVideoHDMIHMod_build_next(HModBuild* b, HModBuildPhase phase) {
+	static const char* const headers[HMOD_BUILD_PHASES] = {
+		[HMOD_BUILD_LATTICE]  = "\n\rOK\n\r\n\r[2/3] Relationships:\n\r",
+		[HMOD_BUILD_HEXARRAY] = "\n\rOK\n\r\n\r[3/3] Hex. FBs:\n\r" };
+
+	if(b->verbose && headers[phase])
+		xil_printf(headers[phase]);
+
+	b->next = 0;
+	// HMOD_BUILD_READY erst nach den Tabellen sichtbar machen
+	atomic_store_explicit(&b->phase, phase, memory_order_release);
+}
+
+// hoechstens units Eintraege; true: Phase HMOD_BUILD_READY bzw.
+// HMOD_BUILD_IDLE (nach HMOD_BUILD_RETIRE) erreicht
+static bool NexysVideoHDMIHMod_build_step(HModBuild* b, u32 units) {
+	HModTables*        t    = &b->tables;
+	const unsigned int size = b->size;
 
-	Hexint   hi;
 	fPoint2d pr;
 	fPoint2d ps;
 
+	for(u32 n = 0; n < units; n++) {
+		const u32 i = b->next++;
+
+		switch(b->phase) {
+		case HMOD_BUILD_COORDS:
+			if(!i) {
+				t->reals    = (float*)  malloc(2 * size * sizeof(float));
+				t->reals_q  = (int16_t*)malloc(2 * size  * sizeof(int16_t));
+				t->spatials = (int16_t*)malloc(2 * size  * sizeof(int16_t));
+			}
+
+			if(i == size) {
+				NexysVideoHDMIHMod_build_next(b, HMOD_BUILD_SPATIALS);
+				break;
+			}
+
+			if(b->verbose && !(i % 1000))
+				xil_printf(".");
 
-	xil_printf("\n\r\n\r\n\r[1/4] Coordinates:\n\r");
+			{
+				const Hexint hi = Hexint_init(i, 0);
 
-	pc_reals    = (float*)malloc(2 * size7 * sizeof(float));
-	pc_spatials = (float*)malloc(2 * size  * sizeof(float));
+				pr = getReal(hi);
+				ps = getSpatial(hi);
+			}
 
-	for(unsigned int i = 0; i < size7; i++) {
-		if(!(i % 1000))
-			xil_printf(".");
+			t->reals[2 * i]       = pr.x;
+			t->reals[2 * i + 1]   = pr.y;
+			t->reals_q[2 * i]     = (int16_t)roundf(pr.x * (1 << PC_REALS_Q));
+			t->reals_q[2 * i + 1] = (int16_t)roundf(pr.y * (1 << PC_REALS_Q));
 
+			if(pr.x < t->reals_min.x) {
+				t->reals_min.x = (int)roundf(pr.x);
+			} else if(pr.x > t->reals_max.x) {
+				t->reals_max.x = (int)roundf(pr.x);
+			}
+			if(pr.y < t->reals_min.y) {
+				t->reals_min.y = (int)roundf(pr.y);
+			} else if(pr.y > t->reals_max.y) {
+				t->reals_max.y = (int)roundf(pr.y);
+			}
 
-		hi = Hexint_init(i, 0);
+			if(ps.x < t->spatials_min.x) {
+				t->spatials_min.x = (int)ps.x;
+			} else if(ps.x > t->spatials_max.x) {
+				t->spatials_max.x = (int)ps.x;
+			}
+			if(ps.y < t->spatials_min.y) {
+				t->spatials_min.y = (int)ps.y;
+			} else if(ps.y > t->spatials_max.y) {
+				t->spatials_max.y = (int)ps.y;
+			}
+			break;
 
-		pr = getReal(hi);
-		ps = getSpatial(hi);
+		case HMOD_BUILD_SPATIALS:
+			if(i == size) {
+				// unabhaengig von scale
+				Hexsamp_lattice_dims(t->reals_min, t->reals_max, &t->lattice_min, &t->lattice_dims);
 
-		pc_reals[2 * i]     = pr.x;
-		pc_reals[2 * i + 1] = pr.y;
+				t->lattice = (unsigned int*)malloc(t->lattice_dims.x * t->lattice_dims.y * sizeof(unsigned int));
 
-		if(i < size) {
-			if(pr.x < pc_reals_min.x) {
-				pc_reals_min.x = (int)roundf(pr.x);
-			} else if(pr.x > pc_reals_max.x) {
-				pc_reals_max.x = (int)roundf(pr.x);
+				NexysVideoHDMIHMod_build_next(b, HMOD_BUILD_LATTICE);
+				break;
 			}
-			if(pr.y < pc_reals_min.y) {
-				pc_reals_min.y = (int)roundf(pr.y);
-			} else if(pr.y > pc_reals_max.y) {
-				pc_reals_max.y = (int)roundf(pr.y);
+
+			if(b->verbose && !(i % 1000))
+				xil_printf(".");
+
+			ps = getSpatial(Hexint_init(i, 0));
+
+			if(ps.y > 1.0f) {
+				ps.x -= roundf((ps.y - 1) / 2);
+			} else if(ps.y < 0.0f) {
+				ps.x -= roundf(ps.y / 2);
 			}
 
-			if(ps.x < pc_spatials_min.x) {
-				pc_spatials_min.x = (int)ps.x;
-			} else if(ps.x > pc_spatials_max.x) {
-				pc_spatials_max.x = (int)ps.x;
+			ps.x -= t->spatials_min.x;
+			ps.y  = t->spatials_max.y - ps.y;
+
+			// ganzzahlig
+			t->spatials[2 * i]     = (int16_t)roundf(ps.x);
+			t->spatials[2 * i + 1] = (int16_t)roundf(ps.y);
+			break;
+
+		// erst alle Gitterpunkte leer, dann je Hex-Pixel
+		case HMOD_BUILD_LATTICE: {
+			const u32 cells = t->lattice_dims.x * t->lattice_dims.y;
+
+			if(i == cells + size) {
+				t->hexarray.size = size;
+				t->hexarray.p    = (u8**)malloc(size * sizeof(u8*));
+
+				NexysVideoHDMIHMod_build_next(b, HMOD_BUILD_HEXARRAY);
+				break;
 			}
-			if(ps.y < pc_spatials_min.y) {
-				pc_spatials_min.y = (int)ps.y;
-			} else if(ps.y > pc_spatials_max.y) {
-				pc_spatials_max.y = (int)ps.y;
+
+			if(b->verbose && !(i % 1000))
+				xil_printf(".");
+
+			if(i < cells) {
+				t->lattice[i] = size;
+			} else {
+				const fPoint2d pr = { .x = t->reals[2 * (i - cells)], .y = t->reals[2 * (i - cells) + 1] };
+
+				t->lattice[Hexsamp_lattice_index(pr, t->lattice_min, t->lattice_dims)] = i - cells;
 			}
+			break;
 		}
+
+		// wie Hexarray_init
+		case HMOD_BUILD_HEXARRAY:
+			if(i == size) {
+				NexysVideoHDMIHMod_build_next(b, HMOD_BUILD_READY);
+				return true;
+			}
+
+			t->hexarray.p[i] = (u8*)calloc(3, sizeof(u8));
+			break;
+
+		// die Pixel von hexarray, dann alle Tabellen
+		case HMOD_BUILD_RETIRE: {
+			const u32 pix = t->hexarray.p ? t->hexarray.size : 0;
+
+			if(i < pix) {
+				free(t->hexarray.p[i]);
+			} else {
+				free(t->reals);
+				free(t->reals_q);
+				free(t->spatials);
+				free(t->lattice);
+				free(t->order);
+				free(t->scatter);
+				free(t->hexarray.p);
+
+				Hexsamp_sq2sq_free(&t->sq2sq);
+
+				memset(t, 0, sizeof(*t));
+
+				NexysVideoHDMIHMod_build_next(b, HMOD_BUILD_IDLE);
+				return true;
+			}
+			break;
+		}
+
+		default:
+			b->next--;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+// mit den Tabellen als aktuelle: Hex-Pixel in Quellbild-Reihenfolge
+static void NexysVideoHDMIHMod_build_finish(const HModBuild* b) {
+	if(HMOD_SQ2HEX_BAND)
+		Hexsamp_sq2hex_order(b->size, 1 / b->scale, HMOD_SQ2HEX_BAND);
+
+	Hexsamp_sq2hex_split(b->size, b->width_d, b->height_d, 1 / b->scale);
+}
+
+void NexysVideoHDMIHMod_init(u32 width_d, u32 height_d,
+ u32 order, float scale, float radius) {
+	HModBuild build;
+
+	NexysVideoHDMIHMod_build_setup(&build, width_d, height_d, order, scale, radius);
+
+	build.verbose = true;
+	xil_printf("\n\r\n\r\n\r[1/3] Coordinates:\n\r");
+
+	while(!NexysVideoHDMIHMod_build_step(&build, HMOD_BUILD_ALL));
+
+	NexysVideoHDMIHMod_tables_load(&build.tables);
+	NexysVideoHDMIHMod_build_finish(&build);
+
+	xil_printf("OK");
+	sleep(1);
+}
+
+void NexysVideoHDMIHMod_free() {
+	HModBuild retire = { .phase = HMOD_BUILD_RETIRE, .next = 0 };
+
+	NexysVideoHDMIHMod_tables_store(&retire.tables);
+
+	while(!NexysVideoHDMIHMod_build_step(&retire, HMOD_BUILD_ALL));
+
+	Hexsamp_banks_free();
+	Hexsamp_delta_free(&hmod_delta.delta);
+	Hexroi_free(&hmod_roi);
+	Hexconv_free(&hmod_conv.conv);
+
+	hmod_delta.dest   = NULL;
+	hmod_delta.prev   = NULL;
+	hmod_conv.lattice = NULL;
+}
+
+
+#if HMOD_BUILD_THREAD
+static void* NexysVideoHDMIHMod_build_thread(void* arg) {
+	while(!NexysVideoHDMIHMod_build_step((HModBuild*)arg, HMOD_BUILD_ALL));
+
+	return NULL;
+}
+
+static void NexysVideoHDMIHMod_build_run(HModBuild* b) {
+	b->running = !pthread_create(&b->thread, NULL, NexysVideoHDMIHMod_build_thread, b);
+}
+
+static void NexysVideoHDMIHMod_build_join(HModBuild* b) {
+	if(b->running)
+		pthread_join(b->thread, NULL);
+
+	b->running = false;
+}
+#else
+static void NexysVideoHDMIHMod_build_run(HModBuild* b) {
+	(void)b;
+}
+
+static void NexysVideoHDMIHMod_build_join(HModBuild* b) {
+	(void)b;
+}
+#endif
+
+void NexysVideoHDMIHMod_build_start(HModBuild* build, u32 width_d, u32 height_d,
+ u32 order, float scale, float radius) {
+	NexysVideoHDMIHMod_build_cancel(build);
+
+	NexysVideoHDMIHMod_build_setup(build, width_d, height_d, order, scale, radius);
+	NexysVideoHDMIHMod_build_run(build);
+}
+
+HModBuildPhase NexysVideoHDMIHMod_build_poll(HModBuild* build, u32 units) {
+#if HMOD_BUILD_THREAD
+	const HModBuildPhase phase = atomic_load_explicit(&build->phase, memory_order_acquire);
+
+	(void)units;
+
+	// Thread fertig: HMOD_BUILD_READY bzw. HMOD_BUILD_IDLE
+	if(build->running && (phase == HMOD_BUILD_READY || phase == HMOD_BUILD_IDLE))
+		NexysVideoHDMIHMod_build_join(build);
+#else
+	if(build->phase != HMOD_BUILD_IDLE && build->phase != HMOD_BUILD_READY)
+		NexysVideoHDMIHMod_build_step(build, units);
+#endif
+
+	return build->phase;
+}
+
+void NexysVideoHDMIHMod_build_commit(HModBuild* build) {
+	HModTables old;
+
+	NexysVideoHDMIHMod_build_join(build);
+
+	NexysVideoHDMIHMod_tables_store(&old);
+	NexysVideoHDMIHMod_tables_load(&build->tables);
+	NexysVideoHDMIHMod_build_finish(build);
+
+	build->tables = old;
+
+	NexysVideoHDMIHMod_build_next(build, HMOD_BUILD_RETIRE);
+	NexysVideoHDMIHMod_build_run(build);
+}
+
+void NexysVideoHDMIHMod_build_cancel(HModBuild* build) {
+	NexysVideoHDMIHMod_build_join(build);
+
+	while(!NexysVideoHDMIHMod_build_step(build, HMOD_BUILD_ALL));
+
+	if(atomic_load_explicit(&build->phase, memory_order_acquire) == HMOD_BUILD_READY) {
+		NexysVideoHDMIHMod_build_next(build, HMOD_BUILD_RETIRE);
+
+		while(!NexysVideoHDMIHMod_build_step(build, HMOD_BUILD_ALL));
+	}
+}
+void NexysVideoHDMIHMod_tables_store(HModTables* tables) {
+	tables->reals          = pc_reals;
+	tables->reals_q        = pc_reals_q;
+	tables->reals_min      = pc_reals_min;
+	tables->reals_max      = pc_reals_max;
+	tables->spatials       = pc_spatials;
+	tables->spatials_min   = pc_spatials_min;
+	tables->spatials_max   = pc_spatials_max;
+	tables->lattice        = pc_lattice;
+	tables->lattice_min    = pc_lattice_min;
+	tables->lattice_dims   = pc_lattice_dims;
+	tables->order          = pc_order;
+	tables->order_interior = pc_order_interior;
+	tables->order_dims     = pc_order_dims;
+	tables->order_scale    = pc_order_scale;
+
+	tables->hexarray = hexarray;
+
+	tables->scatter        = pc_scatter;
+	tables->scatter_size   = pc_scatter_size;
+	tables->scatter_res    = pc_scatter_res;
+	tables->scatter_stride = pc_scatter_stride;
+	tables->scatter_range  = pc_scatter_range;
+
+	tables->sq2sq        = sq2sq;
+	tables->sq2sq_mode_i = sq2sq_mode_i;
+	tables->sq2sq_scale  = sq2sq_scale;
+	tables->sq2sq_radius = sq2sq_radius;
+	tables->sq2sq_res    = sq2sq_res;
+	tables->sq2sq_stride = sq2sq_stride;
+
+
+	// leer wie vor dem ersten _init
+	pc_reals          = NULL;
+	pc_reals_q        = NULL;
+	pc_spatials       = NULL;
+	pc_lattice        = NULL;
+	pc_lattice_dims.x = pc_lattice_dims.y = 0;
+	pc_order          = NULL;
+	pc_order_interior = 0;
+	pc_order_dims.x   = pc_order_dims.y = 0;
+	pc_order_scale    = 0.0f;
+
+	hexarray.p    = NULL;
+	hexarray.size = 0;
+
+	pc_scatter            = NULL;
+	pc_scatter_size       = 0;
+	pc_scatter_res.x      = pc_scatter_res.y = 0;
+	pc_scatter_stride     = 0;
+	pc_scatter_range.rows = 0;
+
+	sq2sq.rows  = sq2sq.dest = NULL;
+	sq2sq.taps  = NULL;
+	sq2sq.size  = 0;
+	sq2sq_res.x = sq2sq_res.y = 0;
+}
+
+void NexysVideoHDMIHMod_tables_load(const HModTables* tables) {
+	pc_reals          = tables->reals;
+	pc_reals_q        = tables->reals_q;
+	pc_reals_min      = tables->reals_min;
+	pc_reals_max      = tables->reals_max;
+	pc_spatials       = tables->spatials;
+	pc_spatials_min   = tables->spatials_min;
+	pc_spatials_max   = tables->spatials_max;
+	pc_lattice        = tables->lattice;
+	pc_lattice_min    = tables->lattice_min;
+	pc_lattice_dims   = tables->lattice_dims;
+	pc_order          = tables->order;
+	pc_order_interior = tables->order_interior;
+	pc_order_dims     = tables->order_dims;
+	pc_order_scale    = tables->order_scale;
+
+	hexarray = tables->hexarray;
+
+	pc_scatter        = tables->scatter;
+	pc_scatter_size   = tables->scatter_size;
+	pc_scatter_res    = tables->scatter_res;
+	pc_scatter_stride = tables->scatter_stride;
+	pc_scatter_range  = tables->scatter_range;
+
+	sq2sq        = tables->sq2sq;
+	sq2sq_mode_i = tables->sq2sq_mode_i;
+	sq2sq_scale  = tables->sq2sq_scale;
+	sq2sq_radius = tables->sq2sq_radius;
+	sq2sq_res    = tables->sq2sq_res;
+	sq2sq_stride = tables->sq2sq_stride;
+
+	// anderes Hexarray (ggf. an derselben Adresse): naechstes Bild vollstaendig
+	hmod_delta.delta.hex = NULL;
+}
+
+// Pixelrechteck [x_begin, x_end) x [y_begin, y_end) in destFrame
+static HModRange NexysVideoHDMIHMod_range(u32 stride,
+ int x_begin, int y_begin, int x_end, int y_end) {
+	HModRange range = { .begin = 0, .width = 0, .rows = 0, .stride = stride };
+
+	if(x_end > x_begin && y_end > y_begin) {
+		range.begin = y_begin * stride + 3 * x_begin;
+		range.width = 3 * (x_end - x_begin);
+		range.rows  = y_end - y_begin;
 	}
 
-	for(unsigned int i = 0; i < size; i++) {
-		if(!(i % 1000))
-			xil_printf(".");
+	return range;
+}
+
+// Hexsamp_hex2sq_clip bzw. Hexsamp_sq2sq: sichtbarer Ausschnitt des bei
+// offset zentrierten Bildes der Groesse size_hex
+static HModRange NexysVideoHDMIHMod_clip_range(u32 stride, u32 width_d, u32 height_d,
+ iPoint2d offset, uPoint2d size_hex) {
+	const int x_begin = offset.x < 0 ? 0 : offset.x;
+	const int y_begin = offset.y < 0 ? 0 : offset.y;
+	const int x_end   = offset.x + (int)size_hex.x < (int)width_d  ? offset.x + (int)size_hex.x : (int)width_d;
+	const int y_end   = offset.y + (int)size_hex.y < (int)height_d ? offset.y + (int)size_hex.y : (int)height_d;
 
+	return NexysVideoHDMIHMod_range(stride, x_begin, y_begin, x_end, y_end);
+}
+
+// range von src nach destFrame (gleicher stride)
+static void NexysVideoHDMIHMod_copy(u8* destFrame, const u8* src, HModRange range) {
+	for(u32 r = 0; r < range.rows; r++)
+		memcpy(destFrame + range.begin + r * range.stride, src + range.begin + r * range.stride, range.width);
+}
 
-		ps = getSpatial(Hexint_init(i, 0));
+// width_d x height_d ab destFrame ausser keep loeschen
+static void NexysVideoHDMIHMod_clear(u8* destFrame, HModRange keep,
+ u32 stride, u32 width_d, u32 height_d) {
+	const u32 keep_y = keep.rows ? keep.begin / stride : 0;
+	const u32 keep_x = keep.rows ? keep.begin % stride : 0;
 
-		if(ps.y > 1.0f) {
-			ps.x -= roundf((ps.y - 1) / 2);
-		} else if(ps.y < 0.0f) {
-			ps.x -= roundf(ps.y / 2);
+	for(u32 y = 0; y < height_d; y++) {
+		u8* p = destFrame + y * stride;
+
+		if(y >= keep_y && y < keep_y + keep.rows) {
+			memset(p, 0, keep_x);
+			memset(p + keep_x + keep.width, 0, 3 * width_d - keep_x - keep.width);
+		} else {
+			memset(p, 0, 3 * width_d);
 		}
+	}
+}
+
+// Neuberechnung nur bei geaenderter Aufloesung (width_d, height_d, stride)
+void NexysVideoHDMIHMod_scatter_init(u32 stride, u32 width_d, u32 height_d) {
+	const int width_base  = (int)roundf(((int)width_d  - (pc_spatials_max.x - pc_spatials_min.x)) / 2);
+	const int height_base = (int)roundf(((int)height_d - (pc_spatials_max.y - pc_spatials_min.y)) / 2);
+
+	if(!pc_scatter)
+		pc_scatter = (u32*)malloc(2 * hexarray.size * sizeof(u32));
+
+	iPoint2d min = { .x = width_d, .y = height_d };
+	iPoint2d max = { .x = -1,      .y = -1       };
+
+	pc_scatter_size = 0;
+
+	for(unsigned int i = 0; i < hexarray.size; i++) {
+		const int w = width_base  + pc_spatials[2 * i];
+		const int h = height_base + pc_spatials[2 * i + 1];
+
+		if(w >= 0 && h >= 0 && w < width_d && h < height_d) {
+			pc_scatter[2 * pc_scatter_size]     = i;
+			pc_scatter[2 * pc_scatter_size + 1] = h * stride + 3 * w;
 
-		ps.x -= pc_spatials_min.x;
-		ps.y  = pc_spatials_max.y - ps.y;
+			if(w < min.x) min.x = w;
+			if(h < min.y) min.y = h;
+			if(w > max.x) max.x = w;
+			if(h > max.y) max.y = h;
 
-		pc_spatials[2 * i]     = ps.x;
-		pc_spatials[2 * i + 1] = ps.y;
+			pc_scatter_size++;
+		}
 	}
 
-	xil_printf("\n\rOK");
+	pc_scatter_range  = NexysVideoHDMIHMod_range(stride, min.x, min.y, max.x + 1, max.y + 1);
+	pc_scatter_res.x  = width_d;
+	pc_scatter_res.y  = height_d;
+	pc_scatter_stride = stride;
+}
 
 
-	const uPoint2d size_out = {
+// Ausgabegroesse Hexsamp_hex2sq, folgt scale ohne Neuberechnung
+static uPoint2d NexysVideoHDMIHMod_size_hex(float scale) {
+	const uPoint2d size_hex = {
 		.x = (unsigned int)roundf((pc_reals_max.x - pc_reals_min.x) / scale) + 1,
 		.y = (unsigned int)roundf((pc_reals_max.y - pc_reals_min.y) / scale) + 1 };
 
-	xil_printf("\n\r\n\r[2/4] Relationships:\n\r");
+	return size_hex;
+}
+
+// zentriert, nur sichtbare Pixel
+static iPoint2d NexysVideoHDMIHMod_offset(u32 width_d, u32 height_d, uPoint2d size_hex) {
+	const iPoint2d offset = {
+		.x = ((int)width_d  - (int)size_hex.x) / 2,
+		.y = ((int)height_d - (int)size_hex.y) / 2 };
 
-	pc_nearest = (unsigned int**)malloc(size_out.x * sizeof(unsigned int*));
+	return offset;
+}
 
-	for(unsigned int i = 0; i < size_out.x; i++) {
-		xil_printf(".");
+// Interior (Hexsamp_sq2hex_split) haengt an scale und Aufloesung, O(Hex-Pixel)
+static void NexysVideoHDMIHMod_split(u32 width_d, u32 height_d, float scale) {
+	if(pc_order && (1 / scale != pc_order_scale || width_d != pc_order_dims.x || height_d != pc_order_dims.y))
+		Hexsamp_sq2hex_split(hexarray.size, width_d, height_d, 1 / scale);
+}
 
+void NexysVideoHDMIHMod_sq2hex(u8* srcFrame, Hexarray* hex,
+ u32 stride, u32 width_d, u32 height_d, u32 order, float scale, u32 mode_i) {
+	const pArray2d array = { .p = srcFrame, .x = width_d, .y = height_d, .stride = stride };
 
-		pc_nearest[i] = (unsigned int*)malloc(size_out.y * sizeof(unsigned int));
+	NexysVideoHDMIHMod_split(width_d, height_d, scale);
 
-		for(unsigned int j = 0; j < size_out.y; j++) {
-			pc_nearest[i][j] = getInt(Hexint_init(getNearest(pc_reals_min.x + i * scale, \
-				pc_reals_min.y + j * scale).value, 1));
+	Hexsamp_sq2hex(array, hex, order, 1 / scale, mode_i);
+}
+
+const Hexroi* NexysVideoHDMIHMod_sq2hex_roi(u8* srcFrame, Hexarray* hex,
+ u32 stride, u32 width_d, u32 height_d, u32 order, float scale, u32 mode_i,
+ iPoint2d min, iPoint2d max) {
+	const pArray2d array = { .p = srcFrame, .x = width_d, .y = height_d, .stride = stride };
+
+	if(hmod_roi.size != hex->size || hmod_roi.res.x != width_d || hmod_roi.res.y != height_d ||
+	   hmod_roi.scale != 1 / scale || hmod_roi.min.x != min.x || hmod_roi.min.y != min.y ||
+	   hmod_roi.max.x != max.x || hmod_roi.max.y != max.y) {
+		const uPoint2d res = { .x = width_d, .y = height_d };
+
+		Hexroi_init(&hmod_roi, order, res, 1 / scale, min, max);
+	}
+
+	Hexsamp_sq2hex_roi(array, hex, &hmod_roi, mode_i);
+
+	return &hmod_roi;
+}
+
+HModRange NexysVideoHDMIHMod_hex2sq(Hexarray hex, u8* destFrame,
+ u32 stride, u32 width_d, u32 height_d, float scale, float radius, u32 mode_i, u32 mode_d) {
+	if(!mode_d) {
+		if(width_d != pc_scatter_res.x || height_d != pc_scatter_res.y || stride != pc_scatter_stride)
+			NexysVideoHDMIHMod_scatter_init(stride, width_d, height_d);
+
+		for(unsigned int j = 0; j < pc_scatter_size; j++) {
+			const u8* hp = hex.p[pc_scatter[2 * j]];
+			      u8* p  = destFrame + pc_scatter[2 * j + 1];
+
+			p[0] = hp[0]; // Y
+			p[1] = hp[1]; // Cb
+			p[2] = hp[2]; // Cr
 		}
+
+		return pc_scatter_range;
 	}
 
-	xil_printf("\n\rOK");
+	pArray2d       dest     = { .p = destFrame, .x = width_d, .y = height_d, .stride = stride };
+	const uPoint2d size_hex = NexysVideoHDMIHMod_size_hex(scale);
+	const iPoint2d offset   = NexysVideoHDMIHMod_offset(width_d, height_d, size_hex);
 
+	// direkt in destFrame
+	Hexsamp_hex2sq_clip(hex, &dest, size_hex, offset, radius, scale, mode_i);
 
-	const unsigned int i_max = radius > 1.0f ? 49 : 7; // TODO?
+	return NexysVideoHDMIHMod_clip_range(stride, width_d, height_d, offset, size_hex);
+}
 
-	xil_printf("\n\r\n\r[3/4] Additions:\n\r");
+// Inkrementell
+
+void NexysVideoHDMIHMod_delta_init(bool enabled) {
+	hmod_delta.enabled   = enabled;
+	hmod_delta.delta.hex = NULL;
+	hmod_delta.dest      = NULL;
+	hmod_delta.prev      = NULL;
+	hmod_delta.frames    = 0;
+	hmod_delta.sampled   = 0;
+	hmod_delta.changes   = 0;
+	hmod_delta.hex       = 0;
+	hmod_delta.rendered  = 0;
+	hmod_delta.pixels    = 0;
+
+	if(!enabled) {
+		free(hmod_delta.buf);
+
+		hmod_delta.buf      = NULL;
+		hmod_delta.buf_size = 0;
+	}
+}
+
+void NexysVideoHDMIHMod_conv_init(u32 filter) {
+	hmod_conv.filter = filter < HMOD_CONV_FILTERS ? filter : HMOD_CONV_NONE;
+	hmod_conv.frames = 0;
+
+	switch(hmod_conv.filter) {
+		case HMOD_CONV_GAUSS:   Hexkernel_gauss(&hmod_conv.kernel, 7, 1.0f);           break;
+		case HMOD_CONV_GAUSS49: Hexkernel_gauss(&hmod_conv.kernel, 49, 1.5f);          break;
+		case HMOD_CONV_LAPLACE: Hexkernel_laplace(&hmod_conv.kernel, 7, 4.0f);         break;
+		case HMOD_CONV_SOBEL:   Hexkernel_gradient(&hmod_conv.kernel, 49, 0.0f, 4.0f); break;
+		default:                                                                       break;
+	}
+}
 
-	pc_adds = (unsigned int**)malloc(size7 * sizeof(unsigned int*));
+#if HMOD_CONV_THREADS > 1
+typedef struct { Hexarray* hex; u32 begin; u32 end; bool pack; } HModConvPart;
 
-	for(unsigned int i = 0; i < size7; i++) {
-		if(!(i % 1000))
-			xil_printf(".");
+static void* NexysVideoHDMIHMod_conv_thread(void* arg) {
+	const HModConvPart* part = (const HModConvPart*)arg;
 
+	if(part->pack)
+		Hexconv_pack(&hmod_conv.conv, *part->hex, part->begin, part->end);
+	else
+		Hexconv_rows(&hmod_conv.conv, &hmod_conv.kernel, part->hex, part->begin, part->end);
 
-		const Hexint base = Hexint_init(i, 0);
+	return NULL;
+}
+#endif
+
+// zwei Runden (erst grid vollstaendig, dann filtern), je Runde die
+// Gitterzeilen in HMOD_CONV_THREADS Teilen; Teil 0 im Aufrufer
+void NexysVideoHDMIHMod_conv(Hexarray* hex) {
+	if(!hmod_conv.filter)
+		return;
 
-		pc_adds[i] = (unsigned int*)malloc(i_max * sizeof(unsigned int));
+	if(hmod_conv.conv.size != hex->size || hmod_conv.conv.taps != hmod_conv.kernel.taps ||
+	   hmod_conv.lattice != pc_lattice || hmod_conv.conv.dims.x != pc_lattice_dims.x ||
+	   hmod_conv.conv.dims.y != pc_lattice_dims.y) {
+		Hexconv_free(&hmod_conv.conv);
+		Hexconv_init(&hmod_conv.conv, hex->size, hmod_conv.kernel.taps);
 
-		for(unsigned int j = 0; j < i_max; j++)
-			pc_adds[i][j] = getInt(add(base, Hexint_init(j, 0)));
+		hmod_conv.lattice = pc_lattice;
 	}
 
-	xil_printf("\n\rOK");
+#if HMOD_CONV_THREADS > 1
+	const u32    rows = hmod_conv.conv.dims.x;
+	HModConvPart part[HMOD_CONV_THREADS];
+	pthread_t    thread[HMOD_CONV_THREADS];
+	bool         running[HMOD_CONV_THREADS];
 
+	for(u32 pass = 0; pass < 2; pass++) {
+		for(u32 t = 0; t < HMOD_CONV_THREADS; t++) {
+			part[t].hex   = hex;
+			part[t].begin = rows * t / HMOD_CONV_THREADS;
+			part[t].end   = rows * (t + 1) / HMOD_CONV_THREADS;
+			part[t].pack  = !pass;
 
-	xil_printf("\n\r\n\r[4/4] Hex. FBs:\n\r");
+			running[t] = t && !pthread_create(&thread[t], NULL, NexysVideoHDMIHMod_conv_thread, &part[t]);
 
-	pArray2d_init(&array, width_d, height_d);
-	Hexarray_init(&hexarray, order);
-	pArray2d_init(&array_hex, size_out.x, size_out.y);
+			// ohne Thread im Aufrufer
+			if(t && !running[t])
+				NexysVideoHDMIHMod_conv_thread(&part[t]);
+		}
 
-	xil_printf("OK");
-	sleep(1);
+		NexysVideoHDMIHMod_conv_thread(&part[0]);
+
+		for(u32 t = 1; t < HMOD_CONV_THREADS; t++)
+			if(running[t])
+				pthread_join(thread[t], NULL);
+	}
+#else
+	Hexconv_apply(&hmod_conv.conv, &hmod_conv.kernel, *hex, hex);
+#endif
+
+	hmod_conv.frames++;
 }
 
-void NexysVideoHDMIHMod_free() {
-	free(pc_reals);
+// eigener Ergebnispuffer, neu (leer) bei anderer Groesse
+static u8* NexysVideoHDMIHMod_delta_buf(u32 stride, u32 height_d) {
+	const size_t size = (size_t)stride * height_d;
 
-	free(pc_spatials);
+	if(size != hmod_delta.buf_size) {
+		free(hmod_delta.buf);
 
-	for(unsigned int i = 0; i < SIZEOF_ARRAY(pc_nearest); i++) {
-		free(pc_nearest[i]);
+		hmod_delta.buf      = (u8*)calloc(size, 1);
+		hmod_delta.buf_size = size;
+		hmod_delta.dest     = NULL;
 	}
-	free(pc_nearest);
 
-	for(unsigned int i = 0; i < SIZEOF_ARRAY(pc_adds);    i++) {
-		free(pc_adds[i]);
+	return hmod_delta.buf;
+}
+
+// destFrame enthaelt das Ergebnis des vorherigen Bilds mit denselben
+// Ausgabeparametern, Hex-Pixel bis auf delta.changed unveraendert
+static bool NexysVideoHDMIHMod_delta_valid(u8* destFrame,
+ u32 stride, u32 width_d, u32 height_d, float radius, u32 mode_d) {
+	return !hmod_delta.delta.full && destFrame == hmod_delta.dest && mode_d == hmod_delta.mode_d &&
+		radius == hmod_delta.radius && width_d == hmod_delta.res.x && height_d == hmod_delta.res.y &&
+		stride == hmod_delta.stride;
+}
+
+// wie NexysVideoHDMIHMod_hex2sq, nur in Reichweite geaenderter Hex-Pixel;
+// Rueckgabe: Rechteck der berechneten Pixel
+static HModRange NexysVideoHDMIHMod_hex2sq_delta(u8* destFrame,
+ u32 stride, u32 width_d, u32 height_d, float scale, float radius, u32 mode_i, u32 mode_d) {
+	const u8* changed = hmod_delta.delta.changed;
+	iPoint2d  min     = { .x = width_d, .y = height_d };
+	iPoint2d  max     = { .x = 0,       .y = 0        };
+
+	if(!mode_d) {
+		for(unsigned int j = 0; j < pc_scatter_size; j++) {
+			if(changed[pc_scatter[2 * j]] != 1)
+				continue;
+
+			const u8* hp = hexarray.p[pc_scatter[2 * j]];
+			      u8* p  = destFrame + pc_scatter[2 * j + 1];
+			const int x  = pc_scatter[2 * j + 1] % stride / 3;
+			const int y  = pc_scatter[2 * j + 1] / stride;
+
+			p[0] = hp[0]; // Y
+			p[1] = hp[1]; // Cb
+			p[2] = hp[2]; // Cr
+
+			if(x < min.x)     min.x = x;
+			if(y < min.y)     min.y = y;
+			if(x + 1 > max.x) max.x = x + 1;
+			if(y + 1 > max.y) max.y = y + 1;
+
+			hmod_delta.rendered++;
+		}
+	} else {
+		pArray2d       dest     = { .p = destFrame, .x = width_d, .y = height_d, .stride = stride };
+		const uPoint2d size_hex = NexysVideoHDMIHMod_size_hex(scale);
+		const iPoint2d offset   = NexysVideoHDMIHMod_offset(width_d, height_d, size_hex);
+
+		hmod_delta.rendered += Hexsamp_hex2sq_delta(hexarray, &dest, size_hex, offset,
+			&hmod_delta.delta, radius, scale, mode_i, &min, &max);
 	}
-	free(pc_adds);
 
+	return NexysVideoHDMIHMod_range(stride, min.x, min.y, max.x, max.y);
+}
 
-	pArray2d_free(&array);
-	Hexarray_free(&hexarray);
-	pArray2d_free(&array_hex);
+// Bezug fuer das naechste Bild (target: beschriebener Puffer) und Statistik;
+// pixels: sichtbare Ausgabepixel
+static void NexysVideoHDMIHMod_delta_frame(u8* target, u8* destFrame,
+ u32 stride, u32 width_d, u32 height_d, float radius, u32 mode_d, u64 pixels, bool rendered_all) {
+	hmod_delta.dest   = target;
+	hmod_delta.prev   = destFrame;
+	hmod_delta.mode_d = mode_d;
+	hmod_delta.radius = radius;
+	hmod_delta.res.x  = width_d;
+	hmod_delta.res.y  = height_d;
+	hmod_delta.stride = stride;
+
+	hmod_delta.frames++;
+	hmod_delta.sampled += hmod_delta.delta.sampled;
+	hmod_delta.changes += hmod_delta.delta.changes;
+	hmod_delta.hex     += hexarray.size;
+	hmod_delta.pixels  += pixels;
+
+	if(rendered_all)
+		hmod_delta.rendered += pixels;
 }
 
 
-void NexysVideoHDMIHMod(u8* srcFrame, u8* destFrame,
- u32 width, u32 height, u32 width_d, u32 height_d,
+// mode_d = 2: Neuberechnung bei geaendertem mode_i, scale, radius bzw.
+// geaenderter Aufloesung (width_d, height_d, stride)
+static void NexysVideoHDMIHMod_sq2sq_init(u32 stride, u32 width_d, u32 height_d,
+ float scale, float radius, u32 mode_i) {
+	if(mode_i == sq2sq_mode_i && scale == sq2sq_scale && radius == sq2sq_radius &&
+	   width_d == sq2sq_res.x && height_d == sq2sq_res.y && stride == sq2sq_stride)
+		return;
+
+	// nur Abmessungen, Taps sind Offsets
+	const pArray2d array    = { .p = NULL, .x = width_d, .y = height_d, .stride = stride };
+	const uPoint2d size_hex = NexysVideoHDMIHMod_size_hex(scale);
+
+	Hexsamp_sq2sq_free(&sq2sq);
+	Hexsamp_sq2sq_init(&sq2sq, array, array, hexarray.size, size_hex,
+		NexysVideoHDMIHMod_offset(width_d, height_d, size_hex), radius, 1 / scale, scale, mode_i);
+
+	sq2sq_mode_i = mode_i;
+	sq2sq_scale  = scale;
+	sq2sq_radius = radius;
+	sq2sq_res.x  = width_d;
+	sq2sq_res.y  = height_d;
+	sq2sq_stride = stride;
+}
+
+void NexysVideoHDMIHMod_prepare(u32 stride, u32 width_d, u32 height_d,
+ float scale, float radius, u32 mode_i, u32 mode_d) {
+	if(!mode_d && (width_d != pc_scatter_res.x || height_d != pc_scatter_res.y || stride != pc_scatter_stride))
+		NexysVideoHDMIHMod_scatter_init(stride, width_d, height_d);
+	else if(mode_d == 2)
+		NexysVideoHDMIHMod_sq2sq_init(stride, width_d, height_d, scale, radius, mode_i);
+}
+
+
+HModRange NexysVideoHDMIHMod(u8* srcFrame, u8* destFrame,
+ u32 stride, u32 width_d, u32 height_d,
  u32 order, float scale, float radius, u32 mode_i, u32 mode_d) {
-	// pArray2d_init(&array, width, height);
+	const uPoint2d size_hex = NexysVideoHDMIHMod_size_hex(scale);
+	const iPoint2d offset   = NexysVideoHDMIHMod_offset(width_d, height_d, size_hex);
+
+
+	// in place (srcFrame = destFrame): srcFrame ist nach Hexsamp_sq2hex
+	// vollstaendig gelesen, nicht beschriebene Pixel werden geloescht
+	const bool in_place = srcFrame == destFrame;
+
 
-	int p     = 0;
-	int pd    = 0;
-	int slice = 3 * width_d * sizeof(srcFrame[0]);
+	// ohne Hex-Bild; nicht in place, da srcFrame bis zuletzt gelesen wird
+	if(mode_d == 2 && !in_place) {
+		const pArray2d array = { .p = srcFrame,  .x = width_d, .y = height_d, .stride = stride };
+		      pArray2d dest  = { .p = destFrame, .x = width_d, .y = height_d, .stride = stride };
 
-	for(unsigned int h = 0; h < array.y; h++) {
-		memcpy(array.p + pd, srcFrame + p, slice);
+		NexysVideoHDMIHMod_sq2sq_init(stride, width_d, height_d, scale, radius, mode_i);
 
-		p  += 3 * width;
-		pd += 3 * width_d;
+		Hexsamp_sq2sq(sq2sq, array, &dest);
+
+		HMOD_PROF_MARK(HMOD_STAGE_HEX2SQ);
+
+		return NexysVideoHDMIHMod_clip_range(stride, width_d, height_d, offset, size_hex);
 	}
 
 
-	Hexsamp_sq2hex(array, &hexarray, order, 1 / scale, mode_i);
+	if(hmod_delta.enabled) {
+		const pArray2d array = { .p = srcFrame, .x = width_d, .y = height_d, .stride = stride };
 
+		NexysVideoHDMIHMod_split(width_d, height_d, scale);
 
-	// pArray2d_free(&array);
+		Hexsamp_sq2hex_delta(array, &hexarray, &hmod_delta.delta, 1 / scale, mode_i);
+	} else {
+		NexysVideoHDMIHMod_sq2hex(srcFrame, &hexarray, stride, width_d, height_d, order, scale, mode_i);
+	}
 
+	HMOD_PROF_MARK(HMOD_STAGE_SQ2HEX);
 
-	if(!mode_d) {
-		const int width_base  = (int)roundf(((int)width_d  - (pc_spatials_max.x - pc_spatials_min.x)) / 2);
-		const int height_base = (int)roundf(((int)height_d - (pc_spatials_max.y - pc_spatials_min.y)) / 2);
+	// inkrementell nicht: ein geaendertes Hex-Pixel wirkte auf alle Taps
+	if(hmod_conv.filter && !hmod_delta.enabled)
+		NexysVideoHDMIHMod_conv(&hexarray);
 
-		for(unsigned int i = 0; i < hexarray.size; i++) {
-			const int w = width_base  + (int)pc_spatials[2 * i];
-			const int h = height_base + (int)pc_spatials[2 * i + 1];
+	HMOD_PROF_MARK(HMOD_STAGE_CONV);
 
-			if(w >= 0 && h >= 0 && w < width && h < height) {
-				p = 3 * (h * width + w);
 
-				destFrame[p]     = hexarray.p[i][0]; // Y
-				destFrame[p + 1] = hexarray.p[i][1]; // Cb
-				destFrame[p + 2] = hexarray.p[i][2]; // Cr
+	// inkrementell in den Puffer mit dem vorherigen Ergebnis: destFrame bzw.
+	// bei wechselndem destFrame oder in place der eigene
+	u8* const target = hmod_delta.enabled && (in_place || destFrame != hmod_delta.prev) ?
+		NexysVideoHDMIHMod_delta_buf(stride, height_d) : destFrame;
+
+	const HModRange visible = NexysVideoHDMIHMod_clip_range(stride, width_d, height_d, offset, size_hex);
+
+	// Luecken zwischen den Hex-Pixeln bzw. Rand ausserhalb des Hex-Bilds;
+	// mode_d = 0 aus dem eigenen Puffer ohnehin vollstaendig kopiert
+	if(in_place && (target == destFrame || mode_d))
+		NexysVideoHDMIHMod_blank(destFrame, stride, width_d, height_d, scale, mode_d);
+
+	const bool delta = hmod_delta.enabled &&
+		NexysVideoHDMIHMod_delta_valid(target, stride, width_d, height_d, radius, mode_d);
+
+	// eigener Puffer: Hex-Pixel einer frueheren Konfiguration (mode_d = 0)
+	if(target != destFrame && !delta)
+		NexysVideoHDMIHMod_blank(target, stride, width_d, height_d, scale, mode_d);
+
+	HModRange range = delta ?
+		NexysVideoHDMIHMod_hex2sq_delta(target, stride, width_d, height_d, scale, radius, mode_i, mode_d) :
+		NexysVideoHDMIHMod_hex2sq(hexarray, target, stride, width_d, height_d, scale, radius, mode_i, mode_d);
+
+	if(hmod_delta.enabled)
+		NexysVideoHDMIHMod_delta_frame(target, destFrame, stride, width_d, height_d, radius, mode_d,
+			!mode_d ? pc_scatter_size : (u64)visible.width / 3 * visible.rows, !delta);
+
+	// destFrame enthaelt ein beliebiges frueheres Bild
+	if(target != destFrame) {
+		range = !mode_d ? NexysVideoHDMIHMod_range(stride, 0, 0, width_d, height_d) : visible;
+
+		NexysVideoHDMIHMod_copy(destFrame, target, range);
+	}
+
+	HMOD_PROF_MARK(HMOD_STAGE_HEX2SQ);
+
+
+	// Hexarray_free(&hexarray);
+
+	return in_place ? NexysVideoHDMIHMod_range(stride, 0, 0, width_d, height_d) : range;
+}
+
+void NexysVideoHDMIHMod_blank(u8* destFrame, u32 stride, u32 width_d, u32 height_d,
+ float scale, u32 mode_d) {
+	const uPoint2d size_hex = NexysVideoHDMIHMod_size_hex(scale);
+	const iPoint2d offset   = NexysVideoHDMIHMod_offset(width_d, height_d, size_hex);
+
+	NexysVideoHDMIHMod_clear(destFrame, !mode_d ? NexysVideoHDMIHMod_range(stride, 0, 0, 0, 0) :
+		NexysVideoHDMIHMod_clip_range(stride, width_d, height_d, offset, size_hex), stride, width_d, height_d);
+}
+
+void NexysVideoHDMIHMod_flush(u8* destFrame, HModRange range) {
+	for(u32 r = 0; r < range.rows; r++)
+		Xil_DCacheFlushRange((UINTPTR)(destFrame + range.begin + r * range.stride), range.width);
+}
+
+
+void NexysVideoHDMIHMod_fps_init(HModFps* fps, u64 ticks, u64 freq) {
+	fps->freq          = freq;
+	fps->window_start  = ticks;
+	fps->window_frames = 0;
+	fps->frames        = 0;
+	fps->fps_x100      = 0;
+}
+
+bool NexysVideoHDMIHMod_fps_frame(HModFps* fps, u64 ticks) {
+	const u64 elapsed = ticks - fps->window_start;
+
+	fps->frames++;
+	fps->window_frames++;
+
+	if(elapsed < fps->freq)
+		return false;
+
+	fps->fps_x100      = (u32)((100 * (u64)fps->window_frames * fps->freq + elapsed / 2) / elapsed);
+	fps->window_start  = ticks;
+	fps->window_frames = 0;
+
+	return true;
+}
+
+
+static int NexysVideoHDMIHMod_ring_find(HModRing* ring, HModFbState state) {
+	for(u32 i = 0; i < ring->n; i++) {
+		if(ring->state[i] == state)
+			return i;
+	}
+
+	return -1;
+}
+
+void NexysVideoHDMIHMod_ring_init(HModRing* ring, u32 n, u32 capture, u32 display,
+ u64 ticks, u64 period) {
+	ring->n      = n < HMOD_RING_MAX ? n : HMOD_RING_MAX;
+	ring->period = period;
+
+	for(u32 i = 0; i < ring->n; i++) {
+		ring->state[i] = HMOD_FB_FREE;
+		ring->since[i] = ticks;
+	}
+
+	ring->blank = 0;
+
+	// capture = display (Durchreichen): Puffer gilt als Aufnahmepuffer
+	ring->state[display] = HMOD_FB_DISPLAYING;
+	ring->state[capture] = HMOD_FB_CAPTURING;
+}
+
+int NexysVideoHDMIHMod_ring_capture(HModRing* ring, u64 ticks) {
+	const int c = NexysVideoHDMIHMod_ring_find(ring, HMOD_FB_CAPTURING);
+
+	// ab Umschalten erst zum naechsten Bildanfang beschrieben
+	if(c < 0 || ticks - ring->since[c] < 2 * ring->period)
+		return -1;
+
+	for(u32 i = 0; i < ring->n; i++) {
+		// von der Anzeige bis zum Bildende noch gelesen
+		if(ring->state[i] == HMOD_FB_FREE && ticks - ring->since[i] >= ring->period) {
+			ring->state[c] = HMOD_FB_READY;
+			ring->since[c] = ticks;
+			ring->state[i] = HMOD_FB_CAPTURING;
+			ring->since[i] = ticks;
+			ring->blank   &= ~(1u << i);
+
+			return i;
+		}
+	}
+
+	return -1;
+}
+
+int NexysVideoHDMIHMod_ring_process(HModRing* ring, u64 ticks) {
+	int p = -1;
+
+	for(u32 i = 0; i < ring->n; i++) {
+		// bis zum Bildende noch von der Aufnahme beschrieben
+		if(ring->state[i] == HMOD_FB_READY && ticks - ring->since[i] >= ring->period) {
+			if(p >= 0 && ring->since[p] > ring->since[i]) {
+				ring->state[i] = HMOD_FB_FREE;
+			} else {
+				if(p >= 0)
+					ring->state[p] = HMOD_FB_FREE;
+
+				p = i;
 			}
 		}
-	} else {
-		Hexsamp_hex2sq(hexarray, &array_hex, radius, scale, mode_i);
+	}
 
+	if(p >= 0) {
+		ring->state[p] = HMOD_FB_PROCESSING;
+		ring->since[p] = ticks;
+	}
 
-		const int width_base  = (int)roundf(((int)width_d  - array_hex.x) / 2);
-		const int height_base = (int)roundf(((int)height_d - array_hex.y) / 2);
+	return p;
+}
 
-		if(width > array_hex.x) {
-			p     = 3 * (  height_base * width       + width_base );
-			pd    = 0;
-			slice = 3 * array_hex.x * sizeof(array_hex.p[0]);
-		} else {
-			p     = 0;
-			pd    = 3 * ( -height_base * array_hex.x - width_base );
-			slice = 3 * width       * sizeof(array_hex.p[0]);
+int NexysVideoHDMIHMod_ring_dest(HModRing* ring, u64 ticks) {
+	for(u32 i = 0; i < ring->n; i++) {
+		// von der Anzeige bis zum Bildende noch gelesen
+		if(ring->state[i] == HMOD_FB_FREE && ticks - ring->since[i] >= ring->period) {
+			ring->state[i] = HMOD_FB_PROCESSING;
+			ring->since[i] = ticks;
+
+			return i;
+		}
+	}
+
+	return -1;
+}
+
+void NexysVideoHDMIHMod_ring_display(HModRing* ring, u32 frame, u64 ticks) {
+	for(u32 i = 0; i < ring->n; i++) {
+		// bisher angezeigter bzw. Quelle
+		if(i != frame && (ring->state[i] == HMOD_FB_DISPLAYING || ring->state[i] == HMOD_FB_PROCESSING)) {
+			ring->state[i] = HMOD_FB_FREE;
+			ring->since[i] = ticks;
 		}
+	}
+
+	ring->state[frame] = HMOD_FB_DISPLAYING;
+	ring->since[frame] = ticks;
+}
+
+
+const char* const NexysVideoHDMIHMod_gov_events[3] = { "miss", "down", "up" };
+
+u32 NexysVideoHDMIHMod_gov_ladder(HModLevel* levels, u32 order, u32 mode_i, float radius) {
+	u32 n = 0;
+
+	levels[n++] = (HModLevel){ .order = order, .mode_i = mode_i, .radius = radius };
+
+	if(radius > 1.0f)
+		levels[n++] = (HModLevel){ .order = order, .mode_i = mode_i, .radius = 1.0f };
+
+	if(mode_i)
+		levels[n++] = (HModLevel){ .order = order, .mode_i = 0, .radius = 1.0f };
+
+	for(int o = (int)order - 1; o >= HMOD_GOV_ORDER_MIN && n < HMOD_GOV_LEVELS; o--)
+		levels[n++] = (HModLevel){ .order = o, .mode_i = 0, .radius = 1.0f };
+
+	return n;
+}
+
+// gleicher Tabellensatz: mode_d = 2 haengt sq2sq auch an mode_i und radius
+static bool NexysVideoHDMIHMod_gov_shares(const HModLevel* a, const HModLevel* b, u32 mode_d) {
+	return a->order == b->order && (mode_d != 2 || (a->mode_i == b->mode_i && a->radius == b->radius));
+}
+
+void NexysVideoHDMIHMod_gov_init(HModGovernor* gov, const HModLevel* levels, u32 n,
+ u32 stride, u32 width_d, u32 height_d, float scale, u32 mode_d, u64 target, u64 budget) {
+	memset(gov, 0, sizeof(*gov));
+
+	gov->n      = n < HMOD_GOV_LEVELS ? n : HMOD_GOV_LEVELS;
+	gov->target = target;
+	gov->budget = budget;
+
+	memcpy(gov->level, levels, gov->n * sizeof(HModLevel));
+
+	// Stufe 0: aktuelle Tabellen
+	NexysVideoHDMIHMod_prepare(stride, width_d, height_d, scale,
+		levels[0].radius, levels[0].mode_i, mode_d);
+	NexysVideoHDMIHMod_tables_store(&gov->sets[0]);
+
+	gov->num_sets = 1;
+
+	for(u32 l = 1; l < gov->n; l++) {
+		const HModLevel* level = &gov->level[l];
+
+		u32 k = 0;
 
-		for(unsigned int h = 0; h < array_hex.y; h++) {
-			memcpy(destFrame + p, array_hex.p + pd, slice);
+		while(k < l && !NexysVideoHDMIHMod_gov_shares(&gov->level[k], level, mode_d))
+			k++;
 
-			p  += 3 * width;
-			pd += 3 * array_hex.x;
+		if(k < l) {
+			gov->set[l] = gov->set[k];
+			continue;
 		}
 
+		NexysVideoHDMIHMod_init(width_d, height_d, level->order, scale, level->radius);
+		NexysVideoHDMIHMod_prepare(stride, width_d, height_d, scale, level->radius, level->mode_i, mode_d);
+		NexysVideoHDMIHMod_tables_store(&gov->sets[gov->num_sets]);
 
-		// pArray2d_free(&array);
+		gov->set[l] = gov->num_sets++;
 	}
 
+	NexysVideoHDMIHMod_tables_load(&gov->sets[0]);
+}
 
-	// Hexarray_free(&hexarray);
+static void NexysVideoHDMIHMod_gov_log(HModGovernor* gov, HModGovEvent event, u32 to, u64 cost) {
+	HModGovLog* log = &gov->log[gov->logged++ % HMOD_GOV_LOG];
+
+	log->frame = gov->frames;
+	log->event = event;
+	log->from  = gov->cur;
+	log->to    = to;
+	log->cost  = (u32)cost;
+}
+
+static void NexysVideoHDMIHMod_gov_switch(HModGovernor* gov, u32 to, HModGovEvent event, u64 cost) {
+	NexysVideoHDMIHMod_gov_log(gov, event, to, cost);
+
+	// nur Zeiger tauschen
+	if(gov->set[to] != gov->set[gov->cur]) {
+		NexysVideoHDMIHMod_tables_store(&gov->sets[gov->set[gov->cur]]);
+		NexysVideoHDMIHMod_tables_load(&gov->sets[gov->set[to]]);
+	}
+
+	gov->cur   = to;
+	gov->ewma  = 0;
+	gov->over  = 0;
+	gov->under = 0;
+	gov->since = 0;
+
+	gov->switches++;
+}
+
+bool NexysVideoHDMIHMod_gov_frame(HModGovernor* gov, u64 cost) {
+	const bool miss = cost > gov->budget;
+
+	gov->frames++;
+	gov->since++;
+
+	gov->ewma  = gov->ewma ? gov->ewma - gov->ewma / 4 + cost / 4 : cost;
+	gov->over  = gov->ewma > gov->target ? gov->over + 1 : 0;
+	gov->under = gov->ewma * 100 < gov->target * HMOD_GOV_UP_PCT ? gov->under + 1 : 0;
+
+	if(miss) {
+		gov->misses++;
+		NexysVideoHDMIHMod_gov_log(gov, HMOD_GOV_MISS, gov->cur, cost);
+	}
+
+	// Stufe nach dem Aufstieg gehalten
+	if(gov->stepped_up && gov->since >= HMOD_GOV_UP) {
+		gov->stepped_up = false;
+		gov->backoff    = 0;
+	}
+
+	// erstes Bild nach einem Wechsel (kalte Caches) loest keinen Abstieg aus
+	if(gov->cur + 1 < gov->n && ((miss && gov->since > 1) || gov->over >= HMOD_GOV_DOWN)) {
+		if(gov->stepped_up && gov->backoff < HMOD_GOV_BACKOFF)
+			gov->backoff++;
+
+		gov->stepped_up = false;
+
+		NexysVideoHDMIHMod_gov_switch(gov, gov->cur + 1, HMOD_GOV_STEP_DOWN, cost);
+
+		return true;
+	}
+
+	if(gov->cur && gov->under >= (u32)HMOD_GOV_UP << gov->backoff) {
+		NexysVideoHDMIHMod_gov_switch(gov, gov->cur - 1, HMOD_GOV_STEP_UP, cost);
+
+		gov->stepped_up = true;
+
+		return true;
+	}
+
+	return false;
+}
+
+void NexysVideoHDMIHMod_gov_stop(HModGovernor* gov) {
+	NexysVideoHDMIHMod_tables_store(&gov->sets[gov->set[gov->cur]]);
+
+	for(u32 k = 1; k < gov->num_sets; k++) {
+		NexysVideoHDMIHMod_tables_load(&gov->sets[k]);
+		NexysVideoHDMIHMod_free();
+	}
+
+	NexysVideoHDMIHMod_tables_load(&gov->sets[0]);
+
+	gov->n        = 0;
+	gov->num_sets = 0;
+	gov->cur      = 0;
+}
+
+
+void NexysVideoHDMIHMod_prof_init() {
+	memset(&hmod_prof, 0, sizeof(hmod_prof));
+
+	hmod_prof.freq = HModTimer_freq();
+}
+
+void NexysVideoHDMIHMod_prof_begin(u64 ticks) {
+	memset(hmod_prof.cur, 0, sizeof(hmod_prof.cur));
+
+	hmod_prof.begin  = ticks;
+	hmod_prof.mark   = ticks;
+	hmod_prof.active = true;
+}
+
+void NexysVideoHDMIHMod_prof_mark(HModStage stage, u64 ticks) {
+	if(!hmod_prof.active)
+		return;
+
+	hmod_prof.cur[stage] += (u32)(ticks - hmod_prof.mark);
+	hmod_prof.mark        = ticks;
+}
+
+void NexysVideoHDMIHMod_prof_end(u64 ticks) {
+	const u32 slot = hmod_prof.frames % HMOD_PROF_WINDOW;
+
+	if(!hmod_prof.active)
+		return;
+
+	hmod_prof.cur[HMOD_STAGE_TOTAL] = (u32)(ticks - hmod_prof.begin);
+	hmod_prof.active                = false;
+
+	for(u32 s = 0; s < HMOD_STAGES; s++) {
+		u32 bin = 0;
+
+		while(bin < HMOD_PROF_BINS - 1 && hmod_prof.cur[s] >> bin)
+			bin++;
+
+		hmod_prof.window[s][slot] = hmod_prof.cur[s];
+		hmod_prof.hist[s][bin]++;
+	}
+
+	hmod_prof.frames++;
+}
+
+void NexysVideoHDMIHMod_prof_stats(HModStage stage, HModProfStats* stats) {
+	u32 v[HMOD_PROF_WINDOW];
+	u64 sum = 0;
+
+	const u32 n = hmod_prof.frames < HMOD_PROF_WINDOW ? hmod_prof.frames : HMOD_PROF_WINDOW;
+
+	memset(stats, 0, sizeof(*stats));
+
+	if(!n)
+		return;
+
+	// Einfuegesortieren, hoechstens HMOD_PROF_WINDOW Werte
+	for(u32 i = 0; i < n; i++) {
+		const u32 x = hmod_prof.window[stage][i];
+		u32       j = i;
+
+		for(; j > 0 && v[j - 1] > x; j--)
+			v[j] = v[j - 1];
+
+		v[j] = x;
+		sum += x;
+	}
+
+	stats->n    = n;
+	stats->min  = v[0];
+	stats->max  = v[n - 1];
+	stats->mean = (u32)(sum / n);
+	stats->p50  = v[(n - 1) * 50 / 100];
+	stats->p90  = v[(n - 1) * 90 / 100];
+	stats->p99  = v[(n - 1) * 99 / 100];
 }
@@ -34,23 +34,467 @@
 
 #include "xil_types.h"
 
+#include <stdatomic.h>
+
+#include "../hmod_timer/hmod_timer.h"
+
+// Neuberechnung im Hintergrund auf einem Arbeits-Thread (Host), sonst
+// schrittweise zwischen zwei Bildern (Board)
+#ifndef HMOD_BUILD_THREAD
+#define HMOD_BUILD_THREAD 0
+#endif
+
+// Hex-Filter (NexysVideoHDMIHMod_conv): Gitterzeilen auf so viele Threads
+// verteilt (Host), 1: im Aufrufer
+#ifndef HMOD_CONV_THREADS
+#define HMOD_CONV_THREADS 1
+#endif
+
+#if HMOD_BUILD_THREAD || HMOD_CONV_THREADS > 1
+#include <pthread.h>
+#endif
+
+
+// Hexsamp_sq2hex: Hex-Pixel in Baendern zu je HMOD_SQ2HEX_BAND Quellzeilen
+// statt in Spiraladressreihenfolge verarbeiten (0 = Spiraladressen)
+#ifndef HMOD_SQ2HEX_BAND
+#define HMOD_SQ2HEX_BAND 0
+#endif
+
+
+// beschriebener Bereich von destFrame: rows Zeilen zu je width Bytes ab
+// Offset begin im Abstand stride, leer: rows = 0
+typedef struct { u32 begin; u32 width; u32 rows; u32 stride; } HModRange;
+
+// Dauerbetrieb: Bilder/s je Messfenster (freq: Ticks/s, Fenster: 1 s)
+typedef struct {
+	u64 freq;
+	u64 window_start;
+	u32 window_frames;
+	u32 frames;   // gesamt
+	u32 fps_x100; // Bilder/s * 100 des letzten Messfensters
+} HModFps;
+
+// Framebuffer-Ring: Aufnahme, Verarbeitung (von einem fertigen in einen
+// freien Puffer, ohne freien in place) und Anzeige laufen gleichzeitig auf
+// verschiedenen Puffern, Zustandswechsel der VDMA erst zum Bildende, daher
+// je Puffer Zeitpunkt des letzten Wechsels (since); ab 4 Puffern kann die
+// Aufnahme weiterlaufen, waehrend ein fertiges Bild auf die Verarbeitung
+// wartet, ab 5 auch nicht in place
+#define HMOD_RING_MAX 8
+
+typedef enum {
+	HMOD_FB_FREE = 0,
+	HMOD_FB_CAPTURING,
+	HMOD_FB_READY,
+	HMOD_FB_PROCESSING,
+	HMOD_FB_DISPLAYING
+} HModFbState;
+
+typedef struct {
+	u32         n;
+	u64         period; // Bildperiode in Ticks
+	HModFbState state[HMOD_RING_MAX];
+	u64         since[HMOD_RING_MAX];
+	u32         blank;  // Bitmaske: ausserhalb der Ausgabe geloescht
+} HModRing;
+
+// Stufenzeiten je Bild (HMOD_PROF = 1): Aufrufer und NexysVideoHDMIHMod
+// setzen Marken mit der Zeitbasis HModTimer_ticks();
+// min/mean/max/Perzentile ueber die letzten HMOD_PROF_WINDOW Bilder,
+// log2-Histogramm ueber alle Bilder
+#ifndef HMOD_PROF
+#define HMOD_PROF 0
+#endif
+
+#define HMOD_PROF_WINDOW 64
+#define HMOD_PROF_BINS   32
+
+typedef enum {
+	HMOD_STAGE_INVALIDATE = 0, // Xil_DCacheInvalidateRange
+	HMOD_STAGE_SQ2HEX,
+	HMOD_STAGE_CONV,           // NexysVideoHDMIHMod_conv
+	HMOD_STAGE_HEX2SQ,         // hex2sq, Hex-Pixel (mode_d = 0) bzw. sq2sq (2)
+	HMOD_STAGE_FLUSH,          // NexysVideoHDMIHMod_flush
+	HMOD_STAGE_TOTAL,
+	HMOD_STAGES
+} HModStage;
+
+typedef struct {
+	u64  freq;
+	u64  mark;   // letzte Marke des laufenden Bilds
+	u64  begin;
+	bool active;
+	u32  cur[HMOD_STAGES];
+	u32  window[HMOD_STAGES][HMOD_PROF_WINDOW];
+	u32  hist[HMOD_STAGES][HMOD_PROF_BINS]; // Bin b: Ticks < 2^b
+	u32  frames;
+} HModProf;
+
+typedef struct { u32 n; u32 min; u32 mean; u32 max; u32 p50; u32 p90; u32 p99; } HModProfStats;
+
+// Inkrementelle Verarbeitung (NexysVideoHDMIHMod_delta_init, mode_d = 0, 1):
+// sq2hex nur fuer Hex-Pixel in geaenderten Kacheln des Quellbilds
+// (Hexsamp_sq2hex_delta), Ausgabe nur in Reichweite geaenderter Hex-Pixel;
+// wechselt destFrame (Framebuffer-Ring, mmap-Fenster) bzw. in place in einen
+// eigenen Puffer (buf), der danach nach destFrame kopiert wird;
+// mode_d = 2 immer vollstaendig
+typedef struct {
+	bool     enabled;
+	Hexdelta delta;
+	u8*      dest;     // Puffer mit dem vorherigen Ergebnis, NULL: keiner
+	u8*      prev;     // destFrame des vorherigen Bilds
+	u8*      buf;
+	size_t   buf_size;
+	u32      mode_d;
+	float    radius;
+	uPoint2d res;
+	u32      stride;
+
+	u32 frames;
+	u64 sampled;  // neu berechnete Hex-Pixel
+	u64 changes;  // davon verschieden
+	u64 hex;      // Hex-Pixel gesamt
+	u64 rendered; // berechnete Ausgabepixel
+	u64 pixels;   // Ausgabepixel gesamt (sichtbares Hex-Bild)
+} HModDelta;
+
+// Hex-Filter zwischen sq2hex und hex2sq (NexysVideoHDMIHMod_conv_init,
+// mode_d = 0, 1, nicht inkrementell): Hexconv in place auf dem Hex-Bild,
+// Plan (conv) neu bei anderen Tabellen (pc_lattice) bzw. Taps
+typedef enum {
+	HMOD_CONV_NONE = 0,
+	HMOD_CONV_GAUSS,     // 7 Taps, sigma 1
+	HMOD_CONV_GAUSS49,   // 49 Taps, sigma 1.5
+	HMOD_CONV_LAPLACE,   // 7 Taps, bias 128
+	HMOD_CONV_SOBEL,     // 49 Taps, |Ableitung| waagrecht
+	HMOD_CONV_FILTERS
+} HModConvFilter;
+
+typedef struct {
+	u32                 filter;
+	Hexkernel           kernel;
+	Hexconv             conv;
+	const unsigned int* lattice;  // pc_lattice, fuer das conv gilt
+	u32                 frames;
+} HModConv;
+
+// Tabellensatz: alle Vorberechnungen einer Konfiguration (CHIPCore pc_*,
+// hexarray, pc_scatter, sq2sq), Wechsel ohne Neuberechnung
+typedef struct {
+	float*         reals;
+	int16_t*       reals_q;
+	iPoint2d       reals_min;
+	iPoint2d       reals_max;
+	int16_t*       spatials;
+	iPoint2d       spatials_min;
+	iPoint2d       spatials_max;
+	unsigned int*  lattice;
+	iPoint2d       lattice_min;
+	uPoint2d       lattice_dims;
+	unsigned int*  order;
+	unsigned int   order_interior;
+	uPoint2d       order_dims;
+	float          order_scale;
+
+	Hexarray hexarray;
+
+	u32*      scatter;
+	u32       scatter_size;
+	uPoint2d  scatter_res;
+	u32       scatter_stride;
+	HModRange scatter_range;
+
+	Hexsq2sq sq2sq;
+	u32      sq2sq_mode_i;
+	float    sq2sq_scale;
+	float    sq2sq_radius;
+	uPoint2d sq2sq_res;
+	u32      sq2sq_stride;
+} HModTables;
+
+// Tabellensatz schrittweise berechnen (NexysVideoHDMIHMod_build_*): die
+// aktuellen Tabellen bleiben bis zum Tausch an einer Bildgrenze gueltig,
+// danach werden sie ebenso schrittweise freigegeben (HMOD_BUILD_RETIRE)
+#define HMOD_BUILD_ALL 0xFFFFFFFFu
+
+typedef enum {
+	HMOD_BUILD_IDLE = 0,
+	HMOD_BUILD_COORDS,   // pc_reals, pc_reals_q, Grenzen
+	HMOD_BUILD_SPATIALS,
+	HMOD_BUILD_LATTICE,  // pc_lattice
+	HMOD_BUILD_HEXARRAY,
+	HMOD_BUILD_READY,    // -> NexysVideoHDMIHMod_build_commit
+	HMOD_BUILD_RETIRE,   // alte Tabellen freigeben
+	HMOD_BUILD_PHASES
+} HModBuildPhase;
+
+typedef struct {
+	u32   width_d;
+	u32   height_d;
+	u32   order;
+	float scale;
+	float radius;
+	bool  verbose;   // Fortschritt per xil_printf
+
+	_Atomic HModBuildPhase phase; // Bauthread: release, Hauptschleife: acquire
+	u32                    next;  // Eintrag innerhalb der Phase
+	u32                    size;  // 7^order
+
+	HModTables tables; // im Bau bzw. (HMOD_BUILD_RETIRE) die alten
+
+#if HMOD_BUILD_THREAD
+	pthread_t thread;
+	bool      running;
+#endif
+} HModBuild;
+
+// Qualitaetsregler: haelt die gemessenen Kosten je Bild (Ticks) unter
+// target, indem er zwischen Stufen (order, mode_i, radius) wechselt, Stufe 0
+// ist die beste; jede Stufe hat einen vorberechneten Tabellensatz.
+// Hysterese: abwaerts nach HMOD_GOV_DOWN Bildern ueber target oder sofort
+// bei einer verpassten Frist (Kosten > budget), aufwaerts nach
+// HMOD_GOV_UP << backoff Bildern unter HMOD_GOV_UP_PCT % von target; faellt
+// eine Stufe innerhalb von HMOD_GOV_UP Bildern wieder ab, verdoppelt sich die
+// Wartezeit (backoff, hoechstens HMOD_GOV_BACKOFF)
+#define HMOD_GOV_LEVELS    8
+#define HMOD_GOV_ORDER_MIN 3
+#define HMOD_GOV_DOWN      3
+#define HMOD_GOV_UP        60
+#define HMOD_GOV_UP_PCT    70
+#define HMOD_GOV_BACKOFF   4
+#define HMOD_GOV_LOG       8
+
+typedef struct { u32 order; u32 mode_i; float radius; } HModLevel;
+
+typedef enum {
+	HMOD_GOV_MISS = 0, // Frist verpasst (ohne Wechsel: bereits unterste Stufe)
+	HMOD_GOV_STEP_DOWN,
+	HMOD_GOV_STEP_UP
+} HModGovEvent;
+
+typedef struct {
+	u32          frame;
+	HModGovEvent event;
+	u32          from;
+	u32          to;
+	u32          cost; // Ticks
+} HModGovLog;
+
+typedef struct {
+	u32        n;
+	HModLevel  level[HMOD_GOV_LEVELS];
+	u32        set[HMOD_GOV_LEVELS];  // Tabellensatz je Stufe
+	u32        num_sets;
+	HModTables sets[HMOD_GOV_LEVELS];
+
+	u64  target;
+	u64  budget;
+	u32  cur;
+	u64  ewma;       // Kosten der aktuellen Stufe, gleitend (1/4), 0: neu
+	u32  over;       // aufeinanderfolgende Bilder ueber target
+	u32  under;      // ... unter HMOD_GOV_UP_PCT % von target
+	u32  since;      // Bilder seit dem letzten Wechsel
+	u32  backoff;
+	bool stepped_up; // seit dem letzten Aufstieg weniger als HMOD_GOV_UP Bilder
+
+	u32        frames;
+	u32        misses;
+	u32        switches;
+	u32        logged; // gesamt, log[logged % HMOD_GOV_LOG] ist der naechste
+	HModGovLog log[HMOD_GOV_LOG];
+} HModGovernor;
+
 
-pArray2d array;
 Hexarray hexarray;
-pArray2d array_hex;
 
+// mode_d = 0: (Hex-Index, Zieloffset) je sichtbarem Hex-Pixel
+u32*      pc_scatter;
+u32       pc_scatter_size;
+uPoint2d  pc_scatter_res;
+u32       pc_scatter_stride;
+HModRange pc_scatter_range;
 
-// Vorberechnungen
+HModProf hmod_prof;
+
+HModDelta hmod_delta;
+
+// NexysVideoHDMIHMod_sq2hex_roi
+Hexroi hmod_roi;
+
+HModConv hmod_conv;
+
+extern const char* const NexysVideoHDMIHMod_filters[HMOD_CONV_FILTERS];
+
+extern const char* const NexysVideoHDMIHMod_stages[HMOD_STAGES];
+
+// mode_d = 2: sq2hex + hex2sq als eine Abbildung, Neuberechnung bei
+// geaendertem mode_i, scale, radius bzw. geaenderter Aufloesung (width_d,
+// height_d, stride)
+Hexsq2sq sq2sq;
+u32      sq2sq_mode_i;
+float    sq2sq_scale;
+float    sq2sq_radius;
+uPoint2d sq2sq_res;
+u32      sq2sq_stride;
+
+
+// Vorberechnungen: nur order bestimmt die Tabellen, scale und radius
+// (Gewichte je Phase, Hexbank) duerfen sich von Bild zu Bild aendern; scale
+// dient nur der Verarbeitungsreihenfolge von sq2hex
 
 void NexysVideoHDMIHMod_init(u32 width_d, u32 height_d,
  u32 order, float scale, float radius);
 
 void NexysVideoHDMIHMod_free();
 
+// Neuberechnung bei laufender Verarbeitung: _start, dann regelmaessig _poll
+// (Board: rechnet hoechstens units Eintraege, Host: fragt den Arbeits-Thread
+// ab), bei HMOD_BUILD_READY an einer Bildgrenze _commit (neue Tabellen
+// aktuell, alte werden in HMOD_BUILD_RETIRE freigegeben), weiter _poll bis
+// HMOD_BUILD_IDLE; _start wartet ggf. auf die Freigabe der vorherigen
+void NexysVideoHDMIHMod_build_start(HModBuild* build, u32 width_d, u32 height_d,
+ u32 order, float scale, float radius);
+HModBuildPhase NexysVideoHDMIHMod_build_poll(HModBuild* build, u32 units);
+void NexysVideoHDMIHMod_build_commit(HModBuild* build);
+
+// blockierend zu Ende rechnen und verwerfen (Tabellen bleiben unveraendert)
+void NexysVideoHDMIHMod_build_cancel(HModBuild* build);
+
+extern const char* const NexysVideoHDMIHMod_build_phases[HMOD_BUILD_PHASES];
 
-void NexysVideoHDMIHMod(u8* srcFrame, u8* destFrame,
- u32 width, u32 height, u32 width_d, u32 height_d,
+void NexysVideoHDMIHMod_scatter_init(u32 stride, u32 width_d, u32 height_d);
+
+// auch die sonst beim ersten Bild berechneten Tabellen (pc_scatter, sq2sq)
+void NexysVideoHDMIHMod_prepare(u32 stride, u32 width_d, u32 height_d,
+ float scale, float radius, u32 mode_i, u32 mode_d);
+
+// aktuelle Vorberechnungen in tables uebernehmen (danach leer, erneutes
+// _init moeglich) bzw. tables zu den aktuellen machen (sie bleiben Eigentum
+// von tables: vor dem naechsten _load mit _store zurueckholen, Freigabe
+// per _load und NexysVideoHDMIHMod_free)
+void NexysVideoHDMIHMod_tables_store(HModTables* tables);
+void NexysVideoHDMIHMod_tables_load(const HModTables* tables);
+
+
+// srcFrame wird direkt gelesen, destFrame direkt beschrieben (stride: Bytes
+// je Zeile beider Framebuffer, beide mit width_d x height_d Pixeln
+// ausgewertet), vorher ggf. Xil_DCacheInvalidateRange(srcFrame,
+// stride * height_d), danach
+// NexysVideoHDMIHMod_flush(destFrame, Rueckgabewert)
+HModRange NexysVideoHDMIHMod(u8* srcFrame, u8* destFrame,
+ u32 stride, u32 width_d, u32 height_d,
  u32 order, float scale, float radius, u32 mode_i, u32 mode_d);
 
+// Stufen von NexysVideoHDMIHMod einzeln (mode_d = 0, 1), z. B. fuer eine
+// Pipeline mit einem Hexarray je Bild; nicht in place,
+// NexysVideoHDMIHMod_hex2sq nur aus einem Thread (pc_scatter)
+void NexysVideoHDMIHMod_sq2hex(u8* srcFrame, Hexarray* hex,
+ u32 stride, u32 width_d, u32 height_d, u32 order, float scale, u32 mode_i);
+
+// nur die Hex-Pixel, deren Abtastort in [min, max) von srcFrame liegt;
+// Rueckgabe: deren Spiraladressbereiche (gueltig bis zum naechsten Aufruf),
+// Neuberechnung nur bei geaendertem Rechteck, order, scale bzw. Aufloesung
+const Hexroi* NexysVideoHDMIHMod_sq2hex_roi(u8* srcFrame, Hexarray* hex,
+ u32 stride, u32 width_d, u32 height_d, u32 order, float scale, u32 mode_i,
+ iPoint2d min, iPoint2d max);
+
+HModRange NexysVideoHDMIHMod_hex2sq(Hexarray hex, u8* destFrame,
+ u32 stride, u32 width_d, u32 height_d, float scale, float radius, u32 mode_i, u32 mode_d);
+
+// inkrementell ein bzw. aus, setzt die Statistik zurueck; das naechste Bild
+// wird vollstaendig berechnet
+void NexysVideoHDMIHMod_delta_init(bool enabled);
+
+// Filter (HMOD_CONV_*) fuer die folgenden Bilder; NexysVideoHDMIHMod_conv:
+// hex in place filtern (Stufen einzeln, nach NexysVideoHDMIHMod_sq2hex;
+// nur aus einem Thread, Plan und Gitter sind global)
+void NexysVideoHDMIHMod_conv_init(u32 filter);
+void NexysVideoHDMIHMod_conv(Hexarray* hex);
+
+// Xil_DCacheFlushRange nur fuer die beschriebenen Zeilenabschnitte
+void NexysVideoHDMIHMod_flush(u8* destFrame, HModRange range);
+
+// alles loeschen, was NexysVideoHDMIHMod nicht beschreibt (Rand ausserhalb
+// des Hex-Bilds, mode_d = 0 auch die Luecken); genuegt je Zielpuffer
+// einmal, solange order, scale und mode_d gleich bleiben
+void NexysVideoHDMIHMod_blank(u8* destFrame, u32 stride, u32 width_d, u32 height_d,
+ float scale, u32 mode_d);
+
+
+// ticks: beliebige monoton steigende Zeitbasis mit freq Ticks/s
+void NexysVideoHDMIHMod_fps_init(HModFps* fps, u64 ticks, u64 freq);
+
+// je verarbeitetem Bild; true, wenn fps_x100 neu berechnet wurde
+bool NexysVideoHDMIHMod_fps_frame(HModFps* fps, u64 ticks);
+
+
+// n: Anzahl Puffer (hoechstens HMOD_RING_MAX), capture: Puffer der Aufnahme,
+// display: Puffer der Anzeige (ggf. gleich)
+void NexysVideoHDMIHMod_ring_init(HModRing* ring, u32 n, u32 capture, u32 display,
+ u64 ticks, u64 period);
+
+// Aufnahme auf einen freien Puffer umschalten, sobald der aktuelle ein
+// vollstaendiges Bild enthaelt; Rueckgabe: neuer Aufnahmepuffer
+// (-> VideoChangeFrame) oder -1
+int  NexysVideoHDMIHMod_ring_capture(HModRing* ring, u64 ticks);
+
+// neuestes fertiges Bild zur Verarbeitung uebernehmen, aeltere verwerfen;
+// Rueckgabe: Puffer oder -1
+int  NexysVideoHDMIHMod_ring_process(HModRing* ring, u64 ticks);
+
+// freien Puffer als Ziel der Verarbeitung belegen; Rueckgabe: Puffer oder
+// -1 (dann in place)
+int  NexysVideoHDMIHMod_ring_dest(HModRing* ring, u64 ticks);
+
+// Ziel der Verarbeitung anzeigen (-> DisplayChangeFrame), bisher angezeigter
+// und Quellpuffer werden frei
+void NexysVideoHDMIHMod_ring_display(HModRing* ring, u32 frame, u64 ticks);
+
+
+// Standardstufen ab der Konfiguration (order, mode_i, radius): radius 1,
+// mode_i 0, dann je eine order weniger bis HMOD_GOV_ORDER_MIN; Rueckgabe:
+// Anzahl Stufen
+u32  NexysVideoHDMIHMod_gov_ladder(HModLevel* levels, u32 order, u32 mode_i, float radius);
+
+// levels[0] muss der aktuellen Initialisierung entsprechen, deren Tabellen
+// uebernommen werden; fuer die uebrigen Stufen werden Tabellensaetze
+// berechnet (mode_d != 2: einer je order); target, budget in Ticks
+void NexysVideoHDMIHMod_gov_init(HModGovernor* gov, const HModLevel* levels, u32 n,
+ u32 stride, u32 width_d, u32 height_d, float scale, u32 mode_d, u64 target, u64 budget);
+
+// je verarbeitetem Bild mit dessen Kosten; true: Stufe gewechselt, deren
+// Tabellensatz ist bereits geladen (-> gov->level[gov->cur])
+bool NexysVideoHDMIHMod_gov_frame(HModGovernor* gov, u64 cost);
+
+// zurueck auf Stufe 0 (wie vor _gov_init), alle anderen Saetze frei
+void NexysVideoHDMIHMod_gov_stop(HModGovernor* gov);
+
+extern const char* const NexysVideoHDMIHMod_gov_events[3];
+
+
+
+#if HMOD_PROF
+#define HMOD_PROF_BEGIN()     NexysVideoHDMIHMod_prof_begin(HModTimer_ticks())
+#define HMOD_PROF_MARK(stage) NexysVideoHDMIHMod_prof_mark(stage, HModTimer_ticks())
+#define HMOD_PROF_END()       NexysVideoHDMIHMod_prof_end(HModTimer_ticks())
+#else
+#define HMOD_PROF_BEGIN()
+#define HMOD_PROF_MARK(stage)
+#define HMOD_PROF_END()
+#endif
+
+// setzt alle Statistiken zurueck, Ticks/s von HModTimer_freq()
+void NexysVideoHDMIHMod_prof_init();
+
+// Bildbeginn; Marke: Zeit seit der vorherigen Marke gehoert zu stage
+// (ohne laufendes Bild ignoriert); Bildende: Gesamtzeit, Fenster weiter
+void NexysVideoHDMIHMod_prof_begin(u64 ticks);
+void NexysVideoHDMIHMod_prof_mark(HModStage stage, u64 ticks);
+void NexysVideoHDMIHMod_prof_end(u64 ticks);
+
+// Statistik (Ticks) ueber die letzten min(frames, HMOD_PROF_WINDOW) Bilder
+void NexysVideoHDMIHMod_prof_stats(HModStage stage, HModProfStats* stats);
+
 
 #endif
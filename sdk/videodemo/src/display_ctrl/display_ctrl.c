@@ -68,6 +68,58 @@
 /*				Procedure Definitions							*/
 /* ------------------------------------------------------------ */
 
+/***	DisplayConfigVdma(DisplayCtrl *dispPtr)
+**
+**	Parameters:
+**		dispPtr - Pointer to the initialized DisplayCtrl struct
+**
+**	Return Value: int
+**		XST_SUCCESS if successful, XST_FAILURE otherwise
+**
+**	Errors:
+**
+**	Description:
+**		Writes vdmaConfig (including the frame store addresses) to the VDMA
+**		read channel and parks it on curStore. The VDMA latches the new
+**		values at the next frame boundary, so this can also be used while
+**		the display is running.
+**
+*/
+static int DisplayConfigVdma(DisplayCtrl *dispPtr)
+{
+	int Status;
+
+	dispPtr->vdmaConfig.FixedFrameStoreAddr = dispPtr->curStore;
+
+	Status = XAxiVdma_DmaConfig(dispPtr->vdma, XAXIVDMA_READ, &(dispPtr->vdmaConfig));
+	if (Status != XST_SUCCESS)
+	{
+		xdbg_printf(XDBG_DEBUG_GENERAL, "Read channel config failed %d\r\n", Status);
+		return XST_FAILURE;
+	}
+	Status = XAxiVdma_DmaSetBufferAddr(dispPtr->vdma, XAXIVDMA_READ, dispPtr->vdmaConfig.FrameStoreStartAddr);
+	if (Status != XST_SUCCESS)
+	{
+		xdbg_printf(XDBG_DEBUG_GENERAL, "Read channel set buffer address failed %d\r\n", Status);
+		return XST_FAILURE;
+	}
+	Status = XAxiVdma_DmaStart(dispPtr->vdma, XAXIVDMA_READ);
+	if (Status != XST_SUCCESS)
+	{
+		xdbg_printf(XDBG_DEBUG_GENERAL, "Start read transfer failed %d\r\n", Status);
+		return XST_FAILURE;
+	}
+	Status = XAxiVdma_StartParking(dispPtr->vdma, dispPtr->curStore, XAXIVDMA_READ);
+	if (Status != XST_SUCCESS)
+	{
+		xdbg_printf(XDBG_DEBUG_GENERAL, "Unable to park the channel %d\r\n", Status);
+		return XST_FAILURE;
+	}
+
+	return XST_SUCCESS;
+}
+/* ------------------------------------------------------------ */
+
 /***	DisplayStop(DisplayCtrl *dispPtr)
 **
 **	Parameters:
@@ -243,43 +295,23 @@ int DisplayStart(DisplayCtrl *dispPtr)
 	 */
 	dispPtr->vdmaConfig.VertSizeInput = dispPtr->vMode.height;
 	dispPtr->vdmaConfig.HoriSizeInput = (dispPtr->vMode.width) * 3;
-	dispPtr->vdmaConfig.FixedFrameStoreAddr = dispPtr->curFrame;
 	/*
 	 *Also reset the stride and address values, in case the user manually changed them
 	 */
 	dispPtr->vdmaConfig.Stride = dispPtr->stride;
-	for (i = 0; i < DISPLAY_NUM_FRAMES; i++)
+	dispPtr->curStore = 0;
+	for (i = 0; i < DISPLAY_NUM_FSTORES; i++)
 	{
-		dispPtr->vdmaConfig.FrameStoreStartAddr[i] = (u32)  dispPtr->framePtr[i];
+		dispPtr->vdmaConfig.FrameStoreStartAddr[i] = (UINTPTR)  dispPtr->framePtr[dispPtr->curFrame];
 	}
 
 	/*
 	 * Perform the VDMA driver calls required to start a transfer. Note that no data is actually
 	 * transferred until the disp_ctrl core signals the VDMA core by pulsing fsync.
 	 */
-
-	Status = XAxiVdma_DmaConfig(dispPtr->vdma, XAXIVDMA_READ, &(dispPtr->vdmaConfig));
+	Status = DisplayConfigVdma(dispPtr);
 	if (Status != XST_SUCCESS)
 	{
-		xdbg_printf(XDBG_DEBUG_GENERAL, "Read channel config failed %d\r\n", Status);
-		return XST_FAILURE;
-	}
-	Status = XAxiVdma_DmaSetBufferAddr(dispPtr->vdma, XAXIVDMA_READ, dispPtr->vdmaConfig.FrameStoreStartAddr);
-	if (Status != XST_SUCCESS)
-	{
-		xdbg_printf(XDBG_DEBUG_GENERAL, "Read channel set buffer address failed %d\r\n", Status);
-		return XST_FAILURE;
-	}
-	Status = XAxiVdma_DmaStart(dispPtr->vdma, XAXIVDMA_READ);
-	if (Status != XST_SUCCESS)
-	{
-		xdbg_printf(XDBG_DEBUG_GENERAL, "Start read transfer failed %d\r\n", Status);
-		return XST_FAILURE;
-	}
-	Status = XAxiVdma_StartParking(dispPtr->vdma, dispPtr->curFrame, XAXIVDMA_READ);
-	if (Status != XST_SUCCESS)
-	{
-		xdbg_printf(XDBG_DEBUG_GENERAL, "Unable to park the channel %d\r\n", Status);
 		return XST_FAILURE;
 	}
 
@@ -290,14 +322,16 @@ int DisplayStart(DisplayCtrl *dispPtr)
 
 /* ------------------------------------------------------------ */
 
-/***	DisplayInitialize(DisplayCtrl *dispPtr, XAxiVdma *vdma, u16 vtcId, u32 dynClkAddr, u8 *framePtr[DISPLAY_NUM_FRAMES], u32 stride)
+/***	DisplayInitialize(DisplayCtrl *dispPtr, XAxiVdma *vdma, u16 vtcId, u32 dynClkAddr, u8 **framePtr, u32 numFrames, u32 stride)
 **
 **	Parameters:
 **		dispPtr - Pointer to the struct that will be initialized
 **		vdma - Pointer to initialized VDMA struct
 **		vtcId - Device ID of the VTC core as found in xparameters.h
 **		dynClkAddr - BASE ADDRESS of the axi_dynclk core
-**		framePtr - array of pointers to the framebuffers. The framebuffers must be instantiated above this driver, and there must be 3
+**		framePtr - array of pointers to the framebuffers. The framebuffers must be instantiated above this driver, and the array
+**				   must stay valid while the driver is in use
+**		numFrames - number of framebuffers in framePtr, at least 1. This is independent of DISPLAY_NUM_FSTORES
 **		stride - line stride of the framebuffers. This is the number of bytes between the start of one line and the start of another.
 **
 **	Return Value: int
@@ -309,10 +343,9 @@ int DisplayStart(DisplayCtrl *dispPtr)
 **		Initializes the driver struct for use.
 **
 */
-int DisplayInitialize(DisplayCtrl *dispPtr, XAxiVdma *vdma, u16 vtcId, u32 dynClkAddr, u8 *framePtr[DISPLAY_NUM_FRAMES], u32 stride)
+int DisplayInitialize(DisplayCtrl *dispPtr, XAxiVdma *vdma, u16 vtcId, u32 dynClkAddr, u8 **framePtr, u32 numFrames, u32 stride)
 {
 	int Status;
-	int i;
 	XVtc_Config *vtcConfig;
 	ClkConfig clkReg;
 	ClkMode clkMode;
@@ -322,11 +355,10 @@ int DisplayInitialize(DisplayCtrl *dispPtr, XAxiVdma *vdma, u16 vtcId, u32 dynCl
 	 * Initialize all the fields in the DisplayCtrl struct
 	 */
 	dispPtr->curFrame = 0;
+	dispPtr->curStore = 0;
 	dispPtr->dynClkAddr = dynClkAddr;
-	for (i = 0; i < DISPLAY_NUM_FRAMES; i++)
-	{
-		dispPtr->framePtr[i] = framePtr[i];
-	}
+	dispPtr->framePtr = framePtr;
+	dispPtr->numFrames = numFrames;
 	dispPtr->state = DISPLAY_STOPPED;
 	dispPtr->stride = stride;
 	dispPtr->vMode = VMODE_640x480;
@@ -430,7 +462,7 @@ int DisplaySetMode(DisplayCtrl *dispPtr, const VideoMode *newMode)
 **	Parameters:
 **		dispPtr - Pointer to the initialized DisplayCtrl struct
 **		frameIndex - Index of the framebuffer to change to (must
-**				be between 0 and (DISPLAY_NUM_FRAMES - 1))
+**				be between 0 and (numFrames - 1))
 **
 **	Return Value: int
 **		XST_SUCCESS if successful, XST_FAILURE otherwise
@@ -438,7 +470,9 @@ int DisplaySetMode(DisplayCtrl *dispPtr, const VideoMode *newMode)
 **	Errors:
 **
 **	Description:
-**		Changes the frame currently being displayed.
+**		Changes the frame currently being displayed. The framebuffer is
+**		mapped onto the next VDMA frame store; the store being read keeps
+**		its address, so the frame in progress is finished undisturbed.
 **
 */
 
@@ -447,16 +481,18 @@ int DisplayChangeFrame(DisplayCtrl *dispPtr, u32 frameIndex)
 	int Status;
 
 	dispPtr->curFrame = frameIndex;
+	dispPtr->curStore = (dispPtr->curStore + 1) % DISPLAY_NUM_FSTORES;
+	dispPtr->vdmaConfig.FrameStoreStartAddr[dispPtr->curStore] = (UINTPTR)  dispPtr->framePtr[frameIndex];
 	/*
 	 * If currently running, then the DMA needs to be told to start reading from the desired frame
 	 * at the end of the current frame
 	 */
 	if (dispPtr->state == DISPLAY_RUNNING)
 	{
-		Status = XAxiVdma_StartParking(dispPtr->vdma, dispPtr->curFrame, XAXIVDMA_READ);
+		Status = DisplayConfigVdma(dispPtr);
 		if (Status != XST_SUCCESS)
 		{
-			xdbg_printf(XDBG_DEBUG_GENERAL, "Cannot change frame, unable to start parking %d\r\n", Status);
+			xdbg_printf(XDBG_DEBUG_GENERAL, "Cannot change frame %d\r\n", Status);
 			return XST_FAILURE;
 		}
 	}
@@ -66,9 +66,11 @@
 #define BIT_DISPLAY_GREEN 0
 
 /*
- * This driver currently supports 3 frames.
+ * Number of frame stores of the VDMA read channel (C_NUM_FSTORES). Any number
+ * of framebuffers can be passed to DisplayInitialize; each one is mapped
+ * onto a free frame store when it is displayed.
  */
-#define DISPLAY_NUM_FRAMES 3
+#define DISPLAY_NUM_FSTORES 3
 
 /* ------------------------------------------------------------ */
 /*					General Type Declarations					*/
@@ -85,10 +87,12 @@ typedef struct {
 		XAxiVdma_DmaSetup vdmaConfig; /*VDMA channel configuration*/
 		XVtc vtc; /*VTC driver struct*/
 		VideoMode vMode; /*Current Video mode*/
-		u8 *framePtr[DISPLAY_NUM_FRAMES]; /* Array of pointers to the framebuffers */
+		u8 **framePtr; /* Array of pointers to the framebuffers */
+		u32 numFrames; /* Number of framebuffers in framePtr */
 		u32 stride; /* The line stride of the framebuffers, in bytes */
 		double pxlFreq; /* Frequency of clock currently being generated */
 		u32 curFrame; /* Current frame being displayed */
+		u32 curStore; /* VDMA frame store curFrame is mapped onto */
 		DisplayState state; /* Indicates if the Display is currently running */
 } DisplayCtrl;
 
@@ -98,7 +102,7 @@ typedef struct {
 
 int DisplayStop(DisplayCtrl *dispPtr);
 int DisplayStart(DisplayCtrl *dispPtr);
-int DisplayInitialize(DisplayCtrl *dispPtr, XAxiVdma *vdma, u16 vtcId, u32 dynClkAddr, u8 *framePtr[DISPLAY_NUM_FRAMES], u32 stride);
+int DisplayInitialize(DisplayCtrl *dispPtr, XAxiVdma *vdma, u16 vtcId, u32 dynClkAddr, u8 **framePtr, u32 numFrames, u32 stride);
 int DisplaySetMode(DisplayCtrl *dispPtr, const VideoMode *newMode);
 int DisplayChangeFrame(DisplayCtrl *dispPtr, u32 frameIndex);
 
@@ -0,0 +1,43 @@
+/******************************************************************************
+ * hmod_timer.c: HModTimer backend for the board (axi_timer_0)
+ ******************************************************************************
+ * Counter HMOD_TIMER_COUNTER counts up at XPAR_AXI_TIMER_0_CLOCK_FREQ_HZ and
+ * wraps after 2^32 ticks (43 s at 100 MHz); HModTimer_ticks extends it to
+ * 64 bit, so it has to be called at least once per wrap. Single-threaded
+ * like the rest of the demo.
+ ******************************************************************************/
+
+
+#include "hmod_timer.h"
+
+#include "xparameters.h"
+#include "xtmrctr_l.h"
+
+
+static u64 HModTimer_total = 0;
+static u32 HModTimer_last  = 0;
+
+
+void HModTimer_init() {
+	if(XTmrCtr_GetControlStatusReg(XPAR_AXI_TIMER_0_BASEADDR, HMOD_TIMER_COUNTER) & XTC_CSR_ENABLE_TMR_MASK)
+		return;
+
+	XTmrCtr_SetControlStatusReg(XPAR_AXI_TIMER_0_BASEADDR, HMOD_TIMER_COUNTER, XTC_CSR_ENABLE_TMR_MASK);
+
+	HModTimer_last = XTmrCtr_GetTimerCounterReg(XPAR_AXI_TIMER_0_BASEADDR, HMOD_TIMER_COUNTER);
+}
+
+u64 HModTimer_ticks() {
+	HModTimer_init();
+
+	const u32 now = XTmrCtr_GetTimerCounterReg(XPAR_AXI_TIMER_0_BASEADDR, HMOD_TIMER_COUNTER);
+
+	HModTimer_total += now - HModTimer_last;
+	HModTimer_last   = now;
+
+	return HModTimer_total;
+}
+
+u64 HModTimer_freq() {
+	return XPAR_AXI_TIMER_0_CLOCK_FREQ_HZ;
+}
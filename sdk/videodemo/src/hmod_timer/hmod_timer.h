@@ -0,0 +1,75 @@
+/******************************************************************************
+ * hmod_timer.h: Zeitmessung fuer HMod, Board und Host
+ ******************************************************************************
+ * One time base for all instrumentation and benchmarks, so numbers from the
+ * board and from host builds are comparable:
+ *
+ *   HModTimer_ticks()  monotonic 64-bit tick counter
+ *   HModTimer_freq()   ticks per second
+ *
+ * Backends (exactly one is linked):
+ *   hmod_timer.c           board: counter HMOD_TIMER_COUNTER of axi_timer_0,
+ *                          free-running, extended to 64 bit in software
+ *                          (ticks = AXI clock cycles)
+ *   host/hal/hmod_timer_host.c
+ *                          host: rdtsc on x86 (calibrated against
+ *                          CLOCK_MONOTONIC), otherwise clock_gettime in ns
+ *
+ * HModTimer measures intervals on top of that: start, stop, elapsed cycles
+ * (ticks) and elapsed ns.
+ ******************************************************************************/
+
+
+#ifndef HMOD_TIMER_H
+#define HMOD_TIMER_H
+
+
+#include "xil_types.h"
+
+
+// Board: zweiter Zaehler von axi_timer_0 (der erste bleibt frei)
+#define HMOD_TIMER_COUNTER 1
+
+
+typedef struct {
+	u64 start;
+	u64 elapsed; // Ticks des letzten Intervalls start .. stop
+} HModTimer;
+
+
+// Zeitbasis starten (Board) bzw. kalibrieren (Host, rdtsc); idempotent,
+// HModTimer_ticks/_freq holen es sonst beim ersten Aufruf nach
+void HModTimer_init();
+
+u64  HModTimer_ticks();
+u64  HModTimer_freq();
+
+
+// Ticks -> ns, ohne Ueberlauf fuer lange Intervalle
+static inline u64 HModTimer_to_ns(u64 ticks) {
+	const u64 freq = HModTimer_freq();
+
+	return ticks / freq * 1000000000u + ticks % freq * 1000000000u / freq;
+}
+
+static inline void HModTimer_start(HModTimer* timer) {
+	timer->start = HModTimer_ticks();
+}
+
+// Rueckgabe: Ticks seit HModTimer_start
+static inline u64 HModTimer_stop(HModTimer* timer) {
+	timer->elapsed = HModTimer_ticks() - timer->start;
+
+	return timer->elapsed;
+}
+
+static inline u64 HModTimer_cycles(const HModTimer* timer) {
+	return timer->elapsed;
+}
+
+static inline u64 HModTimer_ns(const HModTimer* timer) {
+	return HModTimer_to_ns(timer->elapsed);
+}
+
+
+#endif
@@ -109,6 +109,58 @@
 /*				Procedure Definitions							*/
 /* ------------------------------------------------------------ */
 
+/***	VideoConfigVdma(VideoCapture *videoPtr)
+**
+**	Parameters:
+**		videoPtr - Pointer to the initialized VideoCapture struct
+**
+**	Return Value: int
+**		XST_SUCCESS if successful, XST_FAILURE otherwise
+**
+**	Errors:
+**
+**	Description:
+**		Writes vdmaConfig (including the frame store addresses) to the VDMA
+**		write channel and parks it on curStore. The VDMA latches the new
+**		values at the next frame boundary, so this can also be used while
+**		streaming.
+**
+*/
+static int VideoConfigVdma(VideoCapture *videoPtr)
+{
+	int Status;
+
+	videoPtr->vdmaConfig.FixedFrameStoreAddr = videoPtr->curStore;
+
+	Status = XAxiVdma_DmaConfig(videoPtr->vdma, XAXIVDMA_WRITE, &(videoPtr->vdmaConfig));
+	if (Status != XST_SUCCESS)
+	{
+		xdbg_printf(XDBG_DEBUG_GENERAL, "Write channel config failed %d\r\n", Status);
+		return XST_FAILURE;
+	}
+	Status = XAxiVdma_DmaSetBufferAddr(videoPtr->vdma, XAXIVDMA_WRITE, videoPtr->vdmaConfig.FrameStoreStartAddr);
+	if (Status != XST_SUCCESS)
+	{
+		xdbg_printf(XDBG_DEBUG_GENERAL, "Write channel set buffer address failed %d\r\n", Status);
+		return XST_FAILURE;
+	}
+	Status = XAxiVdma_DmaStart(videoPtr->vdma, XAXIVDMA_WRITE);
+	if (Status != XST_SUCCESS)
+	{
+		xdbg_printf(XDBG_DEBUG_GENERAL, "Start Write transfer failed %d\r\n", Status);
+		return XST_FAILURE;
+	}
+	Status = XAxiVdma_StartParking(videoPtr->vdma, videoPtr->curStore, XAXIVDMA_WRITE);
+	if (Status != XST_SUCCESS)
+	{
+		xdbg_printf(XDBG_DEBUG_GENERAL, "Unable to park the Write channel %d\r\n", Status);
+		return XST_FAILURE;
+	}
+
+	return XST_SUCCESS;
+}
+/* ------------------------------------------------------------ */
+
 /***	VideoStop(VideoCapture *videoPtr)
 **
 **	Parameters:
@@ -173,39 +225,20 @@ int VideoStart(VideoCapture *videoPtr)
 	 */
 	videoPtr->vdmaConfig.VertSizeInput = videoPtr->timing.VActiveVideo;
 	videoPtr->vdmaConfig.HoriSizeInput = videoPtr->timing.HActiveVideo * 3;
-	videoPtr->vdmaConfig.FixedFrameStoreAddr = videoPtr->curFrame;
 	/*
 	 *Also reset the stride and address values, in case the user manually changed them
 	 */
 	videoPtr->vdmaConfig.Stride = videoPtr->stride;
-	for (i = 0; i < VIDEO_NUM_FRAMES; i++)
+	videoPtr->curStore = 0;
+	for (i = 0; i < VIDEO_NUM_FSTORES; i++)
 	{
-		videoPtr->vdmaConfig.FrameStoreStartAddr[i] = (u32)  videoPtr->framePtr[i];
+		videoPtr->vdmaConfig.FrameStoreStartAddr[i] = (UINTPTR)  videoPtr->framePtr[videoPtr->curFrame];
 	}
 
 	xdbg_printf(XDBG_DEBUG_GENERAL, "Starting VDMA for Video capture\n\r");
-	Status = XAxiVdma_DmaConfig(videoPtr->vdma, XAXIVDMA_WRITE, &(videoPtr->vdmaConfig));
+	Status = VideoConfigVdma(videoPtr);
 	if (Status != XST_SUCCESS)
 	{
-		xdbg_printf(XDBG_DEBUG_GENERAL, "Write channel config failed %d\r\n", Status);
-		return XST_FAILURE;
-	}
-	Status = XAxiVdma_DmaSetBufferAddr(videoPtr->vdma, XAXIVDMA_WRITE, videoPtr->vdmaConfig.FrameStoreStartAddr);
-	if (Status != XST_SUCCESS)
-	{
-		xdbg_printf(XDBG_DEBUG_GENERAL, "Write channel set buffer address failed %d\r\n", Status);
-		return XST_FAILURE;
-	}
-	Status = XAxiVdma_DmaStart(videoPtr->vdma, XAXIVDMA_WRITE);
-	if (Status != XST_SUCCESS)
-	{
-		xdbg_printf(XDBG_DEBUG_GENERAL, "Start Write transfer failed %d\r\n", Status);
-		return XST_FAILURE;
-	}
-	Status = XAxiVdma_StartParking(videoPtr->vdma, videoPtr->curFrame, XAXIVDMA_WRITE);
-	if (Status != XST_SUCCESS)
-	{
-		xdbg_printf(XDBG_DEBUG_GENERAL, "Unable to park the Write channel %d\r\n", Status);
 		return XST_FAILURE;
 	}
 
@@ -216,7 +249,7 @@ int VideoStart(VideoCapture *videoPtr)
 
 /* ------------------------------------------------------------ */
 
-/***	VideoInitialize(VideoCapture *videoPtr, INTC *intCtrl, XAxiVdma *vdma, u16 gpioId, u16 vtcId, u32 vtcIrptId, u8 *framePtr[VIDEO_NUM_FRAMES], u32 stride, u32 startOnDet)
+/***	VideoInitialize(VideoCapture *videoPtr, INTC *intCtrl, XAxiVdma *vdma, u16 gpioId, u16 vtcId, u32 vtcIrptId, u8 **framePtr, u32 numFrames, u32 stride, u32 startOnDet)
 
 **
 **	Parameters:
@@ -229,7 +262,9 @@ int VideoStart(VideoCapture *videoPtr)
 **		gpioId - Device ID of the AXI GPIO core as found in xparameters.h. This is the core connect to the HPD and locked signals
 **		vtcId - Device ID of the VTC core as found in xparameters.h
 **		vtcIrptId - Interrupt ID of the VTC core
-**		framePtr - array of pointers to the framebuffers. The framebuffers must be instantiated above this driver
+**		framePtr - array of pointers to the framebuffers. The framebuffers must be instantiated above this driver, and the array
+**				   must stay valid while the driver is in use
+**		numFrames - number of framebuffers in framePtr, at least 1. This is independent of VIDEO_NUM_FSTORES
 **		stride - line stride of the framebuffers. This is the number of bytes between the start of one line and the start of another.
 **		startOnDet - Flag indicating if you want to begin streaming as soon as a video signal is detected. Non-zero values mean yes.
 **
@@ -244,19 +279,17 @@ int VideoStart(VideoCapture *videoPtr)
 **		can all be called at will.
 **
 */
-int VideoInitialize(VideoCapture *videoPtr, INTC *intCtrl, XAxiVdma *vdma, u16 gpioId, u16 vtcId, u32 vtcIrptId, u8 *framePtr[VIDEO_NUM_FRAMES], u32 stride, u32 startOnDet)
+int VideoInitialize(VideoCapture *videoPtr, INTC *intCtrl, XAxiVdma *vdma, u16 gpioId, u16 vtcId, u32 vtcIrptId, u8 **framePtr, u32 numFrames, u32 stride, u32 startOnDet)
 {
 	int Status;
-	int i;
 
 	/*
 	 * Initialize all the fields in the VideoCapture struct
 	 */
 	videoPtr->curFrame = 0;
-	for (i = 0; i < VIDEO_NUM_FRAMES; i++)
-	{
-		videoPtr->framePtr[i] = framePtr[i];
-	}
+	videoPtr->curStore = 0;
+	videoPtr->framePtr = framePtr;
+	videoPtr->numFrames = numFrames;
 	videoPtr->state = VIDEO_DISCONNECTED;
 	videoPtr->stride = stride;
 
@@ -333,7 +366,7 @@ int VideoInitialize(VideoCapture *videoPtr, INTC *intCtrl, XAxiVdma *vdma, u16 g
 **	Parameters:
 **		videoPtr - Pointer to the initialized VideoCapture struct
 **		frameIndex - Index of the framebuffer to change to (must
-**				be between 0 and (DISPLAY_NUM_FRAMES - 1))
+**				be between 0 and (numFrames - 1))
 **
 **	Return Value: int
 **		XST_SUCCESS if successful, XST_FAILURE otherwise
@@ -341,7 +374,9 @@ int VideoInitialize(VideoCapture *videoPtr, INTC *intCtrl, XAxiVdma *vdma, u16 g
 **	Errors:
 **
 **	Description:
-**		Changes the frame that video is currently streamed to.
+**		Changes the frame that video is currently streamed to. The
+**		framebuffer is mapped onto the next VDMA frame store; the store being
+**		written keeps its address, so the frame in progress is finished there.
 **
 */
 
@@ -350,16 +385,18 @@ int VideoChangeFrame(VideoCapture *videoPtr, u32 frameIndex)
 	int Status;
 
 	videoPtr->curFrame = frameIndex;
+	videoPtr->curStore = (videoPtr->curStore + 1) % VIDEO_NUM_FSTORES;
+	videoPtr->vdmaConfig.FrameStoreStartAddr[videoPtr->curStore] = (UINTPTR)  videoPtr->framePtr[frameIndex];
 	/*
 	 * If currently running, then the DMA needs to be told to start reading from the desired frame
 	 * at the end of the current frame
 	 */
 	if (videoPtr->state == VIDEO_STREAMING)
 	{
-		Status = XAxiVdma_StartParking(videoPtr->vdma, videoPtr->curFrame, XAXIVDMA_WRITE);
+		Status = VideoConfigVdma(videoPtr);
 		if (Status != XST_SUCCESS)
 		{
-			xdbg_printf(XDBG_DEBUG_GENERAL, "Cannot change frame, unable to start parking %d\r\n", Status);
+			xdbg_printf(XDBG_DEBUG_GENERAL, "Cannot change frame %d\r\n", Status);
 			return XST_FAILURE;
 		}
 	}
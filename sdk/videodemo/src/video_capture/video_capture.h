@@ -82,9 +82,11 @@
 /* ------------------------------------------------------------ */
 
 /*
- * This driver currently supports 3 frames.
+ * Number of frame stores of the VDMA write channel (C_NUM_FSTORES). Any number
+ * of framebuffers can be passed to VideoInitialize; each one is mapped onto a
+ * free frame store when video is streamed into it.
  */
-#define VIDEO_NUM_FRAMES 3
+#define VIDEO_NUM_FSTORES 3
 
 /*
  * These constants define the pins that the HPD and pixel clock
@@ -134,9 +136,11 @@ typedef struct {
 		XVtc vtc; /*VTC driver struct*/
 		XVtc_Timing timing;
 		INTC *intc; /*Interrupt controller driver struct*/
-		u8 *framePtr[VIDEO_NUM_FRAMES]; /* Array of pointers to the framebuffers */
+		u8 **framePtr; /* Array of pointers to the framebuffers */
+		u32 numFrames; /* Number of framebuffers in framePtr */
 		u32 stride; /* The line stride of the framebuffers, in bytes */
 		u32 curFrame; /* Current frame being displayed */
+		u32 curStore; /* VDMA frame store curFrame is mapped onto */
 		XGpio gpio; /* XGPIO driver struct */
 		u16 vtcId; /* Device ID of VTC core as defined in xparameters.h */
 		u16 vtcIrptId; /* Interrupt ID for the VTC core */
@@ -154,7 +158,7 @@ typedef struct {
 
 int VideoStop(VideoCapture *videoPtr);
 int VideoStart(VideoCapture *videoPtr);
-int VideoInitialize(VideoCapture *videoPtr, INTC *intCtrl, XAxiVdma *vdma, u16 gpioId, u16 vtcId, u32 vtcIrptId, u8 *framePtr[VIDEO_NUM_FRAMES], u32 stride, u32 startOnDet);
+int VideoInitialize(VideoCapture *videoPtr, INTC *intCtrl, XAxiVdma *vdma, u16 gpioId, u16 vtcId, u32 vtcIrptId, u8 **framePtr, u32 numFrames, u32 stride, u32 startOnDet);
 int VideoChangeFrame(VideoCapture *videoPtr, u32 frameIndex);
 void VideoSetCallback(VideoCapture *videoPtr, VideoCallBack CallBackFunc, void *CallBackRef);
 void GpioIsr(void *InstancePtr);
@@ -45,8 +45,7 @@
 // schlto 30.06.2017
 
 #include "_HMod/Nexys-Video-HDMIHMod.h"
-
-#include "xtmrctr_l.h"
+#include "hmod_timer/hmod_timer.h"
 
 
 /*
@@ -65,11 +64,25 @@
 
 // schlto 30.06.2017
 
-// < 5 * 10^6 CPF
-#define CLEAR_FB(FB) ( \
-	memset(FB, 0, 3 * videoCapt.timing.HActiveVideo *  \
-		videoCapt.timing.VActiveVideo * sizeof(FB[0])) \
-)
+// Framebuffer-Ring: Bildperiode der Aufnahme bzw. Anzeige (60 Hz), nach der
+// ein Wechsel per VideoChangeFrame/DisplayChangeFrame wirksam ist
+#define HMOD_FRAME_PERIOD (HModTimer_freq() / 60)
+
+// Qualitaetsregler: Zielzeit je Bild (HMod_step) mit Reserve fuer den Rest
+// der Hauptschleife, Frist ist die Bildperiode; Ausgabe unter den
+// Stufenzeiten
+#define HMOD_GOV_TARGET (HMOD_FRAME_PERIOD * 85 / 100)
+#define HMOD_DELTA_ROW  (10 + HMOD_PROF * (HMOD_STAGES + 1))
+#define HMOD_GOV_ROW    (HMOD_DELTA_ROW + hmod_delta.enabled)
+
+// Neuberechnung im Hintergrund (Board): Eintraege je Aufruf zwischen zwei
+// Bildern
+#define HMOD_BUILD_SLICE 64
+
+// z/Z: Faktor je Tastendruck, Grenzen fuer HMod_scale
+#define HMOD_SCALE_STEP 1.25f
+#define HMOD_SCALE_MIN  0.25f
+#define HMOD_SCALE_MAX  4.0f
 
 
 /* ------------------------------------------------------------ */
@@ -88,8 +101,9 @@ char fRefresh; //flag used to trigger a refresh of the Menu on video detect
 /*
  * Framebuffers for video data
  */
-u8 frameBuf[DISPLAY_NUM_FRAMES][DEMO_MAX_FRAME];
-u8 *pFrames[DISPLAY_NUM_FRAMES]; //array of pointers to the frame buffers
+u8 *frameBuf; //pool holding all frame buffers
+u8 **pFrames; //array of pointers to the frame buffers
+u32 DemoNumFrames; //number of frame buffers in pFrames
 
 /*
  * Interrupt vector table
@@ -107,12 +121,32 @@ bool HMod_inited = false;
 
 u32 HMod_CPF = 0;
 
+bool     HMod_continuous = false;
+HModFps  HMod_fps        = { .fps_x100 = 0 };
+HModRing HMod_ring;
+
+// Ausgabekonfiguration, fuer die HMod_ring.blank gilt
+u32   HMod_blank_order  = 0;
+float HMod_blank_scale  = 0.0f;
+u32   HMod_blank_mode_d = 0;
+u32   HMod_blank_width  = 0;
+
+bool         HMod_governed = false;
+HModGovernor HMod_gov;
+
 u32   HMod_order  = 5;
 float HMod_scale  = 1.0f;
 float HMod_radius = 1.0f;
 u32   HMod_mode_i = 0;
 u32   HMod_mode_d = 0;
 
+// Konfiguration der aktuellen Tabellen (HMod_step); HMod_order und
+// HMod_radius werden mit p wirksam, HMod_order bei laufender Verarbeitung
+// ueber eine Neuberechnung im Hintergrund (HMod_build), HMod_scale sofort
+u32       HMod_live_order  = 5;
+float     HMod_live_radius = 1.0f;
+HModBuild HMod_build;
+
 
 /* ------------------------------------------------------------ */
 /*                  Procedure Definitions                       */
@@ -123,7 +157,7 @@ int main(void)
 	Xil_ICacheEnable();
 	Xil_DCacheEnable();
 
-	DemoInitialize();
+	DemoInitialize(DEMO_NUM_FRAMES);
 
 	DemoRun();
 
@@ -131,19 +165,39 @@ int main(void)
 }
 
 
-void DemoInitialize()
+void DemoInitialize(u32 numFrames)
 {
 	int Status;
 	XAxiVdma_Config *vdmaConfig;
-	int i;
+	u32 i;
+
+	if (numFrames < DEMO_MIN_FRAMES)
+		numFrames = DEMO_MIN_FRAMES;
+	if (numFrames > HMOD_RING_MAX)
+		numFrames = HMOD_RING_MAX;
 
 	/*
-	 * Initialize an array of pointers to the 3 frame buffers
+	 * Allocate one pool for all frame buffers and initialize an array of
+	 * pointers to them. DEMO_MAX_FRAME is a multiple of DEMO_FRAME_ALIGN, so
+	 * every frame buffer starts on an aligned address.
 	 */
-	for (i = 0; i < DISPLAY_NUM_FRAMES; i++)
+	frameBuf = malloc(numFrames * DEMO_MAX_FRAME + DEMO_FRAME_ALIGN);
+	pFrames = malloc(numFrames * sizeof(u8 *));
+	if (!frameBuf || !pFrames)
 	{
-		pFrames[i] = frameBuf[i];
+		xil_printf("Couldn't allocate %d frame buffers\r\n", numFrames);
+		return;
 	}
+	for (i = 0; i < numFrames; i++)
+	{
+		pFrames[i] = (u8 *) (((UINTPTR) frameBuf + DEMO_FRAME_ALIGN - 1) & ~(UINTPTR) (DEMO_FRAME_ALIGN - 1)) + i * DEMO_MAX_FRAME;
+	}
+	DemoNumFrames = numFrames;
+
+	/*
+	 * Time base for CPF, FPS and the HMod stage timings
+	 */
+	HModTimer_init();
 
 	/*
 	 * Initialize VDMA driver
@@ -164,7 +218,7 @@ void DemoInitialize()
 	/*
 	 * Initialize the Display controller and start it
 	 */
-	Status = DisplayInitialize(&dispCtrl, &vdma, DISP_VTC_ID, DYNCLK_BASEADDR, pFrames, DEMO_STRIDE);
+	Status = DisplayInitialize(&dispCtrl, &vdma, DISP_VTC_ID, DYNCLK_BASEADDR, pFrames, numFrames, DEMO_STRIDE);
 	if (Status != XST_SUCCESS)
 	{
 		xil_printf("Display Ctrl initialization failed during demo initialization%d\r\n", Status);
@@ -190,7 +244,7 @@ void DemoInitialize()
 	/*
 	 * Initialize the Video Capture device
 	 */
-	Status = VideoInitialize(&videoCapt, &intc, &vdma, VID_GPIO_ID, VID_VTC_ID, VID_VTC_IRPT_ID, pFrames, DEMO_STRIDE, DEMO_START_ON_DET);
+	Status = VideoInitialize(&videoCapt, &intc, &vdma, VID_GPIO_ID, VID_VTC_ID, VID_VTC_IRPT_ID, pFrames, numFrames, DEMO_STRIDE, DEMO_START_ON_DET);
 	if (Status != XST_SUCCESS)
 	{
 		xil_printf("Video Ctrl initialization failed during demo initialization%d\r\n", Status);
@@ -225,27 +279,9 @@ void DemoRun()
 
 		// schlto 30.06.2017
 		if(enable_HMod && HMod_inited && nextFrame/* == 2*/) {
-			XTmrCtr_SetControlStatusReg(XPAR_AXI_TIMER_0_BASEADDR, XPAR_AXI_TIMER_0_DEVICE_ID, 0);
-			XTmrCtr_SetLoadReg(XPAR_AXI_TIMER_0_BASEADDR, XPAR_AXI_TIMER_0_DEVICE_ID, 0);
-			XTmrCtr_LoadTimerCounterReg(XPAR_AXI_TIMER_0_BASEADDR, XPAR_AXI_TIMER_0_DEVICE_ID);
-			u32 cs = XTmrCtr_GetControlStatusReg(XPAR_AXI_TIMER_0_BASEADDR, XPAR_AXI_TIMER_0_DEVICE_ID);
-			XTmrCtr_SetControlStatusReg(XPAR_AXI_TIMER_0_BASEADDR, XPAR_AXI_TIMER_0_DEVICE_ID, cs & ~XTC_CSR_LOAD_MASK);
-
-
-			VideoStop(&videoCapt);
-			HMod_CPF = XTmrCtr_GetTimerCounterReg(XPAR_AXI_TIMER_0_BASEADDR, XPAR_AXI_TIMER_0_DEVICE_ID);
-			XTmrCtr_Enable(XPAR_AXI_TIMER_0_BASEADDR, XPAR_AXI_TIMER_0_DEVICE_ID);
-
-			NexysVideoHDMIHMod(
-				pFrames[videoCapt.curFrame], pFrames[nextFrame],
-				videoCapt.timing.HActiveVideo, videoCapt.timing.VActiveVideo, dispCtrl.vMode.width, dispCtrl.vMode.height,
-				HMod_order, HMod_scale, HMod_radius, HMod_mode_i, HMod_mode_d);
-
-			Xil_DCacheFlushRange((unsigned int)pFrames[nextFrame], DEMO_MAX_FRAME);
-
-			XTmrCtr_Disable(XPAR_AXI_TIMER_0_BASEADDR, XPAR_AXI_TIMER_0_DEVICE_ID);
-			HMod_CPF = XTmrCtr_GetTimerCounterReg(XPAR_AXI_TIMER_0_BASEADDR, XPAR_AXI_TIMER_0_DEVICE_ID) - HMod_CPF;
-			VideoStart(&videoCapt);
+			// Aufnahme laeuft weiter, auf naechstes fertiges Bild warten
+			while(!HMod_step() && !fRefresh)
+				HMod_idle();
 		}
 
 
@@ -254,7 +290,19 @@ void DemoRun()
 
 		/* Wait for data on UART */
 		while (XUartLite_IsReceiveEmpty(UART_BASEADDR) && !fRefresh)
-		{}
+		{
+			// schlto: Dauerbetrieb, UART wird zwischen zwei Bildern abgefragt
+			if(HMod_continuous && enable_HMod && HMod_inited && nextFrame && HMod_step()) {
+				if(NexysVideoHDMIHMod_fps_frame(&HMod_fps, HModTimer_ticks())) {
+					HMod_print_fps();
+					HMod_print_prof(true);
+					HMod_print_delta(true);
+					HMod_print_gov(true);
+				}
+			} else {
+				HMod_idle();
+			}
+		}
 
 		/* Store the first character in the UART receive FIFO and echo it */
 		if (!XUartLite_IsReceiveEmpty(UART_BASEADDR))
@@ -287,11 +335,18 @@ void DemoRun()
 
 					VideoStart(&videoCapt);
 
-					HMod_inited = true;
+					HMod_inited      = true;
+					HMod_live_order  = HMod_order;
+					HMod_live_radius = HMod_radius;
+				} else {
+					HMod_reinit();
 				}
 				break;
 			case 'P':
 				if(HMod_inited) {
+					NexysVideoHDMIHMod_build_cancel(&HMod_build);
+					HMod_governor(false);
+
 					xil_printf("\x1B[H");
 					xil_printf("\x1B[2J");
 					xil_printf("Freeing Memory (Precalculations)...");
@@ -307,8 +362,11 @@ void DemoRun()
 
 			case 'h':
 				if(!enable_HMod) {
-					nextFrame = 2;
+					nextFrame = DemoNumFrames - 1;
 					DisplayChangeFrame(&dispCtrl, nextFrame);
+					NexysVideoHDMIHMod_ring_init(&HMod_ring, DemoNumFrames,
+						videoCapt.curFrame, dispCtrl.curFrame, HModTimer_ticks(), HMOD_FRAME_PERIOD);
+					NexysVideoHDMIHMod_prof_init();
 
 					enable_HMod = true;
 				}
@@ -316,6 +374,7 @@ void DemoRun()
 			case 'H':
 				if(enable_HMod) {
 					nextFrame = 0;
+					VideoChangeFrame(&videoCapt, nextFrame);
 					DisplayChangeFrame(&dispCtrl, nextFrame);
 
 					enable_HMod = false;
@@ -323,13 +382,66 @@ void DemoRun()
 				}
 				break;
 
+			case 'c':
+				if(!HMod_continuous) {
+					HMod_continuous = true;
+					NexysVideoHDMIHMod_fps_init(&HMod_fps, HModTimer_ticks(), HModTimer_freq());
+					NexysVideoHDMIHMod_prof_init();
+				}
+				break;
+			case 'C':
+				if(HMod_continuous) {
+					HMod_continuous = false;
+				}
+				break;
+
+			// ohne freien Zielpuffer (in place) ueber einen eigenen Puffer;
+			// inkrementell ohne Hex-Filter
+			case 'u':
+				if(!hmod_delta.enabled) {
+					NexysVideoHDMIHMod_conv_init(HMOD_CONV_NONE);
+					NexysVideoHDMIHMod_delta_init(true);
+				}
+				break;
+			case 'U':
+				if(hmod_delta.enabled)
+					NexysVideoHDMIHMod_delta_init(false);
+				break;
+
+			// Hex-Filter zwischen sq2hex und hex2sq, weder inkrementell noch
+			// mit mode_d = 2
+			case 'x':
+				if(!hmod_delta.enabled && HMod_mode_d != 2)
+					NexysVideoHDMIHMod_conv_init((hmod_conv.filter + 1) % HMOD_CONV_FILTERS);
+				break;
+			case 'X':
+				NexysVideoHDMIHMod_conv_init(HMOD_CONV_NONE);
+				break;
+
+			case 'g':
+				HMod_governor(true);
+				break;
+			case 'G':
+				HMod_governor(false);
+				break;
+
 			case 'o':
 				HMod_set_order();
 				break;
 
+			// ohne Neuberechnung (Gewichte je Phase)
+			case 'z':
+				if(HMod_scale / HMOD_SCALE_STEP >= HMOD_SCALE_MIN)
+					HMod_scale /= HMOD_SCALE_STEP;
+				break;
+			case 'Z':
+				if(HMod_scale * HMOD_SCALE_STEP <= HMOD_SCALE_MAX)
+					HMod_scale *= HMOD_SCALE_STEP;
+				break;
+
 
 			case 'i':
-				CLEAR_FB(pFrames[nextFrame]);
+				HMod_governor(false);
 
 				if(HMod_mode_i < 3) {
 					HMod_mode_i++;
@@ -342,18 +454,20 @@ void DemoRun()
 
 			case 'd':
 				if(HMod_mode_d) {
-					CLEAR_FB(pFrames[nextFrame]);
-
 					HMod_mode_d = 0;
 				}
 				break;
 			case 'D':
-				if(!HMod_mode_d) {
-					CLEAR_FB(pFrames[nextFrame]);
-
+				if(HMod_mode_d != 1) {
 					HMod_mode_d = 1;
 				}
 				break;
+			case 'f':
+				if(HMod_mode_d != 2) {
+					HMod_mode_d = 2;
+					NexysVideoHDMIHMod_conv_init(HMOD_CONV_NONE);
+				}
+				break;
 
 
 		case '1':
@@ -361,7 +475,7 @@ void DemoRun()
 			break;
 		case '2':
 			nextFrame = dispCtrl.curFrame + 1;
-			if (nextFrame >= DISPLAY_NUM_FRAMES)
+			if (nextFrame >= DemoNumFrames)
 			{
 				nextFrame = 0;
 			}
@@ -381,7 +495,7 @@ void DemoRun()
 			break;
 		case '6':
 			nextFrame = videoCapt.curFrame + 1;
-			if (nextFrame >= DISPLAY_NUM_FRAMES)
+			if (nextFrame >= DemoNumFrames)
 			{
 				nextFrame = 0;
 			}
@@ -389,7 +503,7 @@ void DemoRun()
 			break;
 		case '7':
 			nextFrame = videoCapt.curFrame + 1;
-			if (nextFrame >= DISPLAY_NUM_FRAMES)
+			if (nextFrame >= DemoNumFrames)
 			{
 				nextFrame = 0;
 			}
@@ -400,7 +514,7 @@ void DemoRun()
 			break;
 		case '8':
 			nextFrame = videoCapt.curFrame + 1;
-			if (nextFrame >= DISPLAY_NUM_FRAMES)
+			if (nextFrame >= DemoNumFrames)
 			{
 				nextFrame = 0;
 			}
@@ -436,18 +550,34 @@ void DemoPrintMenu()
 	xil_printf("**************************************************\n\r");
 	xil_printf("* enable_HMod = %u (inited = %u):                  *\n\r", \
 	              enable_HMod,      HMod_inited);
-	xil_printf("*  order = %u, mode_i = %u, mode_d = %u             *\n\r", \
-	               HMod_order, HMod_mode_i, HMod_mode_d);
+	xil_printf("*  order = %u, mode_i = %u, mode_d = %u, k = %3u%%   *\n\r", \
+	               HMod_order, HMod_mode_i, HMod_mode_d, (u32)(100 * HMod_scale + 0.5f));
 	xil_printf("**************************************************\n\r");
 	xil_printf("* CPF: %41u *\n\r", HMod_CPF);
+	xil_printf("* FPS: %38u.%02u *\n\r", HMod_fps.fps_x100 / 100, HMod_fps.fps_x100 % 100);
 	xil_printf("**************************************************\n\r");
+	HMod_print_prof(false);
+	HMod_print_delta(false);
+	HMod_print_gov(false);
+
+	if(HMod_build.phase != HMOD_BUILD_IDLE)
+		xil_printf("  tables (order %u): %s\n\r", HMod_build.order,
+			NexysVideoHDMIHMod_build_phases[HMod_build.phase]);
+
 	xil_printf("\n\r");
 	xil_printf("p/P - Init. HMod / free Memory (Precalculations)  \n\r");
+	xil_printf("       p again: rebuild for new order in background\n\r");
 	xil_printf("h/H - Enable/disable HMod                         \n\r");
 	xil_printf("o   - Set Hexarray Order (Menu)                   \n\r");
+	xil_printf("z/Z - Zoom hex image in/out (scale k, no re-init) \n\r");
 	xil_printf("i   - Set Interpolation Mode:                     \n\r");
 	xil_printf("       BL / BC / Lanczos / B-Splines (B_3)        \n\r");
 	xil_printf("d/D - Set Display Mode: hex/sq                    \n\r");
+	xil_printf("f   - Set Display Mode: sq (fused sq2hex + hex2sq)\n\r");
+	xil_printf("c/C - Enable/disable continuous processing        \n\r");
+	xil_printf("g/G - Enable/disable quality governor (after p)   \n\r");
+	xil_printf("u/U - Enable/disable incremental sq2hex (changes) \n\r");
+	xil_printf("x/X - Next hex filter / off (now: %-8s)       \n\r", NexysVideoHDMIHMod_filters[hmod_conv.filter]);
 	xil_printf("\n\r");
 	xil_printf("\n\r");
 
@@ -479,6 +609,237 @@ void DemoPrintMenu()
 
 
 // schlto 30.06.2017
+// Framebuffer-Ring weiterschalten, ggf. ein Bild in einen freien Puffer
+// (ohne freien in place) verarbeiten und anzeigen; true, wenn ein Bild
+// verarbeitet wurde
+bool HMod_step() {
+	const int capture = NexysVideoHDMIHMod_ring_capture(&HMod_ring, HModTimer_ticks());
+
+	if(capture >= 0)
+		VideoChangeFrame(&videoCapt, capture);
+
+	const int frame = NexysVideoHDMIHMod_ring_process(&HMod_ring, HModTimer_ticks());
+
+	if(frame < 0)
+		return false;
+
+	const int dest = NexysVideoHDMIHMod_ring_dest(&HMod_ring, HModTimer_ticks());
+	const u32 out  = dest >= 0 ? (u32)dest : (u32)frame;
+
+	if(HMod_live_order != HMod_blank_order || HMod_scale != HMod_blank_scale ||
+	   HMod_mode_d != HMod_blank_mode_d || dispCtrl.vMode.width != HMod_blank_width) {
+		HMod_ring.blank   = 0;
+		HMod_blank_order  = HMod_live_order;
+		HMod_blank_scale  = HMod_scale;
+		HMod_blank_mode_d = HMod_mode_d;
+		HMod_blank_width  = dispCtrl.vMode.width;
+	}
+
+	// Rand bzw. Luecken einmal je Puffer und Konfiguration, nicht im
+	// Bildtakt gemessen (in place loescht NexysVideoHDMIHMod selbst)
+	if(out != (u32)frame && !(HMod_ring.blank & 1u << out)) {
+		NexysVideoHDMIHMod_blank(pFrames[out], DEMO_STRIDE, dispCtrl.vMode.width, dispCtrl.vMode.height,
+			HMod_scale, HMod_mode_d);
+		Xil_DCacheFlushRange((UINTPTR) pFrames[out], DEMO_STRIDE * dispCtrl.vMode.height);
+	}
+
+	HMod_ring.blank |= 1u << out;
+
+	HModTimer timer;
+
+	HModTimer_start(&timer);
+
+	HMOD_PROF_BEGIN();
+
+	/*
+	 * HMod reads the captured framebuffer directly, so drop any stale
+	 * cache lines before the VDMA-written data is read.
+	 */
+	Xil_DCacheInvalidateRange((UINTPTR) pFrames[frame], DEMO_STRIDE * videoCapt.timing.VActiveVideo);
+
+	HMOD_PROF_MARK(HMOD_STAGE_INVALIDATE);
+
+	const HModRange dirty = NexysVideoHDMIHMod(
+		pFrames[frame], pFrames[out],
+		DEMO_STRIDE, dispCtrl.vMode.width, dispCtrl.vMode.height,
+		HMod_live_order, HMod_scale, HMod_live_radius, HMod_mode_i, HMod_mode_d);
+
+	/*
+	 * Only the rows HMod actually wrote need to reach memory.
+	 */
+	NexysVideoHDMIHMod_flush(pFrames[out], dirty);
+
+	HMOD_PROF_MARK(HMOD_STAGE_FLUSH);
+	HMOD_PROF_END();
+
+	HMod_CPF = (u32)HModTimer_stop(&timer);
+
+	// Bildgrenze: Tabellensatz ist bereits gewechselt
+	if(HMod_governed && NexysVideoHDMIHMod_gov_frame(&HMod_gov, HMod_CPF)) {
+		HMod_live_order  = HMod_gov.level[HMod_gov.cur].order;
+		HMod_live_radius = HMod_gov.level[HMod_gov.cur].radius;
+		HMod_mode_i      = HMod_gov.level[HMod_gov.cur].mode_i;
+	}
+
+	NexysVideoHDMIHMod_ring_display(&HMod_ring, out, HModTimer_ticks());
+	DisplayChangeFrame(&dispCtrl, out);
+
+	return true;
+}
+
+// nur die FPS-Zeile des Menues (Zeile 8) neu schreiben
+void HMod_print_fps() {
+	xil_printf("\x1B[s\x1B[8;1H");
+	xil_printf("* FPS: %38u.%02u *", HMod_fps.fps_x100 / 100, HMod_fps.fps_x100 % 100);
+	xil_printf("\x1B[u");
+}
+
+
+// Stufenzeiten (HMOD_PROF) in us unter dem CPF-Kasten (ab Zeile 10),
+// update: nur diese Zeilen neu schreiben
+void HMod_print_prof(bool update) {
+#if HMOD_PROF
+	const u32 div = HModTimer_freq() / 1000000;
+
+	HModProfStats st;
+
+	if(update)
+		xil_printf("\x1B[s\x1B[10;1H");
+
+	xil_printf("  [us]          min   mean    max    p50    p90    p99\n\r");
+
+	for(u32 s = 0; s < HMOD_STAGES; s++) {
+		NexysVideoHDMIHMod_prof_stats(s, &st);
+
+		xil_printf("  %-10s %6u %6u %6u %6u %6u %6u\n\r", NexysVideoHDMIHMod_stages[s],
+			st.min / div, st.mean / div, st.max / div, st.p50 / div, st.p90 / div, st.p99 / div);
+	}
+
+	if(update)
+		xil_printf("\x1B[u");
+#else
+	(void)update;
+#endif
+}
+
+
+// Anteil neu berechneter Hex-Pixel (inkrementell) in Promille, Mittel und
+// letztes Bild, in Zeile HMOD_DELTA_ROW; update: nur diese Zeile neu schreiben
+void HMod_print_delta(bool update) {
+	if(!hmod_delta.enabled)
+		return;
+
+	const u32 mean = hmod_delta.hex ? (u32)(1000 * hmod_delta.sampled / hmod_delta.hex) : 0;
+	const u32 last = hmod_delta.delta.size ? 1000 * hmod_delta.delta.sampled / hmod_delta.delta.size : 0;
+
+	if(update)
+		xil_printf("\x1B[s\x1B[%u;1H", HMOD_DELTA_ROW);
+
+	xil_printf("  delta: %u.%u %% resampled (last %u.%u %%), %u frames\x1B[K\n\r",
+		mean / 10, mean % 10, last / 10, last % 10, hmod_delta.frames);
+
+	if(update)
+		xil_printf("\x1B[u");
+}
+
+
+// Qualitaetsregler ein: Stufen ab der aktuellen Konfiguration, deren
+// Tabellen uebernommen werden; aus: zurueck auf diese Konfiguration
+void HMod_governor(bool on) {
+	if(on == HMod_governed || (on && !HMod_inited))
+		return;
+
+	// nicht waehrend einer Neuberechnung, deren Tausch die Saetze uebergeht
+	if(on && HMod_build.phase != HMOD_BUILD_IDLE && HMod_build.phase != HMOD_BUILD_RETIRE)
+		return;
+
+	if(on) {
+		HModLevel levels[HMOD_GOV_LEVELS];
+
+		const u32 n = NexysVideoHDMIHMod_gov_ladder(levels, HMod_live_order, HMod_mode_i, HMod_live_radius);
+
+		xil_printf("\x1B[H");
+		xil_printf("\x1B[2J");
+		xil_printf("Initializing Governor (%u levels)...", n);
+
+		VideoStop(&videoCapt);
+		NexysVideoHDMIHMod_gov_init(&HMod_gov, levels, n, DEMO_STRIDE,
+			dispCtrl.vMode.width, dispCtrl.vMode.height, HMod_scale, HMod_mode_d,
+			HMOD_GOV_TARGET, HMOD_FRAME_PERIOD);
+		VideoStart(&videoCapt);
+	} else {
+		NexysVideoHDMIHMod_gov_stop(&HMod_gov);
+	}
+
+	HMod_live_order  = HMod_gov.level[0].order;
+	HMod_live_radius = HMod_gov.level[0].radius;
+	HMod_mode_i      = HMod_gov.level[0].mode_i;
+	HMod_governed    = on;
+}
+
+// Tabellen fuer die gewaehlte Konfiguration neu berechnen, waehrend die
+// aktuelle weiter Bilder verarbeitet (HMod_idle)
+void HMod_reinit() {
+	if(HMod_order == HMod_live_order && HMod_radius == HMod_live_radius)
+		return;
+
+	HMod_governor(false);
+
+	// radius waehlt nur die hex2sq-Bank je Bild, die Tabellen bleiben
+	HMod_live_radius = HMod_radius;
+
+	if(HMod_order == HMod_live_order)
+		return;
+
+	NexysVideoHDMIHMod_build_start(&HMod_build, dispCtrl.vMode.width, dispCtrl.vMode.height,
+		HMod_order, HMod_scale, HMod_radius);
+}
+
+// zwischen zwei Bildern: Neuberechnung weiterfuehren, fertige Tabellen
+// uebernehmen und die alten freigeben
+void HMod_idle() {
+	if(NexysVideoHDMIHMod_build_poll(&HMod_build, HMOD_BUILD_SLICE) != HMOD_BUILD_READY)
+		return;
+
+	NexysVideoHDMIHMod_build_commit(&HMod_build);
+
+	HMod_live_order = HMod_build.order;
+	HMod_CPF        = 0;
+
+	NexysVideoHDMIHMod_prof_init();
+}
+
+// Stufe, Kosten (gleitend), Fristen und letzter Eintrag des Qualitaetsreglers
+// ab Zeile HMOD_GOV_ROW, update: nur diese Zeilen neu schreiben
+void HMod_print_gov(bool update) {
+	if(!HMod_governed)
+		return;
+
+	const u32        div   = HModTimer_freq() / 1000000;
+	const HModLevel* level = &HMod_gov.level[HMod_gov.cur];
+
+	if(update)
+		xil_printf("\x1B[s\x1B[%u;1H", HMOD_GOV_ROW);
+
+	xil_printf("  gov: level %u/%u (order %u, mode_i %u, radius %u), %u us\x1B[K\n\r",
+		HMod_gov.cur, HMod_gov.n - 1, level->order, level->mode_i, (u32)level->radius,
+		(u32)(HMod_gov.ewma / div));
+	xil_printf("       %u misses, %u switches", HMod_gov.misses, HMod_gov.switches);
+
+	if(HMod_gov.logged) {
+		const HModGovLog* log = &HMod_gov.log[(HMod_gov.logged - 1) % HMOD_GOV_LOG];
+
+		xil_printf(", last: %s %u -> %u, frame %u, %u us", NexysVideoHDMIHMod_gov_events[log->event],
+			log->from, log->to, log->frame, log->cost / div);
+	}
+
+	xil_printf("\x1B[K\n\r");
+
+	if(update)
+		xil_printf("\x1B[u");
+}
+
+
 void HMod_set_order() {
 	bool order_set = false;
 	char input     = 0; // XUartLite_ReadReg
@@ -658,7 +1019,7 @@ void DemoInvertFrame(u8 *srcFrame, u8 *destFrame, u32 width, u32 height, u32 str
 	 * Flush the framebuffer memory range to ensure changes are written to the
 	 * actual memory, and therefore accessible by the VDMA.
 	 */
-	Xil_DCacheFlushRange((unsigned int) destFrame, DEMO_MAX_FRAME);
+	Xil_DCacheFlushRange((UINTPTR) destFrame, DEMO_FRAME_BYTES(width, height, stride));
 }
 
 
@@ -729,7 +1090,7 @@ void DemoScaleFrame(u8 *srcFrame, u8 *destFrame, u32 srcWidth, u32 srcHeight, u3
 	 * Flush the framebuffer memory range to ensure changes are written to the
 	 * actual memory, and therefore accessible by the VDMA.
 	 */
-	Xil_DCacheFlushRange((unsigned int) destFrame, DEMO_MAX_FRAME);
+	Xil_DCacheFlushRange((UINTPTR) destFrame, DEMO_FRAME_BYTES(destWidth, destHeight, stride));
 
 	return;
 }
@@ -819,7 +1180,7 @@ void DemoPrintTest(u8 *frame, u32 width, u32 height, u32 stride, int pattern)
 		 * Flush the framebuffer memory range to ensure changes are written to the
 		 * actual memory, and therefore accessible by the VDMA.
 		 */
-		Xil_DCacheFlushRange((unsigned int) frame, DEMO_MAX_FRAME);
+		Xil_DCacheFlushRange((UINTPTR) frame, DEMO_FRAME_BYTES(width, height, stride));
 		break;
 	case DEMO_PATTERN_1:
 
@@ -883,7 +1244,7 @@ void DemoPrintTest(u8 *frame, u32 width, u32 height, u32 stride, int pattern)
 		 * Flush the framebuffer memory range to ensure changes are written to the
 		 * actual memory, and therefore accessible by the VDMA.
 		 */
-		Xil_DCacheFlushRange((unsigned int) frame, DEMO_MAX_FRAME);
+		Xil_DCacheFlushRange((UINTPTR) frame, DEMO_FRAME_BYTES(width, height, stride));
 		break;
 	default :
 		xil_printf("Error: invalid pattern passed to DemoPrintTest");
@@ -46,6 +46,23 @@
 #define DEMO_MAX_FRAME (1920*1080*3)
 #define DEMO_STRIDE (1920 * 3)
 
+/*
+ * Number of framebuffers allocated by DemoInitialize. At least 3 are needed
+ * for HMod (capture, processing, display) and at most HMOD_RING_MAX are used.
+ * The framebuffers are carved from one pool aligned to DEMO_FRAME_ALIGN bytes
+ * (cache line and VDMA burst aligned).
+ */
+#define DEMO_NUM_FRAMES 5
+#define DEMO_MIN_FRAMES 3
+#define DEMO_FRAME_ALIGN 64
+
+/*
+ * Bytes from the first to the last pixel of a width x height image with the
+ * given stride, i.e. the range a full-image writer has to flush
+ */
+#define DEMO_FRAME_BYTES(width, height, stride) \
+	((height) ? ((height) - 1) * (stride) + (width) * 3 : 0)
+
 /*
  * Configure the Video capture driver to start streaming on signal
  * detection
@@ -60,6 +77,10 @@ bool HMod_inited;
 
 u32 HMod_CPF;
 
+bool     HMod_continuous;
+HModFps  HMod_fps;
+HModRing HMod_ring;
+
 u32   HMod_order;
 float HMod_scale;
 float HMod_radius;
@@ -71,12 +92,20 @@ u32   HMod_mode_d;
 /*                  Procedure Declarations                      */
 /* ------------------------------------------------------------ */
 
-void DemoInitialize();
+void DemoInitialize(u32 numFrames);
 void DemoRun();
 void DemoPrintMenu();
 
 
 // schlto 30.06.2017
+bool HMod_step();
+void HMod_print_fps();
+void HMod_print_prof(bool update);
+void HMod_print_delta(bool update);
+void HMod_governor(bool on);
+void HMod_reinit();
+void HMod_idle();
+void HMod_print_gov(bool update);
 void HMod_set_order();
 
 